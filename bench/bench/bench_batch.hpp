@@ -0,0 +1,134 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BatchBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 1'000'000;
+
+    struct Scaled
+    {
+        std::int32_t operator()(std::int32_t x) const { return x * 3 + 1; }
+    };
+
+    struct NotMultipleOfSeven
+    {
+        bool operator()(std::int32_t x) const { return x % 7 != 0; }
+    };
+
+    struct Calibrated
+    {
+        float operator()(float x) const { return x * 0.98f + 0.25f; }
+    };
+
+    // A single cheap stage, which only vectorizes once it runs over a whole block on its own.
+    static void mapSum()
+    {
+        const std::vector<float> telemetry(SOURCE_LENGTH, 1.5f);
+
+        const auto fused = Bench::measure("vector<float> | map | sum",
+                                          SOURCE_LENGTH,
+                                          [&telemetry]
+                                          {
+                                              Bench::keep(telemetry | Seq::map(Calibrated{}) | Seq::sum());
+                                          });
+
+        const auto batched = Bench::measure("vector<float> | batched<256> | map | sum",
+                                            SOURCE_LENGTH,
+                                            [&telemetry]
+                                            {
+                                                Bench::keep(telemetry | Seq::batched<256>() | Seq::map(Calibrated{})
+                                                            | Seq::sum());
+                                            });
+
+        Bench::report(fused, "baseline");
+        Bench::report(batched);
+    }
+
+    // Cheap stages over a vector, one element through every stage at a time against one block per stage.
+    // Compacting the kept elements of a block does not vectorize, so the extra pass over every block does not pay off.
+    static void mapFilterSum()
+    {
+        const std::vector<std::int32_t> samples = Seq::range(0, static_cast<std::int32_t>(SOURCE_LENGTH))
+                                                  | Seq::toVector();
+
+        const auto fused = Bench::measure("vector | map | filter | sum",
+                                          SOURCE_LENGTH,
+                                          [&samples]
+                                          {
+                                              Bench::keep(samples | Seq::map(Scaled{})
+                                                          | Seq::filter(NotMultipleOfSeven{}) | Seq::sum());
+                                          });
+
+        const auto batched = Bench::measure("vector | batched<256> | map | filter | sum",
+                                            SOURCE_LENGTH,
+                                            [&samples]
+                                            {
+                                                Bench::keep(samples | Seq::batched<256>() | Seq::map(Scaled{})
+                                                            | Seq::filter(NotMultipleOfSeven{}) | Seq::sum());
+                                            });
+
+        Bench::report(fused, "baseline");
+        Bench::report(batched);
+    }
+
+    // Results are collected by a fold that appends whole blocks.
+    static void mapToVector()
+    {
+        const std::vector<float> telemetry(SOURCE_LENGTH, 1.5f);
+
+        const auto fused = Bench::measure("vector<float> | map | toVector",
+                                          SOURCE_LENGTH,
+                                          [&telemetry]
+                                          {
+                                              Bench::keep(telemetry | Seq::map(Calibrated{}) | Seq::toVector());
+                                          });
+
+        const auto batched = Bench::measure("vector<float> | batched<256> | map | toVector",
+                                            SOURCE_LENGTH,
+                                            [&telemetry]
+                                            {
+                                                Bench::keep(telemetry | Seq::batched<256>() | Seq::map(Calibrated{})
+                                                            | Seq::toVector());
+                                            });
+
+        Bench::report(fused, "baseline");
+        Bench::report(batched);
+    }
+
+    // Type-erased on the way out, the batched side resumes its coroutine per element but fills it per block.
+    static void pulledThroughIEnumerable()
+    {
+        const std::vector<std::int32_t> samples = Seq::range(0, static_cast<std::int32_t>(SOURCE_LENGTH))
+                                                  | Seq::toVector();
+
+        const auto fused = Bench::measure("IEnumerable(vector | map | filter)",
+                                          SOURCE_LENGTH,
+                                          [&samples]
+                                          {
+                                              IEnumerable<std::int32_t> kept = samples | Seq::map(Scaled{})
+                                                                               | Seq::filter(NotMultipleOfSeven{});
+                                              Bench::keep(std::move(kept) | Seq::pairwise() | Seq::length());
+                                          });
+
+        const auto batched = Bench::measure("IEnumerable(vector | batched<256> | map | filter)",
+                                            SOURCE_LENGTH,
+                                            [&samples]
+                                            {
+                                                IEnumerable<std::int32_t> kept = samples | Seq::batched<256>()
+                                                                                 | Seq::map(Scaled{})
+                                                                                 | Seq::filter(NotMultipleOfSeven{});
+                                                Bench::keep(std::move(kept) | Seq::pairwise() | Seq::length());
+                                            });
+
+        Bench::report(fused, "baseline");
+        Bench::report(batched);
+    }
+
+    constexpr std::array CASES = {mapSum, mapFilterSum, mapToVector, pulledThroughIEnumerable};
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GroupBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 2'000'000;
+
+    struct Row
+    {
+        std::uint32_t customer;
+        double amount;
+    };
+
+    static auto makeRows(std::uint32_t customers) -> std::vector<Row>
+    {
+        std::mt19937 generator(11);
+        std::uniform_int_distribution<std::uint32_t> customerOf(0, customers - 1);
+
+        std::vector<Row> rows(SOURCE_LENGTH);
+
+        for (Row& row : rows)
+        {
+            row = Row{customerOf(generator), 1.0};
+        }
+
+        return rows;
+    }
+
+    struct CustomerOf
+    {
+        std::uint32_t operator()(const Row& row) const { return row.customer; }
+    };
+
+    // Few keys stay in cache either way, many keys are where node-based maps fall behind.
+    static void countRowsPerCustomer()
+    {
+        for (const std::uint32_t customers : {std::uint32_t{1'000}, std::uint32_t{1'000'000}})
+        {
+            const std::vector<Row> rows = makeRows(customers);
+            const std::string suffix    = " (" + std::to_string(customers) + " keys)";
+
+            const auto nodeMap = Bench::measure("unordered_map<uint32_t, size_t> counting" + suffix,
+                                                SOURCE_LENGTH,
+                                                [&rows]
+                                                {
+                                                    std::unordered_map<std::uint32_t, std::size_t> counts;
+
+                                                    for (const Row& row : rows)
+                                                    {
+                                                        ++counts[row.customer];
+                                                    }
+
+                                                    Bench::keep(counts.size());
+                                                });
+
+            const auto flat = Bench::measure("vector<Row> | countBy(customer)" + suffix,
+                                             SOURCE_LENGTH,
+                                             [&rows]
+                                             {
+                                                 Bench::keep(rows | Seq::countBy(CustomerOf{}) | Seq::length());
+                                             });
+
+            Bench::report(nodeMap, "baseline");
+            Bench::report(flat);
+        }
+    }
+
+    static void groupRowsPerCustomer()
+    {
+        const std::vector<Row> rows = makeRows(100'000);
+
+        const auto nodeMap = Bench::measure("unordered_map<uint32_t, vector<Row>> grouping",
+                                            SOURCE_LENGTH,
+                                            [&rows]
+                                            {
+                                                std::unordered_map<std::uint32_t, std::vector<Row>> groups;
+
+                                                for (const Row& row : rows)
+                                                {
+                                                    groups[row.customer].push_back(row);
+                                                }
+
+                                                Bench::keep(groups.size());
+                                            });
+
+        const auto flat = Bench::measure("vector<Row> | groupBy(customer)",
+                                         SOURCE_LENGTH,
+                                         [&rows]
+                                         {
+                                             Bench::keep(rows | Seq::groupBy(CustomerOf{}) | Seq::length());
+                                         });
+
+        const auto distinct = Bench::measure("vector<Row> | distinctBy(customer)",
+                                             SOURCE_LENGTH,
+                                             [&rows]
+                                             {
+                                                 Bench::keep(rows | Seq::distinctBy(CustomerOf{}) | Seq::length());
+                                             });
+
+        Bench::report(nodeMap, "baseline");
+        Bench::report(flat);
+        Bench::report(distinct);
+    }
+
+    constexpr std::array CASES = {countRowsPerCustomer, groupRowsPerCustomer};
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace IoBench
+{
+    constexpr std::size_t LINES = 2'000'000;
+
+    struct LineLength
+    {
+        std::size_t operator()(std::string_view line) const { return line.size(); }
+    };
+
+    // A log-like file of two million lines, read line by line and summed up by length.
+    static void readLines()
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-bench-lines.txt";
+
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+            for (std::size_t idx = 0; idx < LINES; ++idx)
+            {
+                out << "2024-01-01T00:00:00 request " << idx << " served in " << idx % 997 << "ms\n";
+            }
+        }
+
+        const auto streamed = Bench::measure("ifstream + std::getline (2M lines)",
+                                             LINES,
+                                             [&path]
+                                             {
+                                                 std::ifstream in(path, std::ios::binary);
+                                                 std::string line;
+                                                 std::size_t total = 0;
+
+                                                 while (std::getline(in, line))
+                                                 {
+                                                     total += line.size();
+                                                 }
+
+                                                 Bench::keep(total);
+                                             });
+
+        const auto mapped = Bench::measure("mmapLines | map | sum (2M lines)",
+                                           LINES,
+                                           [&path]
+                                           {
+                                               Bench::keep(Seq::mmapLines(path) | Seq::map(LineLength()) | Seq::sum());
+                                           });
+
+        const auto readAhead = Bench::measure("readLines | map | sum (2M lines)",
+                                              LINES,
+                                              [&path]
+                                              {
+                                                  Bench::keep(Seq::readLines(path) | Seq::map(LineLength())
+                                                              | Seq::sum());
+                                              });
+
+        Bench::report(streamed, "baseline");
+        Bench::report(mapped);
+        Bench::report(readAhead, "read ahead on a thread");
+
+        std::filesystem::remove(path);
+    }
+
+    // The characters of a million lines of seven digits each.
+    struct CharOf
+    {
+        char operator()(int idx) const { return idx % 8 == 7 ? '\n' : static_cast<char>('0' + idx % 7); }
+    };
+
+    // Eight megabytes of text written to a file, once built as a whole string first and once streamed.
+    static void writeText()
+    {
+        constexpr int LINES_WRITTEN = 1'000'000;
+        constexpr int BYTES         = LINES_WRITTEN * 8;
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-bench-write.txt";
+
+        const auto whole = Bench::measure("toString + fwrite (8 MB)",
+                                          BYTES,
+                                          [&path]
+                                          {
+                                              const std::string text =
+                                                  Seq::range(0, BYTES) | Seq::map(CharOf()) | Seq::toString();
+                                              std::FILE* file = std::fopen(path.string().c_str(), "wb");
+                                              std::fwrite(text.data(), 1, text.size(), file);
+                                              std::fclose(file);
+                                          });
+
+        const auto streamed = Bench::measure("toOstream(ofstream) (8 MB)",
+                                             BYTES,
+                                             [&path]
+                                             {
+                                                 std::ofstream out(path, std::ios::binary);
+                                                 Seq::range(0, BYTES) | Seq::map(CharOf()) | Seq::toOstream(out, "");
+                                             });
+
+        const auto lines = Bench::measure("range | writeLines (8 MB)",
+                                          BYTES,
+                                          [&path]
+                                          {
+                                              Seq::range(1'000'000, 1'000'000 + LINES_WRITTEN) | Seq::writeLines(path);
+                                          });
+
+        const std::vector<double> records(BYTES / sizeof(double), 0.5);
+
+        const auto binary = Bench::measure("vector<double> | writeBinary (8 MB)",
+                                           BYTES,
+                                           [&path, &records]
+                                           {
+                                               records | Seq::writeBinary(path);
+                                           });
+
+        Bench::report(whole, "baseline");
+        Bench::report(streamed, "fixed buffer");
+        Bench::report(lines, "numbers formatted into the buffer");
+        Bench::report(binary, "one writev");
+
+        std::filesystem::remove(path);
+    }
+
+    constexpr std::array CASES = {readLines, writeText};
+}
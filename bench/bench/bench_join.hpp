@@ -0,0 +1,164 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace JoinBench
+{
+    struct Event
+    {
+        std::uint32_t customer;
+        double amount;
+    };
+
+    struct Customer
+    {
+        std::uint32_t id;
+        double discount;
+    };
+
+    static auto makeEvents(std::size_t count, std::uint32_t customers) -> std::vector<Event>
+    {
+        std::mt19937 generator(17);
+        std::uniform_int_distribution<std::uint32_t> customerOf(0, customers - 1);
+
+        std::vector<Event> events(count);
+
+        for (Event& event : events)
+        {
+            event = Event{customerOf(generator), 1.0};
+        }
+
+        return events;
+    }
+
+    static auto makeCustomers(std::uint32_t count) -> std::vector<Customer>
+    {
+        std::vector<Customer> customers(count);
+
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            customers[id] = Customer{id, 0.1};
+        }
+
+        return customers;
+    }
+
+    struct EventCustomer
+    {
+        std::uint32_t operator()(const Event& event) const { return event.customer; }
+    };
+
+    struct CustomerId
+    {
+        std::uint32_t operator()(const Customer& customer) const { return customer.id; }
+    };
+
+    struct Discounted
+    {
+        double operator()(const Event& event, const Customer& customer) const
+        {
+            return event.amount * (1.0 - customer.discount);
+        }
+    };
+
+    // The nested loop is quadratic, so it only gets a small outer side.
+    static void joinAgainstNestedLoop()
+    {
+        constexpr std::size_t EVENTS      = 20'000;
+        constexpr std::uint32_t CUSTOMERS = 5'000;
+
+        const std::vector<Event> events       = makeEvents(EVENTS, CUSTOMERS);
+        const std::vector<Customer> customers = makeCustomers(CUSTOMERS);
+
+        const auto nestedLoop = Bench::measure("nested loop join (5K inner)",
+                                               EVENTS,
+                                               [&events, &customers]
+                                               {
+                                                   double total = 0;
+
+                                                   for (const Event& event : events)
+                                                   {
+                                                       for (const Customer& customer : customers)
+                                                       {
+                                                           if (event.customer == customer.id)
+                                                           {
+                                                               total += Discounted{}(event, customer);
+                                                           }
+                                                       }
+                                                   }
+
+                                                   Bench::keep(total);
+                                               });
+
+        const auto hashJoin =
+            Bench::measure("vector<Event> | join(customers) (5K inner)",
+                           EVENTS,
+                           [&events, &customers]
+                           {
+                               Bench::keep(events | Seq::join(customers, EventCustomer{}, CustomerId{}, Discounted{})
+                                           | Seq::sum());
+                           });
+
+        Bench::report(nestedLoop, "baseline");
+        Bench::report(hashJoin);
+    }
+
+    // Looking events up in a hand-built map is what `Seq::join` replaces.
+    static void joinAgainstUnorderedMap()
+    {
+        for (const std::uint32_t inner : {std::uint32_t{10'000}, std::uint32_t{2'000'000}})
+        {
+            constexpr std::size_t EVENTS = 2'000'000;
+
+            const std::vector<Event> events       = makeEvents(EVENTS, inner);
+            const std::vector<Customer> customers = makeCustomers(inner);
+            const std::string suffix              = " (" + std::to_string(inner) + " inner)";
+
+            const auto nodeMap = Bench::measure("unordered_map<uint32_t, Customer> lookup" + suffix,
+                                                EVENTS,
+                                                [&events, &customers]
+                                                {
+                                                    std::unordered_map<std::uint32_t, Customer> byId;
+
+                                                    for (const Customer& customer : customers)
+                                                    {
+                                                        byId.emplace(customer.id, customer);
+                                                    }
+
+                                                    double total = 0;
+
+                                                    for (const Event& event : events)
+                                                    {
+                                                        if (const auto it = byId.find(event.customer); it != byId.end())
+                                                        {
+                                                            total += Discounted{}(event, it->second);
+                                                        }
+                                                    }
+
+                                                    Bench::keep(total);
+                                                });
+
+            const auto hashJoin = Bench::measure(
+                "vector<Event> | join(customers)" + suffix,
+                EVENTS,
+                [&events, &customers]
+                {
+                    const auto discounted = Seq::join(customers, EventCustomer{}, CustomerId{}, Discounted{});
+                    Bench::keep(events | discounted | Seq::sum());
+                });
+
+            Bench::report(nodeMap, "baseline");
+            Bench::report(hashJoin);
+        }
+    }
+
+    constexpr std::array CASES = {joinAgainstNestedLoop, joinAgainstUnorderedMap};
+}
@@ -0,0 +1,495 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Every public operator of `seq.hpp` on its own, for each element type it supports and for a short and a long source.
+// The short source shows what an operator costs to set up, the long one what it costs per element. Benchmarks in the
+// other files compare selected operators with their hand-written counterparts in more detail.
+namespace OperatorBench
+{
+    constexpr std::array SIZES = {std::size_t{1'000}, std::size_t{100'000}};
+
+    template<typename T>
+    constexpr std::string_view TYPE_NAME = "?";
+
+    template<>
+    constexpr std::string_view TYPE_NAME<int> = "int";
+
+    template<>
+    constexpr std::string_view TYPE_NAME<double> = "double";
+
+    template<>
+    constexpr std::string_view TYPE_NAME<std::string> = "string";
+
+    // The same pseudo-random values with plenty of duplicates on every run.
+    template<typename T>
+    static auto makeSource(std::size_t length) -> std::vector<T>
+    {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> valueOf(0, static_cast<int>(length / 2));
+
+        std::vector<T> source;
+        source.reserve(length);
+
+        for (std::size_t idx = 0; idx < length; ++idx)
+        {
+            const int value = valueOf(generator);
+
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                source.push_back(std::format("item-{}", value));
+            }
+            else
+            {
+                source.push_back(static_cast<T>(value));
+            }
+        }
+
+        return source;
+    }
+
+    struct KeyOf
+    {
+        int operator()(int x) const { return x % 64; }
+
+        int operator()(double x) const { return static_cast<int>(x) % 64; }
+
+        int operator()(const std::string& x) const
+        {
+            return static_cast<int>(x.back()) * 8 + static_cast<int>(x.size());
+        }
+    };
+
+    struct Transform
+    {
+        int operator()(int x) const { return x * 3 + 1; }
+
+        double operator()(double x) const { return x * 1.5 + 0.25; }
+
+        std::size_t operator()(const std::string& x) const { return x.size(); }
+    };
+
+    struct IsEven
+    {
+        template<typename T>
+        bool operator()(const T& x) const
+        {
+            return KeyOf()(x) % 2 == 0;
+        }
+    };
+
+    struct SumOfKeys
+    {
+        template<typename T>
+        int operator()(const T& outer, const T& inner) const
+        {
+            return KeyOf()(outer) + KeyOf()(inner);
+        }
+
+        template<typename T>
+        int operator()(const T& outer, std::span<const T> inner) const
+        {
+            return KeyOf()(outer) + static_cast<int>(inner.size());
+        }
+    };
+
+    struct IsNegative
+    {
+        template<typename T>
+        bool operator()(const T& x) const
+        {
+            return KeyOf()(x) < 0;
+        }
+    };
+
+    // Consumes every element, so stages cannot skip the work of producing them.
+    inline auto drain()
+    {
+        return Seq::iter([](const auto& elem) { Bench::keep(elem); });
+    }
+
+    // Measures the operator on a vector of T of every size.
+    // Parameter run has signature `(const std::vector<T>&) -> Result`, results are kept alive unless they are void.
+    template<typename T, typename Run>
+    static void measureOperator(std::string_view name, Run run)
+    {
+        for (const std::size_t length : SIZES)
+        {
+            const std::vector<T> source = makeSource<T>(length);
+
+            const auto measurement = Bench::measure(std::format("{}<{}>[{}]", name, TYPE_NAME<T>, length),
+                                                    length,
+                                                    [&source, &run]
+                                                    {
+                                                        if constexpr (std::is_void_v<decltype(run(source))>)
+                                                        {
+                                                            run(source);
+                                                        }
+                                                        else
+                                                        {
+                                                            Bench::keep(run(source));
+                                                        }
+                                                    });
+
+            Bench::report(measurement);
+        }
+    }
+
+    template<typename T>
+    static void stages()
+    {
+        measureOperator<T>("map", [](const auto& s) { s | Seq::map(Transform()) | drain(); });
+
+        measureOperator<T>("mapi",
+                           [](const auto& s)
+                           {
+                               s | Seq::mapi([](const T& x, std::size_t i) { return KeyOf()(x) + i; }) | drain();
+                           });
+
+        measureOperator<T>("filter", [](const auto& s) { s | Seq::filter(IsEven()) | drain(); });
+        measureOperator<T>("skip", [](const auto& s) { s | Seq::skip(s.size() / 2) | drain(); });
+        measureOperator<T>("skipWhile", [](const auto& s) { s | Seq::skipWhile(IsNegative()) | drain(); });
+        measureOperator<T>("take", [](const auto& s) { s | Seq::take(s.size() / 2) | drain(); });
+        measureOperator<T>("takeWhile", [](const auto& s) { s | Seq::takeWhile(std::not_fn(IsNegative())) | drain(); });
+        measureOperator<T>("tail", [](const auto& s) { s | Seq::tail() | drain(); });
+        measureOperator<T>("pairwise", [](const auto& s) { s | Seq::pairwise() | drain(); });
+        measureOperator<T>("pairwiseWrap", [](const auto& s) { s | Seq::pairwiseWrap() | drain(); });
+        measureOperator<T>("windowed", [](const auto& s) { s | Seq::windowed(4) | drain(); });
+        measureOperator<T>("chunkBySize", [](const auto& s) { s | Seq::chunkBySize(16) | drain(); });
+        measureOperator<T>("distinct", [](const auto& s) { s | Seq::distinct() | drain(); });
+        measureOperator<T>("distinctBy", [](const auto& s) { s | Seq::distinctBy(KeyOf()) | drain(); });
+    }
+
+    template<typename T>
+    static void folds()
+    {
+        const T needle = makeSource<T>(1).front();
+
+        measureOperator<T>("toVector", [](const auto& s) { return s | Seq::filter(IsEven()) | Seq::toVector(); });
+        measureOperator<T>("length", [](const auto& s) { return s | Seq::filter(IsEven()) | Seq::length(); });
+        measureOperator<T>("isEmpty", [](const auto& s) { return s | Seq::filter(IsNegative()) | Seq::isEmpty(); });
+        measureOperator<T>("count", [](const auto& s) { return s | Seq::count(IsEven()); });
+        measureOperator<T>("contains", [&needle](const auto& s) { return s | Seq::skip(1) | Seq::contains(needle); });
+        measureOperator<T>("exists", [](const auto& s) { return s | Seq::exists(IsNegative()); });
+        measureOperator<T>("forall", [](const auto& s) { return s | Seq::forall(std::not_fn(IsNegative())); });
+        measureOperator<T>("findIndex", [](const auto& s) { return s | Seq::findIndex(IsNegative()); });
+        measureOperator<T>("iter", [](const auto& s) { s | drain(); });
+
+        measureOperator<T>("iteri",
+                           [](const auto& s)
+                           {
+                               s | Seq::iteri([](const T& x, std::size_t) { Bench::keep(x); });
+                           });
+
+        measureOperator<T>("min", [](const auto& s) { return s | Seq::min(); });
+        measureOperator<T>("max", [](const auto& s) { return s | Seq::max(); });
+
+        measureOperator<T>("reduce",
+                           [](const auto& s)
+                           {
+                               return s | Seq::reduce(0, [](const T& x, int acc) { return acc + KeyOf()(x); });
+                           });
+
+        measureOperator<T>("countBy", [](const auto& s) { return s | Seq::countBy(KeyOf()) | Seq::toVector(); });
+        measureOperator<T>("groupBy", [](const auto& s) { return s | Seq::groupBy(KeyOf()) | Seq::toVector(); });
+        measureOperator<T>("topK", [](const auto& s) { return s | Seq::topK(10, KeyOf()) | Seq::toVector(); });
+
+        measureOperator<T>("toOstream",
+                           [](const auto& s)
+                           {
+                               std::ostringstream out;
+                               return s | Seq::toOstream(out, " ");
+                           });
+
+        measureOperator<T>("reduceParallel",
+                           [](const auto& s)
+                           {
+                               return s
+                                      | Seq::reduceParallel(0,
+                                                            [](const T& x, int acc) { return acc + KeyOf()(x); },
+                                                            [](int left, int right) { return left + right; });
+                           });
+
+        const auto countKey = [](std::vector<int>& histogram, const T& x)
+        {
+            ++histogram[KeyOf()(x) % 64];
+        };
+
+        const auto mergeCounts = [](std::vector<int>& histogram, const std::vector<int>& other)
+        {
+            for (std::size_t idx = 0; idx < histogram.size(); ++idx)
+            {
+                histogram[idx] += other[idx];
+            }
+        };
+
+        measureOperator<T>("aggregateParallel",
+                           [&countKey, &mergeCounts](const auto& s)
+                           {
+                               return s | Seq::aggregateParallel(std::vector<int>(64), countKey, mergeCounts);
+                           });
+    }
+
+    template<typename T>
+    static void numericFolds()
+    {
+        measureOperator<T>("sum", [](const auto& s) { return s | Seq::sum(); });
+        measureOperator<T>("average", [](const auto& s) { return s | Seq::average(); });
+
+        measureOperator<T>("batched | map | sum",
+                           [](const auto& s)
+                           {
+                               return s | Seq::batched() | Seq::map(Transform()) | Seq::sum();
+                           });
+    }
+
+    template<typename T>
+    static void ordering()
+    {
+        measureOperator<T>("sort", [](const auto& s) { s | Seq::sort() | drain(); });
+        measureOperator<T>("sortDescending", [](const auto& s) { s | Seq::sortDescending() | drain(); });
+        measureOperator<T>("sortBy", [](const auto& s) { s | Seq::sortBy(KeyOf()) | drain(); });
+        measureOperator<T>("sortByDescending", [](const auto& s) { s | Seq::sortByDescending(KeyOf()) | drain(); });
+        measureOperator<T>("stableSortBy", [](const auto& s) { s | Seq::stableSortBy(KeyOf()) | drain(); });
+
+        measureOperator<T>("stableSortByDescending",
+                           [](const auto& s)
+                           {
+                               s | Seq::stableSortByDescending(KeyOf()) | drain();
+                           });
+    }
+
+    // Budgets of a quarter of the source make every long source spill into temporary files.
+    template<typename T>
+    static void externalOrdering()
+    {
+        const auto budgetOf = [](const auto& s) { return std::max<std::size_t>(s.size() * sizeof(T) / 4, 64); };
+
+        measureOperator<T>("externalSort",
+                           [&budgetOf](const auto& s)
+                           {
+                               s | Seq::externalSort(budgetOf(s)) | drain();
+                           });
+
+        measureOperator<T>("externalSortDescending",
+                           [&budgetOf](const auto& s)
+                           {
+                               s | Seq::externalSortDescending(budgetOf(s)) | drain();
+                           });
+
+        measureOperator<T>("externalSortBy",
+                           [&budgetOf](const auto& s)
+                           {
+                               s | Seq::externalSortBy(budgetOf(s), KeyOf()) | drain();
+                           });
+
+        measureOperator<T>("externalSortByDescending",
+                           [&budgetOf](const auto& s)
+                           {
+                               s | Seq::externalSortByDescending(budgetOf(s), KeyOf()) | drain();
+                           });
+    }
+
+    // The other sequence holds every second element of the source.
+    template<typename T>
+    static void combining()
+    {
+        const auto halfOf = [](const auto& s)
+        {
+            std::vector<T> half;
+
+            for (std::size_t idx = 0; idx < s.size(); idx += 2)
+            {
+                half.push_back(s[idx]);
+            }
+
+            return half;
+        };
+
+        measureOperator<T>("except", [&halfOf](const auto& s) { s | Seq::except(halfOf(s)) | drain(); });
+        measureOperator<T>("intersect", [&halfOf](const auto& s) { s | Seq::intersect(halfOf(s)) | drain(); });
+        measureOperator<T>("unionWith", [&halfOf](const auto& s) { s | Seq::unionWith(halfOf(s)) | drain(); });
+
+        measureOperator<T>("join",
+                           [&halfOf](const auto& s)
+                           {
+                               const std::vector<T> inner = halfOf(s) | Seq::take(64) | Seq::toVector();
+                               s | Seq::join(inner, KeyOf(), KeyOf(), SumOfKeys()) | drain();
+                           });
+
+        measureOperator<T>("groupJoin",
+                           [&halfOf](const auto& s)
+                           {
+                               const std::vector<T> inner = halfOf(s) | Seq::take(64) | Seq::toVector();
+                               s | Seq::groupJoin(inner, KeyOf(), KeyOf(), SumOfKeys()) | drain();
+                           });
+    }
+
+    template<typename T>
+    static void threading()
+    {
+        measureOperator<T>("parallel | map",
+                           [](const auto& s)
+                           {
+                               return s | Seq::parallel(2) | Seq::map(Transform()) | Seq::toVector();
+                           });
+
+        measureOperator<T>("mapParallel", [](const auto& s) { s | Seq::mapParallel(Transform(), 2) | drain(); });
+        measureOperator<T>("prefetch", [](const auto& s) { s | Seq::prefetch(256) | drain(); });
+    }
+
+    template<typename T>
+    static auto yieldAsync(const std::vector<T>& source) -> AsyncEnumerable<T>
+    {
+        for (const T& elem : source)
+        {
+            co_yield elem;
+        }
+    }
+
+    template<typename T>
+    static void async()
+    {
+        const auto immediately = [](const T& x) -> Seq::Task<int> { co_return KeyOf()(x); };
+        const auto keptIf      = [](const T& x) -> Seq::Task<bool> { co_return IsEven()(x); };
+
+        measureOperator<T>("mapAsync | toVectorAsync",
+                           [&immediately](const auto& s)
+                           {
+                               Seq::EventLoop loop;
+                               return loop.run(yieldAsync(s) | Seq::mapAsync(immediately) | Seq::toVectorAsync());
+                           });
+
+        measureOperator<T>("filterAsync | iterAsync",
+                           [&keptIf](const auto& s)
+                           {
+                               Seq::EventLoop loop;
+                               loop.run(yieldAsync(s)
+                                        | Seq::filterAsync(keptIf)
+                                        | Seq::iterAsync([](const T& x) { Bench::keep(x); }));
+                           });
+    }
+
+    // Sources and sinks that are not fed by a container.
+    static void sourcesAndSinks()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::filesystem::path lines     = directory / "seq-bench-operators.txt";
+        const std::filesystem::path records   = directory / "seq-bench-operators.bin";
+
+        measureOperator<int>("range", [](const auto& s) { Seq::range(static_cast<int>(s.size())) | drain(); });
+
+        measureOperator<int>("toString",
+                             [](const auto& s)
+                             {
+                                 return s
+                                        | Seq::map([](int x) { return static_cast<char>('a' + x % 26); })
+                                        | Seq::toString();
+                             });
+
+        measureOperator<int>("writeLines", [&lines](const auto& s) { return s | Seq::writeLines(lines); });
+        measureOperator<int>("writeBinary", [&records](const auto& s) { return s | Seq::writeBinary(records); });
+
+        // The files written last hold the long source, which is what every reader is measured on
+        const std::size_t length = SIZES.back();
+
+        const auto readAll = [length](std::string_view name, auto read)
+        {
+            Bench::report(Bench::measure(std::format("{}[{}]", name, length), length, [&read] { read() | drain(); }));
+        };
+
+        readAll("readLines", [&lines] { return Seq::readLines(lines); });
+        readAll("readChunks", [&lines] { return Seq::readChunks(lines); });
+        readAll("mmapLines", [&lines] { return Seq::mmapLines(lines); });
+        readAll("mmapRecords", [&records] { return Seq::mmapRecords<int>(records); });
+
+        std::filesystem::remove(lines);
+        std::filesystem::remove(records);
+    }
+
+    // The same work as a hand-written loop, as `std::ranges` views and as a `Seq::` pipeline.
+    static void baselines()
+    {
+        measureOperator<int>("loop: map | filter | sum",
+                             [](const auto& s)
+                             {
+                                 long total = 0;
+
+                                 for (const int x : s)
+                                 {
+                                     const int y = Transform()(x);
+
+                                     if (IsEven()(y))
+                                     {
+                                         total += y;
+                                     }
+                                 }
+
+                                 return total;
+                             });
+
+        measureOperator<int>("ranges: transform | filter | fold",
+                             [](const auto& s)
+                             {
+                                 // Views are called instead of piped, `operator|` of the library would take them over
+                                 auto view = std::views::filter(std::views::transform(s, Transform()), IsEven());
+                                 return std::accumulate(view.begin(), view.end(), 0L);
+                             });
+
+        measureOperator<int>("seq: map | filter | sum",
+                             [](const auto& s)
+                             {
+                                 return s | Seq::map(Transform()) | Seq::filter(IsEven()) | Seq::sum();
+                             });
+
+        measureOperator<int>("std::ranges::sort",
+                             [](const auto& s)
+                             {
+                                 std::vector<int> sorted = s;
+                                 std::ranges::sort(sorted);
+                                 return sorted;
+                             });
+
+        measureOperator<int>("seq: sort | toVector", [](const auto& s) { return s | Seq::sort() | Seq::toVector(); });
+    }
+
+    constexpr std::array CASES = {
+        baselines,
+        stages<int>,
+        stages<double>,
+        stages<std::string>,
+        folds<int>,
+        folds<double>,
+        folds<std::string>,
+        numericFolds<int>,
+        numericFolds<double>,
+        ordering<int>,
+        ordering<double>,
+        ordering<std::string>,
+        externalOrdering<int>,
+        externalOrdering<double>,
+        combining<int>,
+        combining<double>,
+        combining<std::string>,
+        threading<int>,
+        threading<std::string>,
+        async<int>,
+        async<std::string>,
+        sourcesAndSinks,
+    };
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ParallelBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 2'000'000;
+
+    // Thread counts from 1 up to the number of hardware threads, doubling in between.
+    inline auto threadCounts() -> std::vector<std::size_t>
+    {
+        const std::size_t hardwareThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::vector<std::size_t> counts;
+
+        for (std::size_t threads = 1; threads < hardwareThreads; threads *= 2)
+        {
+            counts.push_back(threads);
+        }
+
+        counts.push_back(hardwareThreads);
+        return counts;
+    }
+
+    // A mapping that costs a few dozen nanoseconds, which is where spreading the work starts to pay off.
+    inline auto expensive(int x) -> double
+    {
+        double value = x;
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            value = std::sqrt(value + iteration) * 1.5;
+        }
+
+        return value;
+    }
+
+    static void mapFilterScaling()
+    {
+        std::vector<int> numbers(SOURCE_LENGTH);
+        std::iota(numbers.begin(), numbers.end(), 0);
+
+        const auto sequential = Bench::measure("vector | map | filter | toVector",
+                                               SOURCE_LENGTH,
+                                               [&numbers]
+                                               {
+                                                   Bench::keep(numbers
+                                                               | Seq::map(expensive)
+                                                               | Seq::filter([](double x) { return x > 10.0; })
+                                                               | Seq::toVector());
+                                               });
+
+        Bench::report(sequential, "sequential baseline");
+
+        for (const std::size_t threads : threadCounts())
+        {
+            const std::string name = std::format("vector | parallel({}) | map | filter | toVector", threads);
+            const auto parallel    = Bench::measure(name,
+                                                    SOURCE_LENGTH,
+                                                    [&numbers, threads]
+                                                    {
+                                                        Bench::keep(numbers
+                                                                    | Seq::parallel(threads)
+                                                                    | Seq::map(expensive)
+                                                                    | Seq::filter([](double x) { return x > 10.0; })
+                                                                    | Seq::toVector());
+                                                    });
+
+            Bench::report(parallel, std::format("{:.2f}x", sequential.nsPerElement / parallel.nsPerElement));
+        }
+    }
+
+    // Cheap mappings are dominated by memory bandwidth and the final merge, so they scale worse.
+    static void cheapMapScaling()
+    {
+        std::vector<int> numbers(SOURCE_LENGTH);
+        std::iota(numbers.begin(), numbers.end(), 0);
+
+        const auto sequential = Bench::measure("vector | map(x * 2) | toVector",
+                                               SOURCE_LENGTH,
+                                               [&numbers]
+                                               {
+                                                   Bench::keep(numbers
+                                                               | Seq::map([](int x) { return x * 2; })
+                                                               | Seq::toVector());
+                                               });
+
+        Bench::report(sequential, "sequential baseline");
+
+        for (const std::size_t threads : threadCounts())
+        {
+            const std::string name = std::format("vector | parallel({}) | map(x * 2) | toVector", threads);
+            const auto parallel    = Bench::measure(name,
+                                                    SOURCE_LENGTH,
+                                                    [&numbers, threads]
+                                                    {
+                                                        Bench::keep(numbers
+                                                                    | Seq::parallel(threads)
+                                                                    | Seq::map([](int x) { return x * 2; })
+                                                                    | Seq::toVector());
+                                                    });
+
+            Bench::report(parallel, std::format("{:.2f}x", sequential.nsPerElement / parallel.nsPerElement));
+        }
+    }
+
+    // Both halves cost about the same, so running them on two threads at once should take half as long at best.
+    static void prefetchOverlap()
+    {
+        const int length = static_cast<int>(SOURCE_LENGTH);
+
+        const auto sequential = Bench::measure("range | map | map | sum",
+                                               SOURCE_LENGTH,
+                                               [length]
+                                               {
+                                                   Bench::keep(Seq::range(length)
+                                                               | Seq::map(expensive)
+                                                               | Seq::map([](double x) { return expensive(int(x)); })
+                                                               | Seq::sum());
+                                               });
+
+        Bench::report(sequential, "single thread baseline");
+
+        for (const std::size_t capacity : {64ul, 1024ul})
+        {
+            const std::string name = std::format("range | map | prefetch({}) | map | sum", capacity);
+            const auto prefetched  = Bench::measure(name,
+                                                    SOURCE_LENGTH,
+                                                    [length, capacity]
+                                                    {
+                                                        Bench::keep(Seq::range(length)
+                                                                    | Seq::map(expensive)
+                                                                    | Seq::prefetch(capacity)
+                                                                    | Seq::map([](double x)
+                                                                               { return expensive(int(x)); })
+                                                                    | Seq::sum());
+                                                    });
+
+            Bench::report(prefetched, std::format("{:.2f}x", sequential.nsPerElement / prefetched.nsPerElement));
+        }
+    }
+
+    // Generators cannot be split, so their elements are handed to the pool in batches while they are produced.
+    static void mapParallelScaling()
+    {
+        const int length = static_cast<int>(SOURCE_LENGTH);
+
+        const auto sequential = Bench::measure("range | map | sum",
+                                               SOURCE_LENGTH,
+                                               [length]
+                                               {
+                                                   Bench::keep(Seq::range(length) | Seq::map(expensive) | Seq::sum());
+                                               });
+
+        Bench::report(sequential, "sequential baseline");
+
+        for (const std::size_t threads : threadCounts())
+        {
+            const std::string name = std::format("range | mapParallel(threads: {}) | sum", threads);
+            const auto parallel    = Bench::measure(name,
+                                                    SOURCE_LENGTH,
+                                                    [length, threads]
+                                                    {
+                                                        Bench::keep(Seq::range(length)
+                                                                    | Seq::mapParallel(expensive, threads)
+                                                                    | Seq::sum());
+                                                    });
+
+            Bench::report(parallel, std::format("{:.2f}x", sequential.nsPerElement / parallel.nsPerElement));
+        }
+    }
+
+    constexpr std::array CASES = {mapFilterScaling, cheapMapScaling, prefetchOverlap, mapParallelScaling};
+}
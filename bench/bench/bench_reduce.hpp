@@ -0,0 +1,140 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace ReduceBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 1'000'000;
+
+    // A plain loop is the baseline, it cannot be vectorized because floating-point additions may not be reordered.
+    static void sumFloats()
+    {
+        const std::vector<float> telemetry(SOURCE_LENGTH, 0.1f);
+
+        const auto scalar = Bench::measure("for (x : vector<float>) total += x",
+                                           SOURCE_LENGTH,
+                                           [&telemetry]
+                                           {
+                                               float total = 0.f;
+
+                                               for (const float value : telemetry)
+                                               {
+                                                   total += value;
+                                               }
+
+                                               Bench::keep(total);
+                                           });
+
+        const auto fast = Bench::measure("vector<float> | sum",
+                                         SOURCE_LENGTH,
+                                         [&telemetry]
+                                         {
+                                             Bench::keep(telemetry | Seq::sum());
+                                         });
+
+        const auto pairwise = Bench::measure("vector<float> | sum<PAIRWISE>",
+                                             SOURCE_LENGTH,
+                                             [&telemetry]
+                                             {
+                                                 Bench::keep(telemetry | Seq::sum<void, Seq::Summation::PAIRWISE>());
+                                             });
+
+        const auto kahan = Bench::measure("vector<float> | sum<KAHAN>",
+                                          SOURCE_LENGTH,
+                                          [&telemetry]
+                                          {
+                                              Bench::keep(telemetry | Seq::sum<void, Seq::Summation::KAHAN>());
+                                          });
+
+        Bench::report(scalar, "baseline");
+        Bench::report(fast, "independent lanes");
+        Bench::report(pairwise, "balanced tree of blocks");
+        Bench::report(kahan, "compensated lanes");
+    }
+
+    // Elements produced by a pipeline are staged into a buffer before being summed.
+    static void sumMappedFloats()
+    {
+        const std::vector<int> readings(SOURCE_LENGTH, 3);
+
+        const auto measurement = Bench::measure("vector<int> | map(to float) | sum",
+                                                SOURCE_LENGTH,
+                                                [&readings]
+                                                {
+                                                    Bench::keep(readings
+                                                                | Seq::map([](int x) { return x * 0.5f; })
+                                                                | Seq::sum());
+                                                });
+
+        Bench::report(measurement, "staged through the stack");
+    }
+
+    static void minMaxInts()
+    {
+        const std::vector<int> readings(SOURCE_LENGTH, 7);
+
+        const auto min = Bench::measure("vector<int> | min",
+                                        SOURCE_LENGTH,
+                                        [&readings]
+                                        {
+                                            Bench::keep(readings | Seq::min());
+                                        });
+
+        const auto average = Bench::measure("vector<int> | average",
+                                            SOURCE_LENGTH,
+                                            [&readings]
+                                            {
+                                                Bench::keep(readings | Seq::average());
+                                            });
+
+        Bench::report(min);
+        Bench::report(average);
+    }
+
+    // Partial sums are combined in the same tree for every thread count, so only the time should change.
+    static void reduceParallelDoubles()
+    {
+        const std::vector<double> telemetry(SOURCE_LENGTH, 0.1);
+
+        const auto add = [](double x, double accum)
+        {
+            return accum + x;
+        };
+
+        const auto combine = [](double left, double right)
+        {
+            return left + right;
+        };
+
+        const auto sequential = Bench::measure("vector<double> | reduce",
+                                               SOURCE_LENGTH,
+                                               [&telemetry, &add]
+                                               {
+                                                   Bench::keep(telemetry | Seq::reduce(0.0, add));
+                                               });
+
+        Bench::report(sequential, "sequential baseline");
+
+        for (const std::size_t threads : {1ul, 2ul, 4ul})
+        {
+            const std::string name = std::format("vector<double> | reduceParallel(threads: {})", threads);
+            const auto parallel    = Bench::measure(name,
+                                                    SOURCE_LENGTH,
+                                                    [&telemetry, &add, &combine, threads]
+                                                    {
+                                                        Bench::keep(telemetry
+                                                                    | Seq::reduceParallel(0.0, add, combine, threads));
+                                                    });
+
+            Bench::report(parallel, std::format("{:.2f}x", sequential.nsPerElement / parallel.nsPerElement));
+        }
+    }
+
+    constexpr std::array CASES = {sumFloats, sumMappedFloats, minMaxInts, reduceParallelDoubles};
+}
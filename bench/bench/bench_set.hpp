@@ -0,0 +1,95 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace SetBench
+{
+    static auto makeIds(std::size_t count, std::uint64_t range, std::uint32_t seed) -> std::vector<std::uint64_t>
+    {
+        std::mt19937_64 generator(seed);
+        std::uniform_int_distribution<std::uint64_t> idOf(0, range - 1);
+
+        std::vector<std::uint64_t> ids(count);
+
+        for (std::uint64_t& id : ids)
+        {
+            id = idOf(generator);
+        }
+
+        return ids;
+    }
+
+    // What deduplication jobs did before, `Seq::contains` inside `Seq::filter` is quadratic.
+    static void exceptAgainstContains()
+    {
+        constexpr std::size_t INCOMING = 20'000;
+        constexpr std::size_t KNOWN    = 5'000;
+
+        const std::vector<std::uint64_t> incoming = makeIds(INCOMING, 40'000, 3);
+        const std::vector<std::uint64_t> known    = makeIds(KNOWN, 40'000, 5);
+
+        const auto scan = Bench::measure("filter(not contains) (5K known)",
+                                         INCOMING,
+                                         [&incoming, &known]
+                                         {
+                                             const auto isNew = [&known](std::uint64_t id)
+                                             {
+                                                 return !(known | Seq::contains(id));
+                                             };
+
+                                             Bench::keep(incoming | Seq::filter(isNew) | Seq::length());
+                                         });
+
+        const auto hashed = Bench::measure("vector | except(known) (5K known)",
+                                           INCOMING,
+                                           [&incoming, &known]
+                                           {
+                                               Bench::keep(incoming | Seq::except(known) | Seq::length());
+                                           });
+
+        Bench::report(scan, "baseline");
+        Bench::report(hashed);
+    }
+
+    // Most incoming ids are new, so the Bloom filter answers for most of them on its own.
+    static void exceptLargeKnownSet()
+    {
+        constexpr std::size_t INCOMING = 2'000'000;
+        constexpr std::size_t KNOWN    = 4'000'000;
+
+        const std::vector<std::uint64_t> incoming = makeIds(INCOMING, std::uint64_t{1} << 40, 7);
+        const std::vector<std::uint64_t> known    = makeIds(KNOWN, std::uint64_t{1} << 40, 11);
+
+        const auto hashed = Bench::measure("vector | except(known) (4M known, hashed)",
+                                           INCOMING,
+                                           [&incoming, &known]
+                                           {
+                                               Bench::keep(incoming | Seq::except(known) | Seq::length());
+                                           });
+
+        std::vector<std::uint64_t> sortedIncoming = incoming;
+        std::vector<std::uint64_t> sortedKnown    = known;
+        std::ranges::sort(sortedIncoming);
+        std::ranges::sort(sortedKnown);
+
+        const auto merged = Bench::measure("sorted vector | except<MERGE>(known) (4M known)",
+                                           INCOMING,
+                                           [&sortedIncoming, &sortedKnown]
+                                           {
+                                               const auto fresh = Seq::except<Seq::SetStrategy::MERGE>(sortedKnown);
+                                               Bench::keep(sortedIncoming | fresh | Seq::length());
+                                           });
+
+        Bench::report(hashed);
+        Bench::report(merged);
+    }
+
+    constexpr std::array CASES = {exceptAgainstContains, exceptLargeKnownSet};
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace SortBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 2'000'000;
+
+    template<Seq::SortBackend Backend>
+    static void sortTimestampsWith(const std::vector<int64_t>& timestamps, std::string_view name)
+    {
+        const auto measurement = Bench::measure(name,
+                                                SOURCE_LENGTH,
+                                                [&timestamps]
+                                                {
+                                                    Bench::keep(timestamps | Seq::sort<Backend>() | Seq::toVector());
+                                                });
+
+        Bench::report(measurement);
+    }
+
+    static void sortTimestamps()
+    {
+        std::mt19937_64 generator(7);
+        std::uniform_int_distribution<int64_t> offsets(0, int64_t{1} << 40);
+
+        std::vector<int64_t> timestamps(SOURCE_LENGTH);
+        std::generate(timestamps.begin(), timestamps.end(), [&] { return offsets(generator); });
+
+        sortTimestampsWith<Seq::SortBackend::STANDARD>(timestamps, "vector<int64_t> | sort<STANDARD>");
+        sortTimestampsWith<Seq::SortBackend::PARALLEL>(timestamps, "vector<int64_t> | sort<PARALLEL>");
+        sortTimestampsWith<Seq::SortBackend::RADIX>(timestamps, "vector<int64_t> | sort<RADIX>");
+    }
+
+    struct Event
+    {
+        double score;
+        std::string name;
+    };
+
+    struct ScoreOf
+    {
+        double operator()(const Event& event) const { return event.score; }
+    };
+
+    template<Seq::SortBackend Backend>
+    static void sortEventsWith(const std::vector<Event>& events, std::string_view name)
+    {
+        const auto measurement = Bench::measure(name,
+                                                events.size(),
+                                                [&events]
+                                                {
+                                                    Bench::keep(events | Seq::sortBy<Backend>(ScoreOf{})
+                                                                | Seq::toVector());
+                                                });
+
+        Bench::report(measurement);
+    }
+
+    static void sortEventsByScore()
+    {
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<double> scores(-1.0, 1.0);
+
+        std::vector<Event> events(SOURCE_LENGTH / 4);
+        std::generate(events.begin(), events.end(), [&] { return Event{scores(generator), "event"}; });
+
+        sortEventsWith<Seq::SortBackend::STANDARD>(events, "vector<Event> | sortBy<STANDARD>(score)");
+        sortEventsWith<Seq::SortBackend::RADIX>(events, "vector<Event> | sortBy<RADIX>(score)");
+    }
+
+    static void topTenEvents()
+    {
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<double> scores(-1.0, 1.0);
+
+        std::vector<Event> events(SOURCE_LENGTH / 4);
+        std::generate(events.begin(), events.end(), [&] { return Event{scores(generator), "event"}; });
+
+        const auto sortedPrefix = Bench::measure("vector<Event> | sortByDescending(score) | take(10)",
+                                                 events.size(),
+                                                 [&events]
+                                                 {
+                                                     Bench::keep(events | Seq::sortByDescending(ScoreOf{})
+                                                                 | Seq::take(10) | Seq::toVector());
+                                                 });
+
+        const auto boundedHeap = Bench::measure("vector<Event> | topK(10, score)",
+                                                events.size(),
+                                                [&events]
+                                                {
+                                                    Bench::keep(events | Seq::topK(10, ScoreOf{}) | Seq::toVector());
+                                                });
+
+        Bench::report(sortedPrefix);
+        Bench::report(boundedHeap);
+    }
+
+    constexpr std::array CASES = {sortTimestamps, sortEventsByScore, topTenEvents};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <format>
+#include <limits>
+#include <vector>
+
+namespace TakeBench
+{
+    constexpr std::size_t SOURCE_LENGTH = 1'000'000;
+
+    // An upstream `Seq::take` used to keep draining its source, evaluating every mapping along the way.
+    static void takeAfterMap()
+    {
+        std::size_t evaluated = 0;
+
+        const auto measurement = Bench::measure("range | map | take(10) | sum",
+                                                10,
+                                                [&evaluated]
+                                                {
+                                                    evaluated = 0;
+
+                                                    const int total = Seq::range(static_cast<int>(SOURCE_LENGTH))
+                                                                      | Seq::map(
+                                                                          [&evaluated](int n)
+                                                                          {
+                                                                              ++evaluated;
+                                                                              return n * 3;
+                                                                          })
+                                                                      | Seq::take(10)
+                                                                      | Seq::sum();
+
+                                                    Bench::keep(total);
+                                                });
+
+        Bench::report(measurement, std::format("mapped {} of {} elements", evaluated, SOURCE_LENGTH));
+    }
+
+    // Contiguous sources jump ahead, other sources have to iterate over the skipped elements.
+    static void skipContiguous()
+    {
+        const std::vector<int> numbers(SOURCE_LENGTH, 1);
+
+        const auto jumping = Bench::measure("vector | skip(n - 10) | sum",
+                                            10,
+                                            [&numbers]
+                                            {
+                                                Bench::keep(numbers | Seq::skip(SOURCE_LENGTH - 10) | Seq::sum());
+                                            });
+
+        const auto iterating = Bench::measure("vector | filter | skip(n - 10) | sum",
+                                              10,
+                                              [&numbers]
+                                              {
+                                                  Bench::keep(numbers
+                                                              | Seq::filter([](int) { return true; })
+                                                              | Seq::skip(SOURCE_LENGTH - 10)
+                                                              | Seq::sum());
+                                              });
+
+        Bench::report(jumping, "jumps ahead");
+        Bench::report(iterating, "iterates over skipped elements");
+    }
+
+    static void takeWhileUnbounded()
+    {
+        const auto measurement = Bench::measure("range(INT_MAX) | takeWhile(< 1000) | sum",
+                                                1000,
+                                                []
+                                                {
+                                                    Bench::keep(Seq::range(std::numeric_limits<int>::max())
+                                                                | Seq::takeWhile([](int n) { return n < 1000; })
+                                                                | Seq::sum());
+                                                });
+
+        Bench::report(measurement, "stops at the first failing element");
+    }
+
+    constexpr std::array CASES = {takeAfterMap, skipContiguous, takeWhileUnbounded};
+}
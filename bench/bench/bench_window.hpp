@@ -0,0 +1,104 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/measure.hpp"
+
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace WindowBench
+{
+    constexpr std::size_t DIGITS = 3'000'000;
+
+    struct ParseChunk
+    {
+        int operator()(std::string_view chunk) const
+        {
+            int value = 0;
+
+            for (const char digit : chunk)
+            {
+                value = value * 10 + (digit - '0');
+            }
+
+            return value;
+        }
+    };
+
+    struct WindowTotal
+    {
+        int operator()(std::span<const int> window) const { return std::accumulate(window.begin(), window.end(), 0); }
+    };
+
+    // Chunks of a string like in example 005, against what it costs to copy every chunk into a vector of its own.
+    static void chunkDigits()
+    {
+        std::string digits(DIGITS, '0');
+
+        for (std::size_t idx = 0; idx < DIGITS; ++idx)
+        {
+            digits[idx] = static_cast<char>('0' + idx % 10);
+        }
+
+        const auto copied = Bench::measure("copy chunks of string into vector<char>",
+                                           DIGITS,
+                                           [&digits]
+                                           {
+                                               std::vector<char> chunk;
+                                               int total = 0;
+
+                                               for (std::size_t offset = 0; offset < digits.size(); offset += 3)
+                                               {
+                                                   const char* first = digits.data() + offset;
+                                                   chunk.assign(first, first + 3);
+                                                   total += ParseChunk{}(std::string_view(chunk.data(), chunk.size()));
+                                               }
+
+                                               Bench::keep(total);
+                                           });
+
+        const auto viewed = Bench::measure("string | chunkBySize(3) | map(parse) | sum",
+                                           DIGITS,
+                                           [&digits]
+                                           {
+                                               Bench::keep(digits | Seq::chunkBySize(3) | Seq::map(ParseChunk{})
+                                                           | Seq::sum());
+                                           });
+
+        Bench::report(copied, "baseline");
+        Bench::report(viewed, "views into the string");
+    }
+
+    // Moving totals over a window of 8, borrowed from a vector or kept in a ring for a generated sequence.
+    static void movingTotal()
+    {
+        constexpr int LENGTH = 1'000'000;
+
+        const std::vector<int> samples = Seq::range(0, LENGTH) | Seq::toVector();
+
+        const auto viewed = Bench::measure("vector | windowed(8) | map(total) | sum",
+                                           LENGTH,
+                                           [&samples]
+                                           {
+                                               Bench::keep(samples | Seq::windowed(8) | Seq::map(WindowTotal{})
+                                                           | Seq::sum());
+                                           });
+
+        const auto ring = Bench::measure("range | windowed(8) | map(total) | sum",
+                                         LENGTH,
+                                         []
+                                         {
+                                             Bench::keep(Seq::range(0, LENGTH) | Seq::windowed(8)
+                                                         | Seq::map(WindowTotal{}) | Seq::sum());
+                                         });
+
+        Bench::report(viewed, "views into the vector");
+        Bench::report(ring, "ring buffer");
+    }
+
+    constexpr std::array CASES = {chunkDigits, movingTotal};
+}
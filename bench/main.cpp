@@ -0,0 +1,90 @@
+#include "bench/bench_batch.hpp"
+#include "bench/bench_group.hpp"
+#include "bench/bench_io.hpp"
+#include "bench/bench_join.hpp"
+#include "bench/bench_operators.hpp"
+#include "bench/bench_parallel.hpp"
+#include "bench/bench_reduce.hpp"
+#include "bench/bench_set.hpp"
+#include "bench/bench_sort.hpp"
+#include "bench/bench_take.hpp"
+#include "bench/bench_window.hpp"
+
+#include <filesystem>
+#include <string_view>
+
+// Pass `--json <path>` to also write every measurement to a JSON file.
+auto main(int argc, char** argv) -> int
+{
+    std::filesystem::path jsonPath;
+
+    for (int idx = 1; idx + 1 < argc; ++idx)
+    {
+        if (std::string_view(argv[idx]) == "--json")
+        {
+            jsonPath = argv[idx + 1];
+        }
+    }
+
+    for (const auto& benchFn : BatchBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : GroupBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : IoBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : JoinBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : OperatorBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : ParallelBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : ReduceBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : SetBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : SortBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : TakeBench::CASES)
+    {
+        benchFn();
+    }
+
+    for (const auto& benchFn : WindowBench::CASES)
+    {
+        benchFn();
+    }
+
+    if (!jsonPath.empty())
+    {
+        Bench::writeJson(jsonPath);
+    }
+
+    return 0;
+}
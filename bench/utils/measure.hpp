@@ -0,0 +1,157 @@
+#pragma once
+#include "seq/seq.hpp"
+#include "utils/alloc_counter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifndef SEQ_COUNT_RESUMES
+    #error "Benchmarks report coroutine resumes, build them with SEQ_COUNT_RESUMES defined"
+#endif
+
+namespace Bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Minimum amount of time spent on a single measurement.
+    constexpr std::chrono::milliseconds MIN_DURATION{100};
+
+    struct Measurement
+    {
+        std::string name;
+        std::size_t elements;
+        double nsPerElement;
+
+        // Counted during a single run on the measuring thread, threads of the library are not included.
+        double resumesPerElement;
+        double allocationsPerElement;
+    };
+
+    struct Record
+    {
+        Measurement measurement;
+        std::string note;
+    };
+
+    // Everything reported so far, in the order it was reported.
+    inline std::vector<Record> records;
+
+    // Prevents the compiler from optimizing away a computed result.
+    template<typename T>
+    inline void keep(const T& value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    // Runs the given function repeatedly and returns the fastest run normalized to a single element.
+    // Resumes and allocations are counted in a run of their own, after a first run has warmed up every cache.
+    template<typename Function>
+    inline auto measure(std::string_view name, std::size_t elements, Function&& function) -> Measurement
+    {
+        using std::chrono::duration;
+        using std::chrono::nanoseconds;
+
+        function();
+
+        const std::size_t resumesBefore     = Seq::_internal::resumeCount;
+        const std::size_t allocationsBefore = AllocCounter::count();
+        function();
+        const std::size_t allocations = AllocCounter::count() - allocationsBefore;
+        const std::size_t resumes     = Seq::_internal::resumeCount - resumesBefore;
+
+        const auto start = Clock::now();
+        auto best        = Clock::duration::max();
+
+        while (Clock::now() - start < MIN_DURATION)
+        {
+            const auto before = Clock::now();
+            function();
+            best = std::min(best, Clock::now() - before);
+        }
+
+        const double bestNs  = duration<double, std::nano>(best).count();
+        const double divisor = static_cast<double>(std::max<std::size_t>(elements, 1));
+
+        return Measurement{std::string(name),
+                           elements,
+                           bestNs / divisor,
+                           static_cast<double>(resumes) / divisor,
+                           static_cast<double>(allocations) / divisor};
+    }
+
+    inline void report(const Measurement& measurement, std::string_view note = "")
+    {
+        std::cout << std::format("{:<56} {:>12.3f} ns/elem {:>8.3f} resumes/elem {:>8.3f} allocs/elem  {}\n",
+                                 measurement.name,
+                                 measurement.nsPerElement,
+                                 measurement.resumesPerElement,
+                                 measurement.allocationsPerElement,
+                                 note);
+
+        records.push_back({measurement, std::string(note)});
+    }
+
+    inline auto jsonString(std::string_view text) -> std::string
+    {
+        std::string out = "\"";
+
+        for (const char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                out += '\\';
+                out += character;
+            }
+            else if (static_cast<unsigned char>(character) < 0x20)
+            {
+                out += std::format("\\u{:04x}", static_cast<unsigned>(character));
+            }
+            else
+            {
+                out += character;
+            }
+        }
+
+        return out + '"';
+    }
+
+    // Writes every reported measurement as a JSON array of objects, so results of two builds can be compared by tools.
+    inline void writeJson(const std::filesystem::path& path)
+    {
+        std::ofstream out(path, std::ios::trunc);
+
+        if (!out)
+        {
+            throw std::system_error(errno, std::generic_category(), "Could not create " + path.string());
+        }
+
+        out << "[\n";
+
+        for (std::size_t idx = 0; idx < records.size(); ++idx)
+        {
+            const Measurement& measurement = records[idx].measurement;
+
+            out << std::format("  {{\"name\": {}, \"elements\": {}, \"nsPerElement\": {}, \"resumesPerElement\": {}, "
+                               "\"allocationsPerElement\": {}, \"note\": {}}}{}\n",
+                               jsonString(measurement.name),
+                               measurement.elements,
+                               measurement.nsPerElement,
+                               measurement.resumesPerElement,
+                               measurement.allocationsPerElement,
+                               jsonString(records[idx].note),
+                               idx + 1 < records.size() ? "," : "");
+        }
+
+        out << "]\n";
+    }
+}
@@ -0,0 +1,45 @@
+// ┏━━━━━━━━━━━━━━━━━━━┓
+// ┃ alloc_counter.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━┛
+// Replaces the global allocation functions so tests and benchmarks can tell how many times the global heap was hit.
+// Replacements are not inline by definition, therefore this header must only be included by a single translation unit
+// of each executable. They are also kept out of line, otherwise GCC pairs the inlined `std::malloc` with
+// `operator delete` and warns about a mismatch.
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace AllocCounter
+{
+    inline std::atomic<std::size_t> globalAllocations = 0;
+
+    inline auto count() -> std::size_t { return globalAllocations.load(); }
+
+    // Allocations made by running the given function once on an input of the given length.
+    // Parameter run has signature `(int) -> void`.
+    template<typename Run>
+    inline auto countFor(const Run& run, int length) -> std::size_t
+    {
+        const std::size_t before = count();
+        run(length);
+        return count() - before;
+    }
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    ++AllocCounter::globalAllocations;
+
+    if (void* block = std::malloc(size == 0 ? 1 : size))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* block) noexcept { std::free(block); }
+
+[[gnu::noinline]] void operator delete(void* block, std::size_t /*unused*/) noexcept { std::free(block); }
@@ -8,9 +8,9 @@
 #include "seq/seq.hpp"
 #include <iostream>
 
-auto toSignedByte(const std::vector<char>& chunk) -> int
+auto toSignedByte(std::string_view chunk) -> int
 {
-    std::string chunkStr(chunk.begin(), chunk.end());
+    std::string chunkStr(chunk);
     return (std::stoi(chunkStr) ^ 0x80) - 0x80;
 }
 
@@ -0,0 +1,389 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ async_enumerable.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━┛
+// `AsyncEnumerable<T>` is the asynchronous counterpart of `IEnumerable<T>`. Its coroutine may `co_await` anything, e.g.
+// a socket becoming readable, between two `co_yield`. While it waits, the thread is free to run other coroutines
+// instead of blocking. Consumers are coroutines themselves, which pull the next element by awaiting `next()`. The
+// producer is then resumed right away and hands control straight back to the consumer with every `co_yield`, so
+// passing an element on costs two coroutine switches and nothing else. Elements are yielded copy-free exactly like in
+// `IEnumerable<T>`. `Seq::Task<T>` is the coroutine type of anything that computes a single value asynchronously, e.g.
+// `Seq::toVectorAsync`, and what `Seq::EventLoop` runs.
+#pragma once
+#include "frame_pool.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace Seq
+{
+    template<typename T = void>
+    class Task;
+
+    class EventLoop;
+}
+
+namespace Seq::_internal::Async
+{
+    // Hands control to whoever awaited the suspending coroutine, or back to its resumer if nobody did.
+    class Continue
+    {
+    private:
+        std::coroutine_handle<> continuation;
+
+    public:
+        explicit Continue(std::coroutine_handle<> continuation)
+            : continuation(continuation)
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> /*unused*/) const noexcept
+        {
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // NOLINTBEGIN(readability-identifier-naming): Promise type is expected to use snake case by C++ standard
+    class TaskPromiseBase
+    {
+    public:
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        Continue final_suspend() noexcept { return Continue(continuation); }
+
+        void unhandled_exception() { exception = std::current_exception(); }
+
+#ifndef SEQ_DISABLE_FRAME_POOL
+        static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+
+        static void operator delete(void* frame, std::size_t size) noexcept { FramePool::deallocate(frame, size); }
+#endif
+    };
+
+    template<typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+        std::optional<T> value;
+
+        auto get_return_object() -> Task<T>;
+
+        template<typename U>
+        void return_value(U&& result)
+        {
+            value.emplace(std::forward<U>(result));
+        }
+    };
+
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+        auto get_return_object() -> Task<void>;
+
+        void return_void() {}
+    };
+
+    // NOLINTEND(readability-identifier-naming)
+
+    // Awaitables either are their own awaiter or hand one out through `operator co_await`.
+    template<typename Awaitable>
+    auto awaiterOf(Awaitable&& awaitable) -> decltype(auto)
+    {
+        if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); })
+        {
+            return std::forward<Awaitable>(awaitable).operator co_await();
+        }
+        else
+        {
+            return std::forward<Awaitable>(awaitable);
+        }
+    }
+
+    template<typename Awaitable>
+    concept EnsureIsAwaitable = requires (Awaitable&& awaitable) { awaiterOf(awaitable).await_resume(); };
+
+    template<typename Awaitable>
+    using AwaitedOf = std::remove_cvref_t<decltype(awaiterOf(std::declval<Awaitable>()).await_resume())>;
+}
+
+namespace Seq
+{
+    // A coroutine computing a single value of type T. It does not start before it is either awaited by another
+    // coroutine or spawned on a `Seq::EventLoop`. Exceptions escaping it are rethrown to whoever awaits its result.
+    template<typename T>
+    class Task
+    {
+    public:
+        using promise_type = _internal::Async::TaskPromise<T>; // NOLINT(readability-identifier-naming)
+
+    private:
+        using Handle = std::coroutine_handle<promise_type>;
+
+        friend promise_type;
+        friend class EventLoop;
+
+        Handle handle;
+
+        explicit Task(Handle handle)
+            : handle(handle)
+        {
+        }
+
+        class Awaiter
+        {
+        private:
+            Handle handle;
+
+        public:
+            explicit Awaiter(Handle handle)
+                : handle(handle)
+            {
+            }
+
+            bool await_ready() const noexcept { return handle.done(); }
+
+            // Starts the task, which resumes the awaiting coroutine once it is done.
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() const { return Task::resultOf(handle); }
+        };
+
+        static T resultOf(Handle handle)
+        {
+            if (handle.promise().exception)
+            {
+                std::rethrow_exception(handle.promise().exception);
+            }
+
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(*handle.promise().value);
+            }
+        }
+
+    public:
+        Task(Task&& other) noexcept
+            : handle(std::exchange(other.handle, {}))
+        {
+        }
+
+        ~Task()
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+        Task(const Task&)                = delete;
+        Task& operator=(const Task&)     = delete;
+        Task& operator=(Task&&) noexcept = delete;
+
+        bool isDone() const { return handle && handle.done(); }
+
+        // Returns the result of a finished task or rethrows what escaped it. The result is moved out, so ask only once.
+        T result() const { return resultOf(handle); }
+
+        Awaiter operator co_await() const noexcept { return Awaiter(handle); }
+    };
+}
+
+namespace Seq::_internal::Async
+{
+    template<typename T>
+    auto TaskPromise<T>::get_return_object() -> Task<T>
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+    }
+
+    inline auto TaskPromise<void>::get_return_object() -> Task<void>
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+    }
+}
+
+template<typename T>
+class AsyncEnumerable
+{
+public:
+    // NOLINTBEGIN(readability-identifier-naming): Promise type is expected to use snake case by C++ standard
+    class promise_type
+    {
+    public:
+        using Handle = std::coroutine_handle<promise_type>;
+
+        auto get_return_object() { return AsyncEnumerable(Handle::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Tells the consumer waiting for the next element that there is none.
+        Seq::_internal::Async::Continue final_suspend() noexcept { return Seq::_internal::Async::Continue(consumer); }
+
+        // Exceptions escaping the coroutine are rethrown to the consumer waiting for the next element.
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        void return_void() {}
+
+#ifndef SEQ_DISABLE_FRAME_POOL
+        static void* operator new(std::size_t size) { return Seq::_internal::FramePool::allocate(size); }
+
+        static void operator delete(void* frame, std::size_t size) noexcept
+        {
+            Seq::_internal::FramePool::deallocate(frame, size);
+        }
+#endif
+
+    private:
+        friend class AsyncEnumerable;
+
+        // Points to the last yielded object, see `IEnumerable<T>`.
+        T* currentValue = nullptr;
+
+        std::coroutine_handle<> consumer;
+        std::exception_ptr exception;
+
+        // Suspends the producer and resumes the consumer that asked for the element in its place.
+        class HandOver
+        {
+        public:
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(Handle handle) const noexcept { return handle.promise().consumer; }
+
+            void await_resume() const noexcept {}
+        };
+
+        // Yielded expressions of a different type are converted into this awaiter that outlives the suspension too.
+        class ConvertedYield
+        {
+        private:
+            T value;
+
+        public:
+            template<typename U>
+            explicit ConvertedYield(U&& expr)
+                : value(std::forward<U>(expr))
+            {
+            }
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(Handle handle) noexcept
+            {
+                handle.promise().currentValue = std::addressof(value);
+                return handle.promise().consumer;
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+    public:
+        HandOver yield_value(T&& expr) noexcept
+        {
+            currentValue = std::addressof(expr);
+            return {};
+        }
+
+        HandOver yield_value(const T& expr) noexcept
+        {
+            // Constness is only dropped to let consumers hand over elements of move-only types, see `release`
+            currentValue = const_cast<T*>(std::addressof(expr));
+            return {};
+        }
+
+        template<typename U>
+        requires (!std::is_same_v<std::remove_cvref_t<U>, T> && std::is_constructible_v<T, U>)
+        ConvertedYield yield_value(U&& expr)
+        {
+            return ConvertedYield(std::forward<U>(expr));
+        }
+    };
+
+    // NOLINTEND(readability-identifier-naming)
+
+private:
+    promise_type::Handle asyncEnumerableHandle;
+
+    explicit AsyncEnumerable(const promise_type::Handle handle)
+        : asyncEnumerableHandle(handle)
+    {
+    }
+
+    class NextAwaiter
+    {
+    private:
+        promise_type::Handle handle;
+
+    public:
+        explicit NextAwaiter(promise_type::Handle handle)
+            : handle(handle)
+        {
+        }
+
+        bool await_ready() const noexcept { return handle.address() == nullptr || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) const noexcept
+        {
+            handle.promise().consumer = consumer;
+            return handle;
+        }
+
+        bool await_resume() const
+        {
+            if (handle.address() == nullptr)
+            {
+                return false;
+            }
+
+            if (handle.promise().exception)
+            {
+                std::rethrow_exception(std::exchange(handle.promise().exception, nullptr));
+            }
+
+            return !handle.done();
+        }
+    };
+
+public:
+    // Resumes the producer until it yields its next element. Awaiting it returns false once there are no more of them.
+    // Await it in a statement of its own, GCC 12 miscompiles coroutines awaiting it in the condition of a loop.
+    NextAwaiter next() const { return NextAwaiter(asyncEnumerableHandle); }
+
+    // The element yielded last, valid until `next` is awaited again.
+    const T& current() const { return *asyncEnumerableHandle.promise().currentValue; }
+
+    // Moves the current element out of the sequence. Meant for consumers of elements that cannot be copied.
+    T&& release() const { return std::move(*asyncEnumerableHandle.promise().currentValue); }
+
+    AsyncEnumerable(AsyncEnumerable&& other) noexcept
+        : asyncEnumerableHandle(std::exchange(other.asyncEnumerableHandle, {}))
+    {
+    }
+
+    ~AsyncEnumerable()
+    {
+        if (asyncEnumerableHandle)
+        {
+            asyncEnumerableHandle.destroy();
+        }
+    }
+
+    AsyncEnumerable(const AsyncEnumerable&)                = delete;
+    AsyncEnumerable& operator=(const AsyncEnumerable&)     = delete;
+    AsyncEnumerable& operator=(AsyncEnumerable&&) noexcept = delete;
+};
@@ -0,0 +1,146 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ async_operators.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━┛
+// Operators over `AsyncEnumerable<T>`. Every fused stage (`Seq::map`, `Seq::filter`, `Seq::take`...) works on them as
+// it is: each element is pushed through the sink of the stage as soon as it arrives and whatever comes out is yielded
+// on, and a stage that wants no more elements stops the producer from being resumed again. Operators whose callable
+// itself has to wait (`Seq::mapAsync`, `Seq::filterAsync`) and operators consuming the whole sequence
+// (`Seq::toVectorAsync`, `Seq::iterAsync`) are coroutines awaiting every element in turn.
+#pragma once
+#include "async_enumerable.hpp"
+#include "fused.hpp"
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Async
+{
+    // Every stage emits at most one element per element it receives, so a single slot is all it takes.
+    template<typename T, typename Stage>
+    auto throughStage(AsyncEnumerable<T> sequence, Stage stage) -> AsyncEnumerable<typename Stage::template Output<T>>
+    {
+        using U = typename Stage::template Output<T>;
+        std::optional<U> emitted;
+
+        auto sink = stage.wrap(
+            [&emitted]<typename Elem>(Elem&& elem) -> bool
+            {
+                emitted.emplace(std::forward<Elem>(elem));
+                return true;
+            });
+
+        while (true)
+        {
+            const bool hasNext = co_await sequence.next();
+
+            if (!hasNext)
+            {
+                break;
+            }
+
+            const bool wantsMore = sink(sequence.current());
+
+            if (emitted.has_value())
+            {
+                co_yield std::move(*emitted);
+                emitted.reset();
+            }
+
+            if (!wantsMore)
+            {
+                break;
+            }
+        }
+    }
+
+    template<typename T, typename Mapping>
+    auto mapAwaited(AsyncEnumerable<T> sequence, Mapping mapping)
+        -> AsyncEnumerable<AwaitedOf<std::invoke_result_t<Mapping&, const T&>>>
+    {
+        while (true)
+        {
+            const bool hasNext = co_await sequence.next();
+
+            if (!hasNext)
+            {
+                break;
+            }
+
+            co_yield co_await mapping(sequence.current());
+        }
+    }
+
+    template<typename T, typename Predicate>
+    auto filterAwaited(AsyncEnumerable<T> sequence, Predicate pred) -> AsyncEnumerable<T>
+    {
+        while (true)
+        {
+            const bool hasNext = co_await sequence.next();
+
+            if (!hasNext)
+            {
+                break;
+            }
+
+            const bool passes = co_await pred(sequence.current());
+
+            if (passes)
+            {
+                co_yield sequence.current();
+            }
+        }
+    }
+
+    template<typename T>
+    auto collect(AsyncEnumerable<T> sequence) -> Task<std::vector<T>>
+    {
+        std::vector<T> out;
+
+        while (true)
+        {
+            const bool hasNext = co_await sequence.next();
+
+            if (!hasNext)
+            {
+                break;
+            }
+
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                out.push_back(sequence.current());
+            }
+            else
+            {
+                out.push_back(sequence.release());
+            }
+        }
+
+        co_return out;
+    }
+
+    // Actions returning an awaitable are awaited before the next element is requested.
+    template<typename T, typename Action>
+    auto iterate(AsyncEnumerable<T> sequence, Action action) -> Task<void>
+    {
+        while (true)
+        {
+            const bool hasNext = co_await sequence.next();
+
+            if (!hasNext)
+            {
+                break;
+            }
+
+            if constexpr (EnsureIsAwaitable<std::invoke_result_t<Action&, const T&>>)
+            {
+                co_await action(sequence.current());
+            }
+            else
+            {
+                action(sequence.current());
+            }
+        }
+    }
+}
@@ -0,0 +1,397 @@
+// ┏━━━━━━━━━━━━━━┓
+// ┃ batching.hpp ┃
+// ┗━━━━━━━━━━━━━━┛
+// `Seq::batched` switches the stages following it from single elements to blocks. In a regular `Fused::Pipeline` every
+// element travels through all stages before the next one is read. Here each stage takes a whole block of up to
+// `BlockSize` elements as a `std::span<const T>` and writes its results into a reused block of its own, which is then
+// handed to the next stage. The loop of a stage over a block does nothing but that stage, so the compiler can keep its
+// state in registers and vectorize it. Contiguous sources are cut into blocks without being copied, anything else is
+// read into a block first. Folds that know about blocks (`Seq::sum`, `Seq::count`, `Seq::toVector`...) take the last
+// block at once. Every other operator gets the elements one at a time as an ordinary `IEnumerable<T>`, which resumes
+// once per block to fill the next one.
+#pragma once
+#include "buffer.hpp"
+#include "fused.hpp"
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Batching
+{
+    template<typename Source>
+    concept EnsureIsContiguous =
+        std::ranges::contiguous_range<const Source> && std::ranges::sized_range<const Source>;
+
+    // Appends whatever a stage emits to the block that is handed to the next stage.
+    template<typename T>
+    class Collect
+    {
+    private:
+        Buffer<T>* block;
+
+    public:
+        explicit Collect(Buffer<T>& block)
+            : block(&block)
+        {
+        }
+
+        template<typename Elem>
+        bool operator()(Elem&& elem) const
+        {
+            block->emplace_back(std::forward<Elem>(elem));
+            return true;
+        }
+    };
+
+    // Runs blocks of type `T` through the stages from `Index` on. The last one hands its block to a block sink, which
+    // returns false once it does not want any more of them.
+    template<std::size_t BlockSize, std::size_t Index, typename T, typename... Stages>
+    class Blockwise
+    {
+    public:
+        explicit Blockwise(std::tuple<Stages...>& /*stages*/)
+        {
+        }
+
+        template<typename BlockSink>
+        bool feed(std::span<const T> block, BlockSink& blockSink)
+        {
+            return blockSink(block);
+        }
+    };
+
+    // Stages like `Seq::map` and `Seq::filter` have a loop over a whole block of their own (see `applyToBlock`), which
+    // writes into a block of `BlockSize` elements created up front. Any other stage keeps a single sink for the whole
+    // run, so stages with state like `Seq::take` still count across blocks. Every stage emits at most one element per
+    // element it receives, so its block never grows beyond `BlockSize`.
+    template<std::size_t BlockSize, std::size_t Index, typename T, typename... Stages>
+    requires (Index < sizeof...(Stages))
+    class Blockwise<BlockSize, Index, T, Stages...>
+    {
+    private:
+        using Stage = std::tuple_element_t<Index, std::tuple<Stages...>>;
+        using Out   = typename Stage::template Output<T>;
+        using Sink  = decltype(std::declval<Stage&>().wrap(std::declval<Collect<Out>>()));
+
+        static constexpr bool IS_IN_PLACE = std::is_default_constructible_v<Out> && std::is_copy_assignable_v<Out>
+                                            && requires (Stage& stage, std::span<const T> block, Out* out) {
+                                                   { stage.applyToBlock(block, out) } -> std::same_as<std::size_t>;
+                                               };
+
+        Buffer<Out> block;
+        std::size_t filled = 0;
+        Stage* stage;
+        Sink sink;
+        Blockwise<BlockSize, Index + 1, Out, Stages...> rest;
+
+    public:
+        explicit Blockwise(std::tuple<Stages...>& stages)
+            : stage(&std::get<Index>(stages))
+            , sink(std::get<Index>(stages).wrap(Collect<Out>(block)))
+            , rest(stages)
+        {
+            if constexpr (IS_IN_PLACE)
+            {
+                block.resize(BlockSize);
+            }
+            else
+            {
+                block.reserve(BlockSize);
+            }
+        }
+
+        // The sink of the stage points at the block, so it must stay where it was constructed.
+        Blockwise(const Blockwise&)            = delete;
+        Blockwise& operator=(const Blockwise&) = delete;
+
+        template<typename BlockSink>
+        bool feed(std::span<const T> input, BlockSink& blockSink)
+        {
+            bool wantsMore = true;
+
+            if constexpr (IS_IN_PLACE)
+            {
+                filled = stage->applyToBlock(input, block.data());
+            }
+            else
+            {
+                block.clear();
+
+                for (const T& elem : input)
+                {
+                    if (!sink(elem))
+                    {
+                        wantsMore = false;
+                        break;
+                    }
+                }
+
+                filled = block.size();
+            }
+
+            if (filled > 0 && !rest.feed(std::span<const Out>(block.data(), filled), blockSink))
+            {
+                return false;
+            }
+
+            return wantsMore;
+        }
+    };
+
+    // `Source` is a borrowed view of a container, an `IEnumerable<T>` or another pipeline.
+    template<std::size_t BlockSize, typename Source, typename... Stages>
+    class Pipeline : public Fused::BlockwiseTag
+    {
+    public:
+        using SourceItem = Fused::ItemOf<Source>;
+        using Item       = typename Fused::OutputOf<SourceItem, Stages...>::Type;
+
+    private:
+        static_assert(std::is_copy_constructible_v<SourceItem>, "Seq::batched does not support move-only elements");
+
+        Source source;
+        std::tuple<Stages...> stages;
+
+        // Cuts the source into blocks and feeds them to the callable until it returns false.
+        template<typename Feed>
+        void readBlocks(Feed& feed)
+        {
+            if constexpr (EnsureIsContiguous<Source>)
+            {
+                const std::span<const SourceItem> all(std::ranges::data(source), std::ranges::size(source));
+
+                for (std::size_t offset = 0; offset < all.size(); offset += BlockSize)
+                {
+                    if (!feed(all.subspan(offset, std::min(BlockSize, all.size() - offset))))
+                    {
+                        return;
+                    }
+                }
+            }
+            else
+            {
+                Buffer<SourceItem> block;
+                block.reserve(BlockSize);
+                bool wantsMore = true;
+
+                Fused::forEach(source,
+                               [&feed, &block, &wantsMore]<typename Elem>(Elem&& elem) -> bool
+                               {
+                                   block.emplace_back(std::forward<Elem>(elem));
+
+                                   if (block.size() < BlockSize)
+                                   {
+                                       return true;
+                                   }
+
+                                   wantsMore = feed(std::span<const SourceItem>(block));
+                                   block.clear();
+                                   return wantsMore;
+                               });
+
+                if (wantsMore && !block.empty())
+                {
+                    feed(std::span<const SourceItem>(block));
+                }
+            }
+        }
+
+        // Same as `readBlocks` for the pulling side, the blocks stay valid until the next one is requested.
+        static auto blocksOf(Source source) -> IEnumerable<std::span<const SourceItem>>
+        {
+            if constexpr (EnsureIsContiguous<Source>)
+            {
+                const std::span<const SourceItem> all(std::ranges::data(source), std::ranges::size(source));
+
+                for (std::size_t offset = 0; offset < all.size(); offset += BlockSize)
+                {
+                    co_yield all.subspan(offset, std::min(BlockSize, all.size() - offset));
+                }
+            }
+            else
+            {
+                Buffer<SourceItem> block;
+                block.reserve(BlockSize);
+
+                const auto elements = [&source]
+                {
+                    if constexpr (Fused::EnsureIsPipeline<Source>)
+                    {
+                        return IEnumerable<SourceItem>(std::move(source));
+                    }
+                    else
+                    {
+                        return std::move(source);
+                    }
+                }();
+
+                for (const SourceItem& elem : elements)
+                {
+                    block.push_back(elem);
+
+                    if (block.size() == BlockSize)
+                    {
+                        co_yield std::span<const SourceItem>(block);
+                        block.clear();
+                    }
+                }
+
+                if (!block.empty())
+                {
+                    co_yield std::span<const SourceItem>(block);
+                }
+            }
+        }
+
+        static auto pull(Source source, std::tuple<Stages...> stages) -> IEnumerable<Item>
+        {
+            Blockwise<BlockSize, 0, SourceItem, Stages...> blockwise(stages);
+            Buffer<Item> ready;
+            ready.reserve(BlockSize);
+
+            const auto keep = [&ready](std::span<const Item> block) -> bool
+            {
+                for (const Item& elem : block)
+                {
+                    ready.push_back(elem);
+                }
+
+                return true;
+            };
+
+            for (std::span<const SourceItem> block : blocksOf(std::move(source)))
+            {
+                const bool wantsMore = blockwise.feed(block, keep);
+
+                for (const Item& elem : ready)
+                {
+                    co_yield elem;
+                }
+
+                ready.clear();
+
+                if (!wantsMore)
+                {
+                    break;
+                }
+            }
+        }
+
+    public:
+        Pipeline(Source source, std::tuple<Stages...> stages)
+            : source(std::move(source))
+            , stages(std::move(stages))
+        {
+        }
+
+        template<Fused::EnsureIsStage Stage>
+        auto append(Stage&& stage) &&
+        {
+            using Appended = TypeInspect::RemoveCVR<Stage>;
+            auto appended  = std::tuple_cat(std::move(stages), std::make_tuple(std::forward<Stage>(stage)));
+
+            return Pipeline<BlockSize, Source, Stages..., Appended>(std::move(source), std::move(appended));
+        }
+
+        SizeHint sizeHint() const
+        {
+            return std::apply(
+                [this](const Stages&... stage) -> SizeHint
+                {
+                    SizeHint hint = hintOf(source);
+                    ((hint = stage.hint(hint)), ...);
+                    return hint;
+                },
+                stages);
+        }
+
+        // Hands the results to the block sink one block at a time until either side runs out.
+        // Parameter blockSink has signature `(std::span<const Item>) -> bool`.
+        template<typename BlockSink>
+        void runBlocks(BlockSink& blockSink)
+        {
+            Blockwise<BlockSize, 0, SourceItem, Stages...> blockwise(stages);
+
+            auto feed = [&blockwise, &blockSink](std::span<const SourceItem> block) -> bool
+            {
+                return blockwise.feed(block, blockSink);
+            };
+
+            readBlocks(feed);
+        }
+
+        // Folds that only know single elements get the elements of every block in turn.
+        template<typename Sink>
+        void run(Sink& sink)
+        {
+            auto unpack = [&sink](std::span<const Item> block) -> bool
+            {
+                for (const Item& elem : block)
+                {
+                    if (!sink(elem))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            };
+
+            runBlocks(unpack);
+        }
+
+        operator IEnumerable<Item>() &&
+        {
+            const SizeHint hint = sizeHint().detached();
+            return pull(std::move(source), std::move(stages)).withSizeHint(hint);
+        }
+    };
+
+    template<std::size_t BlockSize>
+    class Mode
+    {
+    public:
+        static_assert(BlockSize > 0, "Seq::batched needs blocks of at least one element");
+
+        // Pipelines without stages are only a view of their source, which can then be cut into blocks directly.
+        template<typename Sequence>
+        auto operator()(Sequence&& sequence) const
+        {
+            if constexpr (requires { sequence.view(); })
+            {
+                using View = TypeInspect::RemoveCVR<decltype(sequence.view())>;
+                return Pipeline<BlockSize, View>(sequence.view(), {});
+            }
+            else
+            {
+                using Source = TypeInspect::RemoveCVR<Sequence>;
+                return Pipeline<BlockSize, Source>(std::forward<Sequence>(sequence), {});
+            }
+        }
+    };
+
+    template<typename T>
+    constexpr bool IS_MODE = false;
+
+    template<std::size_t BlockSize>
+    constexpr bool IS_MODE<Mode<BlockSize>> = true;
+
+    template<typename T>
+    concept EnsureIsMode = IS_MODE<TypeInspect::RemoveCVR<T>>;
+}
+
+namespace Seq::_internal::Fused
+{
+    template<std::size_t BlockSize, typename Source, typename... Stages>
+    constexpr bool IS_PIPELINE<Batching::Pipeline<BlockSize, Source, Stages...>> = true;
+}
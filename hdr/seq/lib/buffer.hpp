@@ -0,0 +1,96 @@
+// ┏━━━━━━━━━━━━┓
+// ┃ buffer.hpp ┃
+// ┗━━━━━━━━━━━━┛
+// Operators that collect elements before handing them on either view them as a `std::span<const T>` or take them back
+// out by reference. `std::vector<bool>` does neither, it packs its elements into bits and hands out proxies instead.
+// `Buffer<T>` is therefore a `std::vector<T>` for every element type but `bool`, whose elements are kept in a plain
+// array behind the small part of the `std::vector` interface those operators use.
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal
+{
+    class BoolBuffer
+    {
+    private:
+        std::unique_ptr<bool[]> elements;
+        std::size_t count    = 0;
+        std::size_t capacity = 0;
+
+    public:
+        BoolBuffer() = default;
+
+        void reserve(std::size_t wanted)
+        {
+            if (wanted <= capacity)
+            {
+                return;
+            }
+
+            auto grown = std::make_unique_for_overwrite<bool[]>(wanted);
+            std::copy_n(elements.get(), count, grown.get());
+
+            elements = std::move(grown);
+            capacity = wanted;
+        }
+
+        void resize(std::size_t wanted)
+        {
+            reserve(wanted);
+
+            if (wanted > count)
+            {
+                std::fill(elements.get() + count, elements.get() + wanted, false);
+            }
+
+            count = wanted;
+        }
+
+        void push_back(bool value) // NOLINT(readability-identifier-naming): Mirrors `std::vector`
+        {
+            if (count == capacity)
+            {
+                reserve(std::max<std::size_t>(2 * capacity, 1));
+            }
+
+            elements[count++] = value;
+        }
+
+        template<typename Value>
+        bool& emplace_back(Value&& value) // NOLINT(readability-identifier-naming): Mirrors `std::vector`
+        {
+            push_back(static_cast<bool>(std::forward<Value>(value)));
+            return elements[count - 1];
+        }
+
+        void clear() { count = 0; }
+
+        std::size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        bool* data() { return elements.get(); }
+
+        const bool* data() const { return elements.get(); }
+
+        bool& operator[](std::size_t idx) { return elements[idx]; }
+
+        const bool& operator[](std::size_t idx) const { return elements[idx]; }
+
+        bool* begin() { return data(); }
+
+        bool* end() { return data() + count; }
+
+        const bool* begin() const { return data(); }
+
+        const bool* end() const { return data() + count; }
+    };
+
+    template<typename T>
+    using Buffer = std::conditional_t<std::is_same_v<T, bool>, BoolBuffer, std::vector<T>>;
+}
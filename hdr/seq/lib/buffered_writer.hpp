@@ -0,0 +1,466 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ buffered_writer.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━┛
+// `Seq::writeLines`, `Seq::writeBinary` and `Seq::toOstream` write a sequence out while it is being consumed instead of
+// collecting it into a container first. Elements are appended to a single buffer of a fixed size, which is written out
+// whenever it runs full, so the memory used does not depend on the length of the sequence. Text is appended as it is
+// and numbers are formatted by `std::to_chars` right into the buffer. Streams whose formatting state (flags, field
+// width, locale) would print numbers differently get every element through `operator<<` instead. Pieces larger than
+// the buffer are not copied at all. They are written together with whatever is buffered by a single `writev` call,
+// which is how whole contiguous blocks of records end up in a file. Platforms without `writev` fall back to two
+// `std::fwrite` calls.
+#pragma once
+#include "reduce_kernels.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <ios>
+#include <locale>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/uio.h>)
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #define SEQ_HAS_WRITEV 1
+#else
+    #include <cstdio>
+    #define SEQ_HAS_WRITEV 0
+#endif
+
+namespace Seq::_internal::Writing
+{
+    constexpr std::size_t BUFFER_SIZE = std::size_t{1} << 16;
+
+    // Room made in the buffer before a number is formatted into it.
+    constexpr std::size_t LONGEST_NUMBER = 64;
+
+    // Largest precision of floating-point numbers formatted by the buffer, so their text fits into `LONGEST_NUMBER`.
+    constexpr std::streamsize MAX_BUFFERED_PRECISION = 48;
+
+    // A file that is created or truncated when the operator starts consuming its sequence.
+    class FileTarget
+    {
+    private:
+        std::string operatorName;
+        std::string fileName;
+
+#if SEQ_HAS_WRITEV
+        int descriptor = -1;
+#else
+        std::FILE* file = nullptr;
+#endif
+
+        [[noreturn]] void fail(const char* action) const
+        {
+            const std::string message = operatorName + " could not " + action + " " + fileName;
+            throw std::system_error(errno, std::generic_category(), message);
+        }
+
+    public:
+        // Parameter operatorName is the public operator writing the file, used in error messages.
+        FileTarget(const std::filesystem::path& path, const char* operatorName)
+            : operatorName(operatorName)
+            , fileName(path.string())
+        {
+#if SEQ_HAS_WRITEV
+            descriptor = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if (descriptor < 0)
+            {
+                fail("create");
+            }
+#else
+            file = std::fopen(fileName.c_str(), "wb");
+
+            if (file == nullptr)
+            {
+                fail("create");
+            }
+#endif
+        }
+
+        FileTarget(const FileTarget&)            = delete;
+        FileTarget& operator=(const FileTarget&) = delete;
+
+        // Only reached without `close` if writing failed, which has been reported already.
+        ~FileTarget()
+        {
+#if SEQ_HAS_WRITEV
+            if (descriptor >= 0)
+            {
+                ::close(descriptor);
+            }
+#else
+            if (file != nullptr)
+            {
+                std::fclose(file);
+            }
+#endif
+        }
+
+        // Writes both pieces in this order, retrying until the system has taken all of them.
+        void write(std::string_view first, std::string_view second)
+        {
+#if SEQ_HAS_WRITEV
+            iovec parts[2] = {{const_cast<char*>(first.data()), first.size()},
+                              {const_cast<char*>(second.data()), second.size()}};
+            iovec* next    = parts;
+            int remaining  = 2;
+
+            while (remaining > 0)
+            {
+                const ssize_t written = ::writev(descriptor, next, remaining);
+
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    fail("write");
+                }
+
+                // Skips whatever has been written, the system is allowed to stop in the middle of a piece
+                auto left = static_cast<std::size_t>(written);
+
+                while (remaining > 0 && left >= next->iov_len)
+                {
+                    left -= next->iov_len;
+                    ++next;
+                    --remaining;
+                }
+
+                if (remaining > 0)
+                {
+                    next->iov_base = static_cast<char*>(next->iov_base) + left;
+                    next->iov_len -= left;
+                }
+            }
+#else
+            if (std::fwrite(first.data(), 1, first.size(), file) != first.size()
+                || std::fwrite(second.data(), 1, second.size(), file) != second.size())
+            {
+                fail("write");
+            }
+#endif
+        }
+
+        void close()
+        {
+#if SEQ_HAS_WRITEV
+            if (::close(std::exchange(descriptor, -1)) != 0)
+            {
+                fail("close");
+            }
+#else
+            if (std::fclose(std::exchange(file, nullptr)) != 0)
+            {
+                fail("close");
+            }
+#endif
+        }
+    };
+
+    // Streams keep their own state, a failed write sets their flags instead of throwing.
+    class StreamTarget
+    {
+    private:
+        std::ostream* stream;
+
+    public:
+        explicit StreamTarget(std::ostream& stream)
+            : stream(&stream)
+        {
+        }
+
+        void write(std::string_view first, std::string_view second)
+        {
+            stream->write(first.data(), static_cast<std::streamsize>(first.size()));
+            stream->write(second.data(), static_cast<std::streamsize>(second.size()));
+        }
+
+        void close()
+        {
+            stream->flush();
+        }
+
+        auto ostream() const -> std::ostream& { return *stream; }
+    };
+
+    template<typename Target>
+    class BufferedWriter
+    {
+    private:
+        Target target;
+        std::vector<char> buffer;
+        std::size_t used = 0;
+
+    public:
+        template<typename... Args>
+        explicit BufferedWriter(Args&&... args)
+            : target(std::forward<Args>(args)...)
+            , buffer(BUFFER_SIZE)
+        {
+        }
+
+        void append(std::string_view bytes)
+        {
+            if (bytes.size() <= buffer.size() - used)
+            {
+                std::memcpy(buffer.data() + used, bytes.data(), bytes.size());
+                used += bytes.size();
+            }
+            else if (bytes.size() >= buffer.size())
+            {
+                target.write(std::string_view(buffer.data(), std::exchange(used, 0)), bytes);
+            }
+            else
+            {
+                flush();
+                std::memcpy(buffer.data(), bytes.data(), bytes.size());
+                used = bytes.size();
+            }
+        }
+
+        void append(char byte)
+        {
+            if (used == buffer.size())
+            {
+                flush();
+            }
+
+            buffer[used++] = byte;
+        }
+
+        // Formats the number right into the buffer, after making room for the longest representation of it.
+        // Parameter format is passed on to `std::to_chars`, e.g. a `std::chars_format` and a precision.
+        template<typename Number, typename... Format>
+        void appendNumber(Number number, Format... format)
+        {
+            if (buffer.size() - used < LONGEST_NUMBER)
+            {
+                flush();
+            }
+
+            const auto [end, error] =
+                std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), number, format...);
+            used =  static_cast<std::size_t>(end - buffer.data());
+        }
+
+        void flush()
+        {
+            if (used > 0)
+            {
+                target.write(std::string_view(buffer.data(), std::exchange(used, 0)), {});
+            }
+        }
+
+        void close()
+        {
+            flush();
+            target.close();
+        }
+
+        auto underlying() -> Target& { return target; }
+    };
+
+    template<typename T>
+    concept EnsureIsText = std::convertible_to<const T&, std::string_view>;
+
+    template<typename T>
+    concept EnsureIsNumber = std::is_arithmetic_v<T> && !std::same_as<T, bool> && !std::same_as<T, char>;
+
+    template<typename T>
+    concept EnsureIsWritable = EnsureIsText<T> || EnsureIsNumber<T> || std::same_as<T, char>;
+
+    // Elements the buffer writes just like their `operator<<`, which prints the other character types as characters.
+    template<typename T>
+    concept EnsureIsStreamable =
+        EnsureIsWritable<T> && !std::same_as<T, signed char> && !std::same_as<T, unsigned char>;
+
+    template<typename Target, EnsureIsWritable T>
+    inline void appendText(BufferedWriter<Target>& writer, const T& elem)
+    {
+        if constexpr (EnsureIsText<T>)
+        {
+            writer.append(std::string_view(elem));
+        }
+        else if constexpr (std::same_as<T, char>)
+        {
+            writer.append(elem);
+        }
+        else
+        {
+            writer.appendNumber(elem);
+        }
+    }
+
+    template<typename Sequence>
+    inline auto lines(Sequence&& sequence, const std::filesystem::path& path) -> std::size_t
+    {
+        using T = TypeInspect::RemoveCVR<Fused::ItemOf<Sequence>>;
+        static_assert(EnsureIsWritable<T>, "Seq::writeLines needs text, characters or numbers");
+
+        BufferedWriter<FileTarget> writer(path, "Seq::writeLines");
+        std::size_t count = 0;
+
+        Fused::forEach(std::forward<Sequence>(sequence),
+                       [&writer, &count](const auto& elem) -> bool
+                       {
+                           appendText(writer, elem);
+                           writer.append('\n');
+                           ++count;
+                           return true;
+                       });
+
+        writer.close();
+        return count;
+    }
+
+    template<typename T, std::size_t Extent>
+    inline void appendBytes(BufferedWriter<FileTarget>& writer, std::span<const T, Extent> records)
+    {
+        const std::span<const std::byte> bytes = std::as_bytes(records);
+        writer.append(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    }
+
+    // Contiguous containers and blockwise sources are appended a block at a time, whole containers in a single call.
+    // Records of any other sequence are appended one by one as they come, without staging them anywhere else first.
+    template<typename T, typename Sequence>
+    inline void appendRecords(BufferedWriter<FileTarget>& writer, Sequence&& sequence, std::size_t& count)
+    {
+        if constexpr (requires { sequence.view(); })
+        {
+            appendRecords<T>(writer, sequence.view(), count);
+        }
+        else if constexpr (Fused::EnsureIsBlockwise<Sequence> || Kernels::EnsureIsContiguous<Sequence>)
+        {
+            Kernels::forEachBlock<T>(std::forward<Sequence>(sequence),
+                                     [&writer, &count](std::span<const T> block)
+                                     {
+                                         appendBytes(writer, block);
+                                         count += block.size();
+                                     });
+        }
+        else
+        {
+            Fused::forEach(std::forward<Sequence>(sequence),
+                           [&writer, &count](const T& record) -> bool
+                           {
+                               appendBytes(writer, std::span<const T, 1>(&record, 1));
+                               ++count;
+                               return true;
+                           });
+        }
+    }
+
+    template<typename Sequence>
+    inline auto binary(Sequence&& sequence, const std::filesystem::path& path) -> std::size_t
+    {
+        using T = TypeInspect::RemoveCVR<Fused::ItemOf<Sequence>>;
+        static_assert(std::is_trivially_copyable_v<T>, "Seq::writeBinary only supports trivially copyable records");
+
+        BufferedWriter<FileTarget> writer(path, "Seq::writeBinary");
+        std::size_t count = 0;
+
+        appendRecords<T>(writer, std::forward<Sequence>(sequence), count);
+
+        writer.close();
+        return count;
+    }
+
+    // Whether `operator<<` prints numbers just like `std::to_chars` with the current state of the stream, which takes
+    // the default flags, no field width and the classic locale.
+    inline auto isPlain(const std::ostream& stream) -> bool
+    {
+        return stream.flags() == (std::ios_base::skipws | std::ios_base::dec)
+               && stream.width() == 0
+               && stream.precision() <= MAX_BUFFERED_PRECISION
+               && stream.getloc() == std::locale::classic();
+    }
+
+    template<typename T>
+    inline void insert(std::ostream& stream, const T& elem)
+    {
+        if constexpr (EnsureIsText<T>)
+        {
+            stream << std::string_view(elem);
+        }
+        else
+        {
+            stream << elem;
+        }
+    }
+
+    // Elements the buffer cannot format itself are handed to their own `operator<<` once the buffer is flushed. The
+    // state of the stream is looked at once, a plain stream formats floating-point numbers with its precision.
+    template<typename Sequence>
+    inline auto ostream(Sequence&& sequence, std::ostream& stream, std::string_view separator) -> std::size_t
+    {
+        BufferedWriter<StreamTarget> writer(stream);
+        std::size_t count   = 0;
+        const bool plain    = isPlain(stream);
+        const int precision = static_cast<int>(stream.precision());
+
+        Fused::forEach(std::forward<Sequence>(sequence),
+                       [&writer, &count, separator, plain, precision]<typename Elem>(const Elem& elem) -> bool
+                       {
+                           if (count > 0 && !separator.empty())
+                           {
+                               writer.append(separator);
+                           }
+
+                           if constexpr (std::is_floating_point_v<Elem>)
+                           {
+                               if (plain)
+                               {
+                                   writer.appendNumber(elem, std::chars_format::general, precision);
+                               }
+                               else
+                               {
+                                   writer.flush();
+                                   insert(writer.underlying().ostream(), elem);
+                               }
+                           }
+                           else if constexpr (EnsureIsStreamable<Elem>)
+                           {
+                               if (plain)
+                               {
+                                   appendText(writer, elem);
+                               }
+                               else
+                               {
+                                   writer.flush();
+                                   insert(writer.underlying().ostream(), elem);
+                               }
+                           }
+                           else
+                           {
+                               writer.flush();
+                               insert(writer.underlying().ostream(), elem);
+                           }
+
+                           ++count;
+                           return true;
+                       });
+
+        writer.close();
+        return count;
+    }
+}
+
+#undef SEQ_HAS_WRITEV
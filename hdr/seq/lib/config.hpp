@@ -7,3 +7,11 @@
         #error "You need at least C++20 standard to use this library"
     #endif
 #endif
+
+// ┏━━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ Configuration macros ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━━┛
+// Define any of these before including the library to change its behavior.
+// - `SEQ_DISABLE_FRAME_POOL` allocates coroutine frames on the global heap instead of recycling them per thread.
+// - `SEQ_COUNT_RESUMES` counts how many times each thread resumes an `IEnumerable<T>` coroutine, which the benchmarks
+//   report per element.
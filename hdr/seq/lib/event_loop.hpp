@@ -0,0 +1,143 @@
+// ┏━━━━━━━━━━━━━━━━┓
+// ┃ event_loop.hpp ┃
+// ┗━━━━━━━━━━━━━━━━┛
+// `Seq::EventLoop` runs coroutines on a single thread, one at a time, each until it suspends. Coroutines suspend on
+// awaitables of the loop: `yield` puts them at the back of the queue of ready coroutines, `sleep` parks them until
+// their deadline has come. The loop keeps a simulated clock instead of reading a real one. Whenever no coroutine is
+// ready, the clock jumps ahead to the earliest deadline, so waiting never takes any real time. That makes it a loop
+// for tests and examples, which shows how pipelines waiting on I/O interleave on one thread. Real applications await
+// the awaitables of their own I/O library in the same places instead.
+#pragma once
+#include "async_enumerable.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+namespace Seq
+{
+    class EventLoop
+    {
+    public:
+        using Duration = std::chrono::nanoseconds;
+
+    private:
+        struct Timer
+        {
+            Duration deadline;
+            std::uint64_t order;
+            std::coroutine_handle<> handle;
+
+            // Timers with the same deadline fire in the order they were set.
+            bool operator>(const Timer& other) const
+            {
+                return deadline != other.deadline ? deadline > other.deadline : order > other.order;
+            }
+        };
+
+        std::deque<std::coroutine_handle<>> ready;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+        Duration elapsed{0};
+        std::uint64_t timersSet = 0;
+
+        class Sleep
+        {
+        private:
+            EventLoop* loop;
+            Duration duration;
+
+        public:
+            Sleep(EventLoop* loop, Duration duration)
+                : loop(loop)
+                , duration(duration)
+            {
+            }
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                loop->timers.push({loop->elapsed + duration, loop->timersSet++, handle});
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        class Yield
+        {
+        private:
+            EventLoop* loop;
+
+        public:
+            explicit Yield(EventLoop* loop)
+                : loop(loop)
+            {
+            }
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) const { loop->ready.push_back(handle); }
+
+            void await_resume() const noexcept {}
+        };
+
+    public:
+        // Lets every other ready coroutine run before the awaiting one continues.
+        auto yield() -> Yield { return Yield(this); }
+
+        // Suspends the awaiting coroutine until the clock of the loop has advanced by the given duration.
+        auto sleep(Duration duration) -> Sleep { return Sleep(this, duration); }
+
+        // Simulated time since the loop was created.
+        auto now() const -> Duration { return elapsed; }
+
+        // Starts the task once the loop runs. The task stays with the caller, who reads its result when it is done.
+        template<typename T>
+        void spawn(Task<T>& task)
+        {
+            ready.push_back(task.handle);
+        }
+
+        // Runs ready coroutines and expired timers until neither are left.
+        void run()
+        {
+            while (!ready.empty() || !timers.empty())
+            {
+                if (ready.empty())
+                {
+                    elapsed = timers.top().deadline;
+
+                    while (!timers.empty() && timers.top().deadline == elapsed)
+                    {
+                        ready.push_back(timers.top().handle);
+                        timers.pop();
+                    }
+                }
+
+                const std::coroutine_handle<> next = ready.front();
+                ready.pop_front();
+                next.resume();
+            }
+        }
+
+        // Runs the task and everything it starts on the loop, then returns its result.
+        template<typename T>
+        auto run(Task<T> task) -> T
+        {
+            spawn(task);
+            run();
+
+            if (!task.isDone())
+            {
+                throw std::logic_error("Seq::EventLoop ran out of work before the task was done");
+            }
+
+            return task.result();
+        }
+    };
+}
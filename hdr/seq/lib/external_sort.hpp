@@ -0,0 +1,401 @@
+// ┏━━━━━━━━━━━━━━━━━━━┓
+// ┃ external_sort.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━┛
+// `Seq::externalSort` and its variants sort sequences that do not fit into memory. Elements are collected into runs
+// that stay within the memory budget. Every full run is sorted and spilled into a temporary file, after which its
+// memory is reused for the next one. Once the sequence is exhausted, the runs are streamed back and merged through a
+// heap that holds the front element of every run. No more than `MAX_MERGE_FAN_IN` runs are open at once, more of them
+// are first merged group by group into longer runs, pass after pass. Sequences that fit into a single run never touch
+// the disk and are sorted in memory like `Seq::sort` does. Temporary files are removed as soon as the sorted sequence
+// is destroyed.
+#pragma once
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "sort_backends.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Spill
+{
+    // Stands for the default serializer, which copies the bytes of trivially copyable elements.
+    struct RawBytes
+    {
+    };
+
+    template<typename T>
+    struct RawBytesOf
+    {
+        void write(std::ostream& out, const T& elem) const
+        {
+            const auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(elem);
+            out.write(bytes.data(), bytes.size());
+        }
+
+        auto read(std::istream& in) const -> std::optional<T>
+        {
+            std::array<char, sizeof(T)> bytes;
+
+            if (!in.read(bytes.data(), bytes.size()))
+            {
+                return std::nullopt;
+            }
+
+            return std::bit_cast<T>(bytes);
+        }
+    };
+
+    // Serializers write one element at a time and read them back in the same order, nothing signals the end of input.
+    template<typename Serializer, typename T>
+    concept EnsureIsSerializerOf = requires(const Serializer& serializer, std::ostream& out, std::istream& in) {
+        serializer.write(out, std::declval<const T&>());
+        { serializer.read(in) } -> std::same_as<std::optional<T>>;
+    };
+
+    template<typename T, typename Serializer>
+    inline auto serializerFor(Serializer serializer)
+    {
+        if constexpr (std::is_same_v<Serializer, RawBytes>)
+        {
+            static_assert(std::is_trivially_copyable_v<T>,
+                          "Seq::externalSort needs a serializer for elements that are not trivially copyable");
+
+            return RawBytesOf<T>{};
+        }
+        else
+        {
+            static_assert(EnsureIsSerializerOf<Serializer, T>,
+                          "Serializer needs `write(std::ostream&, const T&)` and `read(std::istream&) -> optional<T>`");
+
+            return serializer;
+        }
+    }
+
+    // A temporary file holding one sorted run. It is removed again when the run is destroyed.
+    class RunFile
+    {
+    private:
+        std::filesystem::path path;
+
+        static auto uniquePath() -> std::filesystem::path
+        {
+            static const std::uint32_t session = std::random_device{}();
+            static std::atomic<std::uint64_t> counter{0};
+
+            const std::string name =
+                "seq-spill-" + std::to_string(session) + "-" + std::to_string(counter.fetch_add(1)) + ".run";
+
+            return std::filesystem::temp_directory_path() / name;
+        }
+
+    public:
+        RunFile()
+            : path(uniquePath())
+        {
+        }
+
+        RunFile(RunFile&& other) noexcept
+            : path(std::exchange(other.path, {}))
+        {
+        }
+
+        ~RunFile()
+        {
+            if (!path.empty())
+            {
+                std::error_code ignored;
+                std::filesystem::remove(path, ignored);
+            }
+        }
+
+        RunFile(const RunFile&)                = delete;
+        RunFile& operator=(const RunFile&)     = delete;
+        RunFile& operator=(RunFile&&) noexcept = delete;
+
+        auto writer() const -> std::ofstream
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+            if (!out)
+            {
+                throw std::runtime_error("Seq::externalSort could not create " + path.string());
+            }
+
+            return out;
+        }
+
+        auto reader() const -> std::ifstream
+        {
+            std::ifstream in(path, std::ios::binary);
+
+            if (!in)
+            {
+                throw std::runtime_error("Seq::externalSort could not open " + path.string());
+            }
+
+            return in;
+        }
+    };
+
+    // Buffered elements are stored together with their key, so it is not computed again for every comparison.
+    // Sorting by the elements themselves (`std::identity`) stores them on their own.
+    template<typename T, typename Mapping>
+    struct Layout
+    {
+        static constexpr bool IS_IDENTITY = std::is_same_v<Mapping, std::identity>;
+
+        using Key    = std::remove_cvref_t<std::invoke_result_t<Mapping&, const T&>>;
+        using Stored = std::conditional_t<IS_IDENTITY, T, std::pair<T, Key>>;
+
+        static auto store(Mapping& mapping, T elem) -> Stored
+        {
+            if constexpr (IS_IDENTITY)
+            {
+                return elem;
+            }
+            else
+            {
+                Key key = mapping(elem);
+                return Stored(std::move(elem), std::move(key));
+            }
+        }
+
+        static auto keyOf(const Stored& stored) -> const Key&
+        {
+            if constexpr (IS_IDENTITY)
+            {
+                return stored;
+            }
+            else
+            {
+                return std::get<1>(stored);
+            }
+        }
+
+        static auto elemOf(const Stored& stored) -> const T&
+        {
+            if constexpr (IS_IDENTITY)
+            {
+                return stored;
+            }
+            else
+            {
+                return std::get<0>(stored);
+            }
+        }
+    };
+
+    // Smallest capacity a run grows by, so short sequences do not reserve the whole budget up front.
+    constexpr std::size_t MIN_RUN_GROWTH = 1024;
+
+    // Elements a run holds even if the budget is smaller, otherwise tiny budgets would spill every element on its own.
+    constexpr std::size_t MIN_RUN_LENGTH = 64;
+
+    // Runs merged at once, which bounds the number of files open at the same time.
+    constexpr std::size_t MAX_MERGE_FAN_IN = 64;
+
+    // k-way merge of sorted runs, the heap holds the indices of the runs ordered by their front element. Equal elements
+    // are taken from the earlier run first.
+    template<bool Descending, typename T, typename Mapping, typename Serializer>
+    class Merge
+    {
+    private:
+        using Layout = Spill::Layout<T, Mapping>;
+        using Stored = typename Layout::Stored;
+
+        // Comparators refer to the key function, so it has to outlive them.
+        static constexpr auto KEY_OF = &Layout::keyOf;
+
+        Mapping* mapping;
+        const Serializer* serializer;
+        std::vector<std::ifstream> readers;
+        std::vector<std::optional<Stored>> fronts;
+        std::vector<std::size_t> heap;
+
+        auto isMergedLater(std::size_t lhs, std::size_t rhs) const -> bool
+        {
+            const auto comp = Sorting::comparatorOf<Descending, Stored>(KEY_OF);
+            return comp(*fronts[rhs], *fronts[lhs]) || (!comp(*fronts[lhs], *fronts[rhs]) && rhs < lhs);
+        }
+
+        auto heapOrder() const
+        {
+            return [this](std::size_t lhs, std::size_t rhs) -> bool { return isMergedLater(lhs, rhs); };
+        }
+
+        auto advance(std::size_t runIdx) -> bool
+        {
+            std::optional<T> next = serializer->read(readers[runIdx]);
+
+            if (!next.has_value())
+            {
+                if (readers[runIdx].bad())
+                {
+                    throw std::runtime_error("Seq::externalSort could not read a sorted run");
+                }
+
+                return false;
+            }
+
+            fronts[runIdx] = Layout::store(*mapping, std::move(*next));
+            return true;
+        }
+
+    public:
+        Merge(std::span<const RunFile> files, Mapping& mapping, const Serializer& serializer)
+            : mapping(&mapping)
+            , serializer(&serializer)
+            , fronts(files.size())
+        {
+            for (std::size_t runIdx = 0; runIdx < files.size(); ++runIdx)
+            {
+                readers.push_back(files[runIdx].reader());
+
+                if (advance(runIdx))
+                {
+                    heap.push_back(runIdx);
+                }
+            }
+
+            std::make_heap(heap.begin(), heap.end(), heapOrder());
+        }
+
+        bool empty() const { return heap.empty(); }
+
+        auto front() const -> const T& { return Layout::elemOf(*fronts[heap.front()]); }
+
+        void pop()
+        {
+            std::pop_heap(heap.begin(), heap.end(), heapOrder());
+
+            if (advance(heap.back()))
+            {
+                std::push_heap(heap.begin(), heap.end(), heapOrder());
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+    };
+
+    // Parameter mapping has signature `(T) -> Key` and selects what the elements are compared by.
+    template<bool Descending, typename T, typename Mapping, typename Serializer>
+    auto externalSortElementsBy(IEnumerable<T> sequence, std::size_t memoryBudget, Mapping mapping,
+                                Serializer serializer) -> IEnumerable<T>
+    {
+        using Layout = Spill::Layout<T, Mapping>;
+        using Stored = typename Layout::Stored;
+        using Merge  = Spill::Merge<Descending, T, Mapping, Serializer>;
+
+        const auto keyOf          = &Layout::keyOf;
+        const std::size_t runSize = std::max(memoryBudget / sizeof(Stored), MIN_RUN_LENGTH);
+
+        std::vector<Stored> run;
+        std::vector<RunFile> files;
+
+        const auto spill = [&run, &files, &serializer, keyOf]
+        {
+            Sorting::sortBuffer<SortBackend::AUTO, Descending>(std::span(run), keyOf);
+
+            std::ofstream out = files.emplace_back().writer();
+
+            for (const Stored& stored : run)
+            {
+                serializer.write(out, Layout::elemOf(stored));
+            }
+
+            if (!out.flush())
+            {
+                throw std::runtime_error("Seq::externalSort could not write a sorted run");
+            }
+
+            run.clear();
+        };
+
+        for (const T& elem : sequence)
+        {
+            if (run.size() == runSize)
+            {
+                spill();
+            }
+
+            // Capacity grows geometrically like usual, but never beyond the budget
+            if (run.size() == run.capacity())
+            {
+                run.reserve(std::min(runSize, std::max(run.capacity() * 2, MIN_RUN_GROWTH)));
+            }
+
+            run.push_back(Layout::store(mapping, elem));
+        }
+
+        if (files.empty())
+        {
+            using KeyOf = decltype(&Layout::keyOf);
+            Sorting::IncrementalSort<SortBackend::AUTO, Descending, Stored, KeyOf> sorter(run, keyOf);
+
+            for (std::size_t idx = 0; idx < run.size(); ++idx)
+            {
+                co_yield Layout::elemOf(sorter.at(idx));
+            }
+
+            co_return;
+        }
+
+        if (!run.empty())
+        {
+            spill();
+        }
+
+        run = std::vector<Stored>();
+
+        // Groups of runs are merged into longer ones until a single merge can stream the rest
+        while (files.size() > MAX_MERGE_FAN_IN)
+        {
+            std::vector<RunFile> merged;
+
+            for (std::size_t first = 0; first < files.size(); first += MAX_MERGE_FAN_IN)
+            {
+                const std::size_t count = std::min(MAX_MERGE_FAN_IN, files.size() - first);
+                Merge merge(std::span<const RunFile>(files).subspan(first, count), mapping, serializer);
+                std::ofstream out = merged.emplace_back().writer();
+
+                for (; !merge.empty(); merge.pop())
+                {
+                    serializer.write(out, merge.front());
+                }
+
+                if (!out.flush())
+                {
+                    throw std::runtime_error("Seq::externalSort could not write a sorted run");
+                }
+            }
+
+            files = std::move(merged);
+        }
+
+        for (Merge merge(files, mapping, serializer); !merge.empty(); merge.pop())
+        {
+            co_yield merge.front();
+        }
+    }
+}
@@ -0,0 +1,204 @@
+// ┏━━━━━━━━━━━━━━━┓
+// ┃ flat_hash.hpp ┃
+// ┗━━━━━━━━━━━━━━━┛
+// An open-addressing hash index behind the grouping operators (`Seq::distinct`, `Seq::groupBy`...). It maps every
+// distinct key to a dense index in order of first appearance, so per-key state lives in plain vectors next to it
+// instead of in nodes scattered over the heap. Keys and their hashes are stored densely as well. The table itself
+// only holds a small slot per key with a fragment of the hash and the dense index, which keeps probing within a few
+// cache lines. Slots are probed linearly and the table doubles once it is 7/8 full. Hashes are scrambled before use,
+// so plain hash functions like `std::hash` of integers (usually the identity) still spread well over the table.
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::FlatHash
+{
+    // Default hash of the grouping operators.
+    struct StdHash
+    {
+        template<typename Key>
+        requires requires(const Key& key) { std::hash<Key>{}(key); }
+        auto operator()(const Key& key) const -> std::size_t
+        {
+            return std::hash<Key>{}(key);
+        }
+    };
+
+    // Smallest table, enough for a handful of keys without growing.
+    constexpr std::size_t MIN_CAPACITY = 16;
+
+    // Tables are never pre-sized for more keys than this. Sequences usually hold far fewer distinct keys than
+    // elements, so a table sized after a huge length hint would mostly stay empty. Larger ones still grow as needed.
+    constexpr std::size_t MAX_PRESIZE = std::size_t{1} << 14;
+
+    // Fibonacci hashing, the multiplication moves the entropy of every bit into the high bits used for the position.
+    constexpr std::uint64_t SCRAMBLE = 0x9E3779B97F4A7C15ULL;
+
+    inline auto scramble(std::size_t hash) -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(hash) * SCRAMBLE;
+    }
+
+    template<typename Key, typename Hash = StdHash>
+    class FlatIndex
+    {
+    private:
+        // `entry` is the dense index plus one, zero marks an empty slot
+        struct Slot
+        {
+            std::uint32_t tag;
+            std::uint32_t entry;
+        };
+
+        static constexpr std::size_t MAX_ENTRIES = std::numeric_limits<std::uint32_t>::max() - 1;
+
+        std::vector<Slot> slots;
+        std::vector<Key> keys;
+        std::vector<std::uint64_t> hashes;
+        int shift = 0;
+        Hash hash;
+
+        static auto tagOf(std::uint64_t scrambled) -> std::uint32_t { return static_cast<std::uint32_t>(scrambled); }
+
+        auto positionOf(std::uint64_t scrambled) const -> std::size_t
+        {
+            return static_cast<std::size_t>(scrambled >> shift);
+        }
+
+        void rehash(std::size_t capacity)
+        {
+            slots.assign(capacity, Slot{0, 0});
+            shift = 64 - std::countr_zero(capacity);
+
+            const std::size_t mask = capacity - 1;
+
+            for (std::size_t idx = 0; idx < keys.size(); ++idx)
+            {
+                std::size_t position = positionOf(hashes[idx]);
+
+                while (slots[position].entry != 0)
+                {
+                    position = (position + 1) & mask;
+                }
+
+                slots[position] = Slot{tagOf(hashes[idx]), static_cast<std::uint32_t>(idx + 1)};
+            }
+        }
+
+    public:
+        explicit FlatIndex(Hash hash = {})
+            : hash(std::move(hash))
+        {
+            rehash(MIN_CAPACITY);
+        }
+
+        // Makes room for this many distinct keys without growing, up to `MAX_PRESIZE`.
+        void reserve(std::size_t expectedKeys)
+        {
+            const std::size_t wanted   = std::min(expectedKeys, MAX_PRESIZE);
+            const std::size_t capacity = std::bit_ceil(std::max(MIN_CAPACITY, wanted + wanted / 7 + 1));
+
+            if (capacity > slots.size())
+            {
+                keys.reserve(wanted);
+                hashes.reserve(wanted);
+                rehash(capacity);
+            }
+        }
+
+        // Returns the dense index of the key and whether the key was seen for the first time.
+        template<typename K>
+        auto insert(K&& key) -> std::pair<std::size_t, bool>
+        {
+            return insert(std::forward<K>(key), scramble(hash(std::as_const(key))));
+        }
+
+        // Same as above for a key whose hash was already scrambled by `FlatHash::scramble`.
+        template<typename K>
+        auto insert(K&& key, std::uint64_t scrambled) -> std::pair<std::size_t, bool>
+        {
+            const std::uint32_t tag = tagOf(scrambled);
+            const std::size_t mask  = slots.size() - 1;
+
+            std::size_t position = positionOf(scrambled);
+
+            while (slots[position].entry != 0)
+            {
+                const std::size_t idx = slots[position].entry - 1;
+
+                if (slots[position].tag == tag && keys[idx] == key)
+                {
+                    return {idx, false};
+                }
+
+                position = (position + 1) & mask;
+            }
+
+            if (keys.size() == MAX_ENTRIES)
+            {
+                throw std::length_error("Seq::_internal::FlatHash::FlatIndex cannot hold any more keys");
+            }
+
+            const std::size_t idx = keys.size();
+            keys.emplace_back(std::forward<K>(key));
+            hashes.push_back(scrambled);
+            slots[position] = Slot{tag, static_cast<std::uint32_t>(idx + 1)};
+
+            // Stays at most 7/8 full, so probe sequences remain short
+            if (keys.size() * 8 > slots.size() * 7)
+            {
+                rehash(slots.size() * 2);
+            }
+
+            return {idx, true};
+        }
+
+        // Dense index of a key with an already scrambled hash, if the key is known at all.
+        template<typename K>
+        auto find(const K& key, std::uint64_t scrambled) const -> std::optional<std::size_t>
+        {
+            const std::uint32_t tag = tagOf(scrambled);
+            const std::size_t mask  = slots.size() - 1;
+
+            std::size_t position = positionOf(scrambled);
+
+            while (slots[position].entry != 0)
+            {
+                const std::size_t idx = slots[position].entry - 1;
+
+                if (slots[position].tag == tag && keys[idx] == key)
+                {
+                    return idx;
+                }
+
+                position = (position + 1) & mask;
+            }
+
+            return std::nullopt;
+        }
+
+        std::size_t size() const { return keys.size(); }
+
+        // Scrambled hashes of the keys in order of their dense index.
+        auto scrambledHashes() const -> std::span<const std::uint64_t> { return hashes; }
+
+        // Keys in order of their dense index. Leaves the index empty.
+        auto releaseKeys() -> std::vector<Key>
+        {
+            std::vector<Key> released = std::move(keys);
+            keys.clear();
+            hashes.clear();
+            rehash(MIN_CAPACITY);
+            return released;
+        }
+    };
+}
@@ -0,0 +1,140 @@
+// ┏━━━━━━━━━━━━━━━━┓
+// ┃ frame_pool.hpp ┃
+// ┗━━━━━━━━━━━━━━━━┛
+// Every `IEnumerable<T>` coroutine needs a frame and every stage of a pipeline is its own coroutine, so a short query
+// built on a hot path would otherwise cost one malloc/free pair per stage. Frames are instead recycled through
+// thread-local free-lists bucketed by size class. Blocks are still obtained one by one from the global heap, which
+// means a frame created on one thread can safely be released on another one, it simply migrates to that thread's cache.
+// Define `SEQ_DISABLE_FRAME_POOL` before including the library to fall back to the global heap.
+#pragma once
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace Seq::_internal::FramePool
+{
+    // Frame sizes are rounded up to a multiple of this value, each multiple having its own free-list.
+    constexpr std::size_t GRANULARITY = 64;
+
+    // Frames larger than this bypass the pool and go straight to the global heap.
+    constexpr std::size_t MAX_POOLED_SIZE = 2048;
+
+    // Upper bound of idle blocks a thread keeps around per size class.
+    constexpr std::size_t MAX_CACHED_PER_CLASS = 64;
+
+    constexpr std::size_t SIZE_CLASS_COUNT = MAX_POOLED_SIZE / GRANULARITY;
+
+    inline auto sizeClassOf(std::size_t size) -> std::size_t { return (size + GRANULARITY - 1) / GRANULARITY - 1; }
+
+    inline auto bytesOf(std::size_t sizeClass) -> std::size_t { return (sizeClass + 1) * GRANULARITY; }
+
+    // Set once the free-lists of the current thread are destroyed. Frames outliving them, such as those of sequences
+    // with static storage duration or held by other thread-locals, go straight to the global heap from then on.
+    inline thread_local bool freeListsDestroyed = false;
+
+    class FreeLists
+    {
+    private:
+        struct Node
+        {
+            Node* next;
+        };
+
+        std::array<Node*, SIZE_CLASS_COUNT> heads{};
+        std::array<std::size_t, SIZE_CLASS_COUNT> lengths{};
+
+    public:
+        auto pop(std::size_t sizeClass) noexcept -> void*
+        {
+            Node* head = heads[sizeClass];
+
+            if (head != nullptr)
+            {
+                heads[sizeClass] = head->next;
+                --lengths[sizeClass];
+            }
+
+            return head;
+        }
+
+        auto push(std::size_t sizeClass, void* block) noexcept -> bool
+        {
+            if (lengths[sizeClass] == MAX_CACHED_PER_CLASS)
+            {
+                return false;
+            }
+
+            heads[sizeClass] = ::new (block) Node{heads[sizeClass]};
+            ++lengths[sizeClass];
+
+            return true;
+        }
+
+        FreeLists() = default;
+
+        ~FreeLists()
+        {
+            freeListsDestroyed = true;
+
+            for (std::size_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass)
+            {
+                while (void* block = pop(sizeClass))
+                {
+                    ::operator delete(block, bytesOf(sizeClass));
+                }
+            }
+        }
+
+        FreeLists(const FreeLists&)                = delete;
+        FreeLists(FreeLists&&)                     = delete;
+        FreeLists& operator=(const FreeLists&)     = delete;
+        FreeLists& operator=(FreeLists&&) noexcept = delete;
+    };
+
+    // Returns nothing once the free-lists of the current thread have been destroyed.
+    inline auto threadFreeLists() -> FreeLists*
+    {
+        if (freeListsDestroyed)
+        {
+            return nullptr;
+        }
+
+        thread_local FreeLists freeLists;
+        return &freeLists;
+    }
+
+    inline auto allocate(std::size_t size) -> void*
+    {
+        if (size > MAX_POOLED_SIZE)
+        {
+            return ::operator new(size);
+        }
+
+        const std::size_t sizeClass = sizeClassOf(size);
+        FreeLists* freeLists        = threadFreeLists();
+
+        if (void* block = freeLists != nullptr ? freeLists->pop(sizeClass) : nullptr)
+        {
+            return block;
+        }
+
+        return ::operator new(bytesOf(sizeClass));
+    }
+
+    inline void deallocate(void* block, std::size_t size) noexcept
+    {
+        if (size > MAX_POOLED_SIZE)
+        {
+            ::operator delete(block, size);
+            return;
+        }
+
+        const std::size_t sizeClass = sizeClassOf(size);
+        FreeLists* freeLists        = threadFreeLists();
+
+        if (freeLists == nullptr || !freeLists->push(sizeClass, block))
+        {
+            ::operator delete(block, bytesOf(sizeClass));
+        }
+    }
+}
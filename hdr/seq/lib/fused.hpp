@@ -0,0 +1,659 @@
+// ┏━━━━━━━━━━━┓
+// ┃ fused.hpp ┃
+// ┗━━━━━━━━━━━┛
+// Stages like `Seq::map` or `Seq::filter` produce at most one element for each element they receive. Instead of giving
+// each of them a coroutine that has to be resumed once per element, they are collected into a `Pipeline` at compile
+// time. When a fold like `Seq::sum` finally consumes the pipeline, every stage turns into a sink (a callable returning
+// false once it does not want more elements) nested into the next one, so the compiler sees a single loop over the
+// source that it can inline and vectorize. A pipeline only becomes an `IEnumerable<T>` when a caller needs a
+// type-erased sequence, e.g. when assigning it to such a variable or piping it into an operator that is not fused.
+#pragma once
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Seq::_internal::Fused
+{
+    // Fused stages derive from this tag to be recognized by `operator|`.
+    class StageTag
+    {
+    };
+
+    // Fused terminal operators derive from this tag to be recognized by `operator|`.
+    class FoldTag
+    {
+    };
+
+    // Pipelines that hand their results out in contiguous blocks derive from this tag, see `Batching::Pipeline`.
+    class BlockwiseTag
+    {
+    };
+
+    // Operators that take a borrowed contiguous container as it is, instead of as an `IEnumerable<T>`, derive from this
+    // tag. They are called with the view whenever they accept it.
+    class ViewOperatorTag
+    {
+    };
+
+    template<typename T>
+    concept EnsureIsStage = std::derived_from<TypeInspect::RemoveCVR<T>, StageTag>;
+
+    template<typename T>
+    concept EnsureIsFold = std::derived_from<TypeInspect::RemoveCVR<T>, FoldTag>;
+
+    template<typename T>
+    concept EnsureIsBlockwise = std::derived_from<TypeInspect::RemoveCVR<T>, BlockwiseTag>;
+
+    template<typename T>
+    concept EnsureIsViewOperator = std::derived_from<TypeInspect::RemoveCVR<T>, ViewOperatorTag>;
+
+    // ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+    // ┃ Pushing elements out of a source ┃
+    // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+    template<typename T>
+    constexpr bool IS_IENUMERABLE = false;
+
+    template<typename T>
+    constexpr bool IS_IENUMERABLE<IEnumerable<T>> = true;
+
+    // Elements of a move-only type can only leave an `IEnumerable<T>` by being released.
+    template<typename Range, typename Sink>
+    inline void pushFrom(const Range& range, Sink& sink)
+    {
+        using T = TypeInspect::ItemOf<Range>;
+
+        if constexpr (IS_IENUMERABLE<Range> && !std::is_copy_constructible_v<T>)
+        {
+            for (auto it = range.begin(); it != range.end(); ++it)
+            {
+                if (!sink(it.release()))
+                {
+                    return;
+                }
+            }
+        }
+        else
+        {
+            for (const auto& elem : range)
+            {
+                if (!sink(elem))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    template<typename T, typename... Stages>
+    struct OutputOf
+    {
+        using Type = T;
+    };
+
+    template<typename T, typename Stage, typename... Rest>
+    struct OutputOf<T, Stage, Rest...>
+    {
+        using Type = typename OutputOf<typename Stage::template Output<T>, Rest...>::Type;
+    };
+
+    // Nests the stages into each other starting from the given one, so the returned sink feeds the first of them.
+    template<std::size_t Index = 0, typename... Stages, typename Sink>
+    inline auto chain(std::tuple<Stages...>& stages, Sink sink)
+    {
+        if constexpr (Index == sizeof...(Stages))
+        {
+            return sink;
+        }
+        else
+        {
+            return std::get<Index>(stages).wrap(chain<Index + 1>(stages, std::move(sink)));
+        }
+    }
+
+    // ┏━━━━━━━━━━┓
+    // ┃ Pipeline ┃
+    // ┗━━━━━━━━━━┛
+    // `Source` is either an `IEnumerable<T>` or a borrowed view of a container.
+    template<typename Source, typename... Stages>
+    class Pipeline
+    {
+    public:
+        using Item = typename OutputOf<TypeInspect::ItemOf<Source>, Stages...>::Type;
+
+    private:
+        Source source;
+        std::tuple<Stages...> stages;
+        std::optional<IEnumerable<Item>> pulled;
+
+        // Produces the elements of the pipeline one at a time. Every stage yields at most one element per source
+        // element, so the last sink only has to remember a single element between two resumes.
+        static auto pull(Source source, std::tuple<Stages...> stages) -> IEnumerable<Item>
+        {
+            Pipeline pipeline(std::move(source), std::move(stages));
+
+            const Item* borrowed = nullptr;
+            std::optional<Item> owned;
+
+            const auto remember = [&borrowed, &owned]<typename Elem>(Elem&& elem) -> bool
+            {
+                using Bare                   = TypeInspect::RemoveCVR<Elem>;
+                constexpr bool IS_BORROWABLE = std::is_lvalue_reference_v<Elem> && TypeInspect::IS<Bare, Item>;
+
+                if constexpr (IS_BORROWABLE)
+                {
+                    borrowed = &elem;
+                }
+                else
+                {
+                    owned.emplace(std::forward<Elem>(elem));
+                }
+
+                return true;
+            };
+
+            if (pipeline.isCutOff())
+            {
+                co_return;
+            }
+
+            auto sink = chain(pipeline.stages, remember);
+
+            for (auto it = pipeline.source.begin(); it != pipeline.source.end(); ++it)
+            {
+                bool wantsMore = false;
+
+                if constexpr (IS_IENUMERABLE<Source> && !std::is_copy_constructible_v<TypeInspect::ItemOf<Source>>)
+                {
+                    wantsMore = sink(it.release());
+                }
+                else
+                {
+                    wantsMore = sink(*it);
+                }
+
+                if (borrowed != nullptr)
+                {
+                    co_yield *borrowed;
+                    borrowed = nullptr;
+                }
+                else if (owned.has_value())
+                {
+                    co_yield std::move(*owned);
+                    owned.reset();
+                }
+
+                if (!wantsMore)
+                {
+                    break;
+                }
+            }
+        }
+
+        // Whether the stages let no element through whatever the source holds, e.g. after `Seq::take(0)`. Stages never
+        // yield more elements than they get, so the source does not have to be pulled at all then.
+        bool isCutOff() const
+        {
+            return std::apply(
+                [](const Stages&... stage) -> bool
+                {
+                    SizeHint hint;
+                    ((hint = stage.hint(hint)), ...);
+                    return hint.isBounded() && hint.size() == 0;
+                },
+                stages);
+        }
+
+    public:
+        explicit Pipeline(Source source, std::tuple<Stages...> stages)
+            : source(std::move(source))
+            , stages(std::move(stages))
+        {
+        }
+
+        template<EnsureIsStage Stage>
+        auto append(Stage&& stage) &&
+        {
+            if constexpr (sizeof...(Stages) == 0)
+            {
+                return makePipeline(std::move(source), std::forward<Stage>(stage));
+            }
+            else
+            {
+                return Pipeline<Source, Stages..., TypeInspect::RemoveCVR<Stage>>(
+                    std::move(source), std::tuple_cat(std::move(stages), std::make_tuple(std::forward<Stage>(stage))));
+            }
+        }
+
+        // Pushes every element through the stages into the given sink until either side runs out.
+        template<typename Sink>
+        void run(Sink& sink)
+        {
+            if (isCutOff())
+            {
+                return;
+            }
+
+            auto chained = chain(stages,
+                                 [&sink](auto&& elem) -> bool
+                                 {
+                                     return sink(std::forward<decltype(elem)>(elem));
+                                 });
+
+            pushFrom(source, chained);
+        }
+
+        // A pipeline without stages is nothing more than its source, e.g. after a leading `Seq::skip` jumped ahead.
+        const Source& view() const
+        requires (sizeof...(Stages) == 0)
+        {
+            return source;
+        }
+
+        // Folds what is known about the length of the source through every stage.
+        SizeHint sizeHint() const
+        {
+            return std::apply(
+                [this](const Stages&... stage) -> SizeHint
+                {
+                    SizeHint hint = hintOf(source);
+                    ((hint = stage.hint(hint)), ...);
+                    return hint;
+                },
+                stages);
+        }
+
+        // Falls back to a coroutine whenever the pipeline needs to be type-erased.
+        // The pulled elements no longer live in the source, so only the length part of the hint is kept.
+        operator IEnumerable<Item>() &&
+        {
+            const SizeHint hint = sizeHint().detached();
+            return pull(std::move(source), std::move(stages)).withSizeHint(hint);
+        }
+
+        auto begin()
+        {
+            if (!pulled.has_value())
+            {
+                pulled.emplace(pull(std::move(source), std::move(stages)));
+            }
+
+            return pulled->begin();
+        }
+
+        auto end() { return pulled->end(); }
+    };
+
+    template<typename T>
+    constexpr bool IS_PIPELINE = false;
+
+    template<typename Source, typename... Stages>
+    constexpr bool IS_PIPELINE<Pipeline<Source, Stages...>> = true;
+
+    // Anything that collects stages and runs them into a sink, see `Pipeline::run`.
+    template<typename T>
+    concept EnsureIsPipeline = IS_PIPELINE<TypeInspect::RemoveCVR<T>>;
+
+    template<typename Sequence>
+    struct ItemOfSequence
+    {
+        using Type = TypeInspect::ItemOf<Sequence>;
+    };
+
+    template<EnsureIsPipeline Sequence>
+    struct ItemOfSequence<Sequence>
+    {
+        using Type = typename Sequence::Item;
+    };
+
+    // Element type of anything a fold can consume: pipelines, `IEnumerable<T>` and borrowed views.
+    template<typename Sequence>
+    using ItemOf = typename ItemOfSequence<TypeInspect::RemoveCVR<Sequence>>::Type;
+
+    // Drives a sequence into a sink that returns false when it wants to stop early.
+    template<typename Sequence, typename Sink>
+    inline void forEach(Sequence&& sequence, Sink&& sink)
+    {
+        if constexpr (EnsureIsPipeline<Sequence>)
+        {
+            sequence.run(sink);
+        }
+        else
+        {
+            pushFrom(sequence, sink);
+        }
+    }
+
+    // ┏━━━━━━━━┓
+    // ┃ Stages ┃
+    // ┗━━━━━━━━┛
+    // A stage is also callable on an `IEnumerable<T>` directly, like every other operator of the library.
+    template<typename Derived>
+    class Stage : public StageTag
+    {
+    public:
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const
+        {
+            using U = typename Derived::template Output<T>;
+            return IEnumerable<U>(makePipeline(std::move(sequence), static_cast<const Derived&>(*this)));
+        }
+    };
+
+    template<typename Mapping>
+    class MapStage : public Stage<MapStage<Mapping>>
+    {
+    private:
+        Mapping mapping;
+
+    public:
+        template<typename T>
+        using Output = TypeInspect::ReturnValueOf<Mapping, T>;
+
+        explicit MapStage(Mapping mapping)
+            : mapping(std::move(mapping))
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.elementwise(); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [this, next]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                static_assert(TypeInspect::IS_INVOKABLE<Mapping, Elem>);
+                return next(mapping(std::forward<Elem>(elem)));
+            };
+        }
+
+        // Block form of `wrap` used by `Seq::batched`, writes the result of every element of the block into `out`.
+        template<typename T, typename Out>
+        auto applyToBlock(std::span<const T> block, Out* out) -> std::size_t
+        {
+            for (std::size_t idx = 0; idx < block.size(); ++idx)
+            {
+                out[idx] = mapping(block[idx]);
+            }
+
+            return block.size();
+        }
+    };
+
+    template<typename Mapping>
+    class MapWithIndexStage : public Stage<MapWithIndexStage<Mapping>>
+    {
+    private:
+        Mapping mapping;
+
+    public:
+        template<typename T>
+        using Output = TypeInspect::ReturnValueOf<Mapping, T, std::size_t>;
+
+        explicit MapWithIndexStage(Mapping mapping)
+            : mapping(std::move(mapping))
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.elementwise(); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [this, next, idx = std::size_t{0}]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                static_assert(TypeInspect::IS_INVOKABLE<Mapping, Elem, std::size_t>);
+                return next(mapping(std::forward<Elem>(elem), idx++));
+            };
+        }
+    };
+
+    template<typename Predicate>
+    class FilterStage : public Stage<FilterStage<Predicate>>
+    {
+    private:
+        Predicate pred;
+
+    public:
+        template<typename T>
+        using Output = T;
+
+        explicit FilterStage(Predicate pred)
+            : pred(std::move(pred))
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.subsequence(); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [this, next]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                if (!pred(std::as_const(elem)))
+                {
+                    return true;
+                }
+
+                return next(std::forward<Elem>(elem));
+            };
+        }
+
+        // Block form of `wrap` used by `Seq::batched`, copies the kept elements to the front of `out` and returns how
+        // many there are. Trivially copyable elements are copied either way, which saves a branch per element.
+        template<typename T>
+        auto applyToBlock(std::span<const T> block, T* out) -> std::size_t
+        {
+            std::size_t kept = 0;
+
+            for (const T& elem : block)
+            {
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    out[kept] = elem;
+                    kept += static_cast<std::size_t>(static_cast<bool>(pred(elem)));
+                }
+                else if (pred(elem))
+                {
+                    out[kept++] = elem;
+                }
+            }
+
+            return kept;
+        }
+    };
+
+    class TakeStage : public Stage<TakeStage>
+    {
+    private:
+        std::size_t count;
+
+    public:
+        template<typename T>
+        using Output = T;
+
+        explicit TakeStage(std::size_t count)
+            : count(count)
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.takeFirst(count); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [next, remaining = count]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                if (remaining == 0)
+                {
+                    return false;
+                }
+
+                --remaining;
+                return next(std::forward<Elem>(elem)) && remaining != 0;
+            };
+        }
+    };
+
+    class SkipStage : public Stage<SkipStage>
+    {
+    private:
+        std::size_t count;
+
+    public:
+        template<typename T>
+        using Output = T;
+
+        explicit SkipStage(std::size_t count)
+            : count(count)
+        {
+        }
+
+        std::size_t skipped() const { return count; }
+
+        SizeHint hint(SizeHint input) const { return input.skipFirst(count); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [next, toSkip = count]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                if (toSkip > 0)
+                {
+                    --toSkip;
+                    return true;
+                }
+
+                return next(std::forward<Elem>(elem));
+            };
+        }
+    };
+
+    template<typename Predicate>
+    class TakeWhileStage : public Stage<TakeWhileStage<Predicate>>
+    {
+    private:
+        Predicate pred;
+
+    public:
+        template<typename T>
+        using Output = T;
+
+        explicit TakeWhileStage(Predicate pred)
+            : pred(std::move(pred))
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.subsequence(); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [this, next]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                if (!pred(std::as_const(elem)))
+                {
+                    return false;
+                }
+
+                return next(std::forward<Elem>(elem));
+            };
+        }
+    };
+
+    template<typename Predicate>
+    class SkipWhileStage : public Stage<SkipWhileStage<Predicate>>
+    {
+    private:
+        Predicate pred;
+
+    public:
+        template<typename T>
+        using Output = T;
+
+        explicit SkipWhileStage(Predicate pred)
+            : pred(std::move(pred))
+        {
+        }
+
+        SizeHint hint(SizeHint input) const { return input.subsequence(); }
+
+        template<typename Next>
+        auto wrap(Next next)
+        {
+            return [this, next, skipping = true]<typename Elem>(Elem&& elem) mutable -> bool
+            {
+                if (skipping && pred(std::as_const(elem)))
+                {
+                    return true;
+                }
+
+                skipping = false;
+                return next(std::forward<Elem>(elem));
+            };
+        }
+    };
+
+    // ┏━━━━━━━━━━━━━━━━━━━━━━━┓
+    // ┃ Building the pipeline ┃
+    // ┗━━━━━━━━━━━━━━━━━━━━━━━┛
+    template<typename T, std::size_t Extent>
+    inline auto dropFront(std::span<T, Extent> view, std::size_t count) -> std::span<T>
+    {
+        return view.subspan(std::min(count, view.size()));
+    }
+
+    template<typename CharT, typename Traits>
+    inline auto dropFront(std::basic_string_view<CharT, Traits> view, std::size_t count)
+        -> std::basic_string_view<CharT, Traits>
+    {
+        return view.substr(std::min(count, view.size()));
+    }
+
+    template<typename Source>
+    concept EnsureIsDroppable = requires (Source source, std::size_t count) {
+        { dropFront(source, count) } -> std::same_as<Source>;
+    };
+
+    // A leading `Seq::skip` over a random-access view jumps ahead instead of iterating over the skipped elements.
+    template<EnsureIsStage Stage, typename Source>
+    inline auto makePipeline(Source source, Stage&& stage)
+    {
+        if constexpr (TypeInspect::IS<TypeInspect::RemoveCVR<Stage>, SkipStage> && EnsureIsDroppable<Source>)
+        {
+            return Pipeline<Source>(dropFront(std::move(source), stage.skipped()), {});
+        }
+        else
+        {
+            return Pipeline<Source, TypeInspect::RemoveCVR<Stage>>(std::move(source),
+                                                                   std::make_tuple(std::forward<Stage>(stage)));
+        }
+    }
+
+    // ┏━━━━━━━┓
+    // ┃ Folds ┃
+    // ┗━━━━━━━┛
+    // Wraps a lambda accepting any sequence that `Fused::forEach` understands.
+    template<typename Folder>
+    class Fold
+        : public FoldTag
+        , public Folder
+    {
+    public:
+        explicit Fold(Folder folder)
+            : Folder(std::move(folder))
+        {
+        }
+
+        using Folder::operator();
+    };
+}
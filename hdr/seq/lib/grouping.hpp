@@ -0,0 +1,154 @@
+// ┏━━━━━━━━━━━━━━┓
+// ┃ grouping.hpp ┃
+// ┗━━━━━━━━━━━━━━┛
+// Operators that bucket elements by a key, all on top of `FlatHash::FlatIndex`. `Seq::distinct` and `Seq::distinctBy`
+// stream, they yield an element as soon as its key shows up for the first time. `Seq::countBy` and `Seq::groupBy` have
+// to see the whole sequence first, which they consume in a single fused loop once their result is iterated. Groups of
+// `Seq::groupBy` are collected in a single arena holding every element in order of arrival, where the elements of a
+// group are linked through their positions. A group only gets a vector of its own once it is yielded. Keys and groups
+// come out in the order their keys first appeared in.
+#pragma once
+#include "flat_hash.hpp"
+#include "fused.hpp"
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Grouping
+{
+    template<typename Mapping, typename T>
+    using KeyOf = std::remove_cvref_t<std::invoke_result_t<Mapping&, const T&>>;
+
+    // Position following the last element of a group in the arena of `Seq::groupBy`.
+    constexpr std::size_t END_OF_GROUP = static_cast<std::size_t>(-1);
+
+    // Distinct keys of a sequence are usually far fewer than its elements, see `FlatHash::MAX_PRESIZE`.
+    template<typename Index>
+    inline void presize(Index& index, const SizeHint& hint)
+    {
+        if (hint.isBounded())
+        {
+            index.reserve(hint.size());
+        }
+    }
+
+    // Parameter mapping has signature `(T) -> Key`.
+    template<typename T, typename Mapping, typename Hash>
+    auto distinctElementsBy(IEnumerable<T> sequence, Mapping mapping, Hash hash) -> IEnumerable<T>
+    {
+        FlatHash::FlatIndex<KeyOf<Mapping, T>, Hash> seen(std::move(hash));
+        presize(seen, sequence.sizeHint());
+
+        for (const T& elem : sequence)
+        {
+            if (seen.insert(mapping(elem)).second)
+            {
+                co_yield elem;
+            }
+        }
+    }
+
+    // Consumes the sequence in a single fused loop once the result is iterated for the first time.
+    // Parameter mapping has signature `(T) -> Key`.
+    template<typename Sequence, typename Mapping, typename Hash, typename T = Fused::ItemOf<Sequence>>
+    auto countElementsBy(Sequence sequence, Mapping mapping, Hash hash)
+        -> IEnumerable<std::pair<KeyOf<Mapping, T>, std::size_t>>
+    {
+        FlatHash::FlatIndex<KeyOf<Mapping, T>, Hash> keys(std::move(hash));
+        presize(keys, hintOf(sequence));
+
+        std::vector<std::size_t> counts;
+
+        Fused::forEach(sequence,
+                       [&keys, &counts, &mapping](const auto& elem) -> bool
+                       {
+                           const auto [group, isNew] = keys.insert(mapping(elem));
+
+                           if (isNew)
+                           {
+                               counts.push_back(0);
+                           }
+
+                           ++counts[group];
+                           return true;
+                       });
+
+        std::vector<KeyOf<Mapping, T>> distinctKeys = keys.releaseKeys();
+
+        for (std::size_t group = 0; group < distinctKeys.size(); ++group)
+        {
+            co_yield std::make_pair(std::move(distinctKeys[group]), counts[group]);
+        }
+    }
+
+    // Consumes the sequence in a single fused loop once the result is iterated for the first time.
+    // Parameter mapping has signature `(T) -> Key`.
+    template<typename Sequence, typename Mapping, typename Hash, typename T = Fused::ItemOf<Sequence>>
+    auto groupElementsBy(Sequence sequence, Mapping mapping, Hash hash)
+        -> IEnumerable<std::pair<KeyOf<Mapping, T>, std::vector<T>>>
+    {
+        struct Group
+        {
+            std::size_t first;
+            std::size_t last;
+            std::size_t count;
+        };
+
+        const SizeHint hint = hintOf(sequence);
+
+        FlatHash::FlatIndex<KeyOf<Mapping, T>, Hash> keys(std::move(hash));
+        presize(keys, hint);
+
+        std::vector<Group> groups;
+        std::vector<T> arena;
+        std::vector<std::size_t> next;
+
+        if (hint.isExact())
+        {
+            arena.reserve(hint.size());
+            next.reserve(hint.size());
+        }
+
+        Fused::forEach(sequence,
+                       [&keys, &groups, &arena, &next, &mapping]<typename Elem>(Elem&& elem) -> bool
+                       {
+                           const std::size_t position = arena.size();
+                           const auto [group, isNew]  = keys.insert(mapping(std::as_const(elem)));
+
+                           arena.push_back(std::forward<Elem>(elem));
+                           next.push_back(END_OF_GROUP);
+
+                           if (isNew)
+                           {
+                               groups.push_back(Group{position, position, 1});
+                           }
+                           else
+                           {
+                               next[groups[group].last] = position;
+                               groups[group].last       = position;
+                               ++groups[group].count;
+                           }
+
+                           return true;
+                       });
+
+        std::vector<KeyOf<Mapping, T>> distinctKeys = keys.releaseKeys();
+
+        for (std::size_t group = 0; group < groups.size(); ++group)
+        {
+            std::vector<T> members;
+            members.reserve(groups[group].count);
+
+            for (std::size_t position = groups[group].first; position != END_OF_GROUP; position = next[position])
+            {
+                members.push_back(std::move(arena[position]));
+            }
+
+            co_yield std::make_pair(std::move(distinctKeys[group]), std::move(members));
+        }
+    }
+}
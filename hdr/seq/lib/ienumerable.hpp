@@ -1,8 +1,25 @@
 #pragma once
+#include "frame_pool.hpp"
+#include "size_hint.hpp"
+
 #include <coroutine>
+#include <cstddef>
+#include <exception>
 #include <iterator>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
+#ifdef SEQ_COUNT_RESUMES
+namespace Seq::_internal
+{
+    // Resumptions of `IEnumerable<T>` coroutines by the current thread.
+    inline thread_local std::size_t resumeCount = 0;
+}
+#endif
+
+// A lazy sequence produced by a coroutine. Exceptions escaping the coroutine do not end the sequence quietly, they are
+// rethrown to the consumer from `begin()` or `operator++`, after every element yielded before them.
 template<typename T>
 class IEnumerable
 {
@@ -19,21 +36,79 @@ public:
 
         std::suspend_always final_suspend() noexcept { return {}; }
 
-        void unhandled_exception() {}
+        // Exceptions escaping the coroutine are rethrown to the consumer that resumed it.
+        void unhandled_exception() { exception = std::current_exception(); }
 
         void return_void() {}
 
+#ifndef SEQ_DISABLE_FRAME_POOL
+        static void* operator new(std::size_t size) { return Seq::_internal::FramePool::allocate(size); }
+
+        static void operator delete(void* frame, std::size_t size) noexcept
+        {
+            Seq::_internal::FramePool::deallocate(frame, size);
+        }
+#endif
+
     private:
-        T currentValue;
+        // Points to the last yielded object. It is either an lvalue living in the coroutine or a temporary of the
+        // `co_yield` expression, which stays alive until the coroutine is resumed. Either way yielding is copy-free.
+        T* currentValue = nullptr;
+
+        std::exception_ptr exception;
+
+        // Yielded expressions of a different type are converted into this awaiter that outlives the suspension too.
+        class ConvertedYield
+        {
+        private:
+            T value;
+
+        public:
+            template<typename U>
+            explicit ConvertedYield(U&& expr)
+                : value(std::forward<U>(expr))
+            {
+            }
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(Handle handle) noexcept { handle.promise().currentValue = std::addressof(value); }
+
+            void await_resume() const noexcept {}
+        };
 
     public:
-        std::suspend_always yield_value(T expr)
+        std::suspend_always yield_value(T&& expr) noexcept
+        {
+            currentValue = std::addressof(expr);
+            return {};
+        }
+
+        std::suspend_always yield_value(const T& expr) noexcept
         {
-            currentValue = std::move(expr);
+            // Constness is only dropped to let consumers hand over elements of move-only types, see `release`
+            currentValue = const_cast<T*>(std::addressof(expr));
             return {};
         }
 
-        const T& unwrap() const { return currentValue; }
+        template<typename U>
+        requires (!std::is_same_v<std::remove_cvref_t<U>, T> && std::is_constructible_v<T, U>)
+        ConvertedYield yield_value(U&& expr)
+        {
+            return ConvertedYield(std::forward<U>(expr));
+        }
+
+        const T& unwrap() const { return *currentValue; }
+
+        void rethrowIfFailed()
+        {
+            if (exception)
+            {
+                std::rethrow_exception(std::exchange(exception, nullptr));
+            }
+        }
+
+        T&& release() const { return std::move(*currentValue); }
     };
 
     // NOLINTEND(readability-identifier-naming)
@@ -45,10 +120,20 @@ private:
         promise_type::Handle ienumeratorHandle;
 
     public:
-        void operator++() { ienumeratorHandle.resume(); }
+        void operator++()
+        {
+#ifdef SEQ_COUNT_RESUMES
+            ++Seq::_internal::resumeCount;
+#endif
+            ienumeratorHandle.resume();
+            ienumeratorHandle.promise().rethrowIfFailed();
+        }
 
         const T& operator*() const { return ienumeratorHandle.promise().unwrap(); }
 
+        // Moves the current element out of the sequence. Meant for consumers of elements that cannot be copied.
+        T&& release() const { return ienumeratorHandle.promise().release(); }
+
         bool operator!=(const IEnumerator& /*unused*/) const noexcept
         {
             return ienumeratorHandle.address() != nullptr && !ienumeratorHandle.done();
@@ -71,6 +156,7 @@ private:
     };
 
     promise_type::Handle ienumerableHandle;
+    Seq::_internal::SizeHint hint;
 
     explicit IEnumerable(const promise_type::Handle handle)
         : ienumerableHandle(handle)
@@ -82,7 +168,11 @@ public:
     {
         if (ienumerableHandle.address() != nullptr && !ienumerableHandle.done())
         {
+#ifdef SEQ_COUNT_RESUMES
+            ++Seq::_internal::resumeCount;
+#endif
             ienumerableHandle.resume();
+            ienumerableHandle.promise().rethrowIfFailed();
         }
 
         return IEnumerator(ienumerableHandle);
@@ -90,8 +180,19 @@ public:
 
     IEnumerator end() const { return {}; }
 
+    // What is known about the length of the sequence before it is iterated.
+    Seq::_internal::SizeHint sizeHint() const { return hint; }
+
+    // Lets producers attach what they know about the length of the sequence they are about to yield.
+    IEnumerable withSizeHint(Seq::_internal::SizeHint newHint) &&
+    {
+        hint = newHint;
+        return std::move(*this);
+    }
+
     IEnumerable(IEnumerable&& other) noexcept
         : ienumerableHandle(other.ienumerableHandle)
+        , hint(other.hint)
     {
         other.ienumerableHandle = {};
     }
@@ -0,0 +1,361 @@
+// ┏━━━━━━━━━━━━━┓
+// ┃ joining.hpp ┃
+// ┗━━━━━━━━━━━━━┛
+// `Seq::join` and `Seq::groupJoin` match the elements of an outer sequence against an inner one by key. The inner side
+// is read into a lookup table once the result is iterated for the first time, the outer side is streamed through it
+// and never held in memory. The table keeps the inner elements in a single buffer where all elements of a key sit next
+// to each other, so the matches of an outer element are one contiguous span found by a single probe. Inner sides with
+// a lot of elements are split into partitions by a few bits of their hash. Every partition gets a small index of its
+// own, which is built in one go and stays in cache while it is built, and a probe only touches a single partition.
+#pragma once
+#include "flat_hash.hpp"
+#include "fused.hpp"
+#include "ienumerable.hpp"
+#include "seq_helper.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Joining
+{
+    // Inner sides are only split into partitions from this many elements on.
+    constexpr std::size_t PARTITIONED_BUILD = std::size_t{1} << 16;
+
+    // Elements per partition the inner side is split into, small enough for the index of a partition to stay in cache.
+    constexpr std::size_t PARTITION_SIZE = std::size_t{1} << 13;
+
+    // Partitions are picked by the bits right above the tag bits, which are the lower half of the scrambled hash, so
+    // keys of the same partition still differ in all of their tag bits. Positions within the index of a partition come
+    // from the topmost bits, which only reach down to these for indexes of more than 2^16 slots, so keys of the same
+    // partition still spread over the whole index.
+    constexpr int PARTITION_SHIFT = 32;
+
+    constexpr int MAX_PARTITION_BITS = 16;
+
+    template<typename Key, typename T, typename Hash>
+    class LookupTable
+    {
+    private:
+        struct Partition
+        {
+            FlatHash::FlatIndex<Key, Hash> keys;
+
+            // Position of the first element of the partition
+            std::size_t first;
+
+            // Elements of the nth key of the partition are `elements[offsets[n], offsets[n + 1])`. Partitions where
+            // every key has a single element, like most reference tables, leave it empty and find them at `first + n`.
+            std::vector<std::size_t> offsets;
+        };
+
+        std::vector<T> elements;
+        std::vector<Partition> partitions;
+        int partitionBits = 0;
+        Hash hash;
+
+        auto partitionOf(std::uint64_t scrambled) const -> std::size_t
+        {
+            const std::uint64_t mask = (std::uint64_t{1} << partitionBits) - 1;
+            return static_cast<std::size_t>((scrambled >> PARTITION_SHIFT) & mask);
+        }
+
+    public:
+        // Parameter mapping has signature `(T) -> Key`.
+        template<typename Inner, typename Mapping>
+        LookupTable(Inner& inner, Mapping& mapping, Hash hash)
+            : hash(std::move(hash))
+        {
+            std::vector<T> buffered;
+            std::vector<Key> keys;
+            std::vector<std::uint64_t> hashes;
+
+            if (const SizeHint hint = hintOf(inner); hint.isExact())
+            {
+                buffered.reserve(hint.size());
+                keys.reserve(hint.size());
+                hashes.reserve(hint.size());
+            }
+
+            Fused::forEach(inner,
+                           [this, &buffered, &keys, &hashes, &mapping]<typename Elem>(Elem&& elem) -> bool
+                           {
+                               Key& key = keys.emplace_back(mapping(std::as_const(elem)));
+                               hashes.push_back(FlatHash::scramble(this->hash(key)));
+                               buffered.push_back(std::forward<Elem>(elem));
+                               return true;
+                           });
+
+            const std::size_t count = buffered.size();
+
+            if (count >= PARTITIONED_BUILD)
+            {
+                const int wanted = static_cast<int>(std::bit_width(count / PARTITION_SIZE)) - 1;
+                partitionBits    = std::min(wanted, MAX_PARTITION_BITS);
+            }
+
+            // Elements ordered by partition, elements of the same partition keep their order. Keys and hashes are
+            // moved into that order as well, so every partition is indexed from contiguous memory.
+            const std::size_t partitionCount = std::size_t{1} << partitionBits;
+            std::vector<std::size_t> partitionStart(partitionCount + 1, 0);
+            std::vector<std::size_t> byPartition;
+
+            if (partitionCount > 1)
+            {
+                for (std::uint64_t scrambled : hashes)
+                {
+                    ++partitionStart[partitionOf(scrambled) + 1];
+                }
+
+                std::partial_sum(partitionStart.begin(), partitionStart.end(), partitionStart.begin());
+                std::vector<std::size_t> cursor(partitionStart.begin(), partitionStart.end() - 1);
+
+                byPartition.resize(count);
+
+                for (std::size_t idx = 0; idx < count; ++idx)
+                {
+                    byPartition[cursor[partitionOf(hashes[idx])]++] = idx;
+                }
+
+                std::vector<Key> partitionedKeys;
+                std::vector<std::uint64_t> partitionedHashes;
+
+                partitionedKeys.reserve(count);
+                partitionedHashes.reserve(count);
+
+                for (std::size_t idx : byPartition)
+                {
+                    partitionedKeys.push_back(std::move(keys[idx]));
+                    partitionedHashes.push_back(hashes[idx]);
+                }
+
+                keys   = std::move(partitionedKeys);
+                hashes = std::move(partitionedHashes);
+            }
+            else
+            {
+                partitionStart[1] = count;
+            }
+
+            // Every partition is indexed on its own, the dense index of a key is its group within the partition
+            std::vector<std::uint32_t> groupOf(count);
+
+            partitions.reserve(partitionCount);
+
+            for (std::size_t part = 0; part < partitionCount; ++part)
+            {
+                const std::size_t first = partitionStart[part];
+                const std::size_t last  = partitionStart[part + 1];
+
+                Partition& partition = partitions.emplace_back(FlatHash::FlatIndex<Key, Hash>(this->hash), first);
+                partition.keys.reserve(last - first);
+
+                std::vector<std::size_t>& offsets = partition.offsets;
+                offsets.push_back(first);
+
+                for (std::size_t pos = first; pos < last; ++pos)
+                {
+                    const auto [group, isNew] = partition.keys.insert(std::move(keys[pos]), hashes[pos]);
+
+                    if (isNew)
+                    {
+                        offsets.push_back(0);
+                    }
+
+                    groupOf[pos] = static_cast<std::uint32_t>(group);
+                    ++offsets[group + 1];
+                }
+
+                if (partition.keys.size() == last - first)
+                {
+                    offsets = std::vector<std::size_t>();
+                }
+                else
+                {
+                    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+                }
+            }
+
+            // Elements of the same key are moved next to each other. Partitions with a single element per key are
+            // in that order already, so a single such partition leaves the elements where they were buffered.
+            for (const Partition& partition : partitions)
+            {
+                if (partition.offsets.empty())
+                {
+                    continue;
+                }
+
+                if (byPartition.empty())
+                {
+                    byPartition.resize(count);
+                    std::iota(byPartition.begin(), byPartition.end(), std::size_t{0});
+                }
+
+                const std::size_t first = partition.first;
+                const std::size_t last  = partition.offsets.back();
+
+                std::vector<std::size_t> next(partition.offsets.begin(), partition.offsets.end() - 1);
+                std::vector<std::size_t> placed(last - first);
+
+                for (std::size_t pos = first; pos < last; ++pos)
+                {
+                    placed[next[groupOf[pos]]++ - first] = byPartition[pos];
+                }
+
+                std::ranges::copy(placed, byPartition.begin() + static_cast<std::ptrdiff_t>(first));
+            }
+
+            if (byPartition.empty())
+            {
+                elements = std::move(buffered);
+                return;
+            }
+
+            elements.reserve(count);
+
+            for (std::size_t idx : byPartition)
+            {
+                elements.push_back(std::move(buffered[idx]));
+            }
+        }
+
+        // Inner elements with the given key in the order they appeared in.
+        auto find(const Key& key) const -> std::span<const T>
+        {
+            const std::uint64_t scrambled          = FlatHash::scramble(hash(key));
+            const Partition& partition             = partitions[partitionOf(scrambled)];
+            const std::optional<std::size_t> group = partition.keys.find(key, scrambled);
+
+            if (!group.has_value())
+            {
+                return {};
+            }
+
+            if (partition.offsets.empty())
+            {
+                return std::span<const T>(elements).subspan(partition.first + *group, 1);
+            }
+
+            const std::size_t from = partition.offsets[*group];
+            const std::size_t to   = partition.offsets[*group + 1];
+
+            return std::span<const T>(elements).subspan(from, to - from);
+        }
+    };
+
+    template<typename Inner, typename Mapping>
+    using KeyOf = std::remove_cvref_t<std::invoke_result_t<Mapping&, const Fused::ItemOf<Inner>&>>;
+
+    // Parameter outerKey has signature `(T) -> Key`.
+    // Parameter innerKey has signature `(U) -> Key`.
+    // Parameter result has signature `(T, U) -> R`.
+    template<typename T, typename Inner, typename OuterKey, typename InnerKey, typename Result, typename Hash,
+             typename U = Fused::ItemOf<Inner>, typename R = std::invoke_result_t<Result&, const T&, const U&>>
+    auto joinElements(IEnumerable<T> outer, Inner inner, OuterKey outerKey, InnerKey innerKey, Result result,
+                      Hash hash) -> IEnumerable<R>
+    {
+        using Key = KeyOf<Inner, InnerKey>;
+
+        const LookupTable<Key, U, Hash> table(inner, innerKey, hash);
+
+        for (const T& elem : outer)
+        {
+            const Key& key = outerKey(elem);
+
+            for (const U& match : table.find(key))
+            {
+                co_yield result(elem, match);
+            }
+        }
+    }
+
+    // Parameter outerKey has signature `(T) -> Key`.
+    // Parameter innerKey has signature `(U) -> Key`.
+    // Parameter result has signature `(T, std::span<const U>) -> R`.
+    template<typename T, typename Inner, typename OuterKey, typename InnerKey, typename Result, typename Hash,
+             typename U = Fused::ItemOf<Inner>,
+             typename R = std::invoke_result_t<Result&, const T&, std::span<const U>>>
+    auto groupJoinElements(IEnumerable<T> outer, Inner inner, OuterKey outerKey, InnerKey innerKey, Result result,
+                           Hash hash) -> IEnumerable<R>
+    {
+        using Key = KeyOf<Inner, InnerKey>;
+
+        const LookupTable<Key, U, Hash> table(inner, innerKey, hash);
+
+        for (const T& elem : outer)
+        {
+            const Key& key = outerKey(elem);
+            co_yield result(elem, table.find(key));
+        }
+    }
+
+    // The operator behind `Seq::join` and `Seq::groupJoin`.
+    template<bool Grouped, typename Inner, typename OuterKey, typename InnerKey, typename Result, typename Hash>
+    class Join
+    {
+    private:
+        Inner inner;
+        OuterKey outerKey;
+        InnerKey innerKey;
+        Result result;
+        Hash hash;
+
+        template<typename T>
+        auto joinWith(IEnumerable<T> outer, Inner joined) const
+        {
+            if constexpr (Grouped)
+            {
+                const SizeHint hint = outer.sizeHint().elementwise();
+                return groupJoinElements(std::move(outer), std::move(joined), outerKey, innerKey, result, hash)
+                    .withSizeHint(hint);
+            }
+            else
+            {
+                return joinElements(std::move(outer), std::move(joined), outerKey, innerKey, result, hash);
+            }
+        }
+
+    public:
+        Join(Inner inner, OuterKey outerKey, InnerKey innerKey, Result result, Hash hash)
+            : inner(std::move(inner))
+            , outerKey(std::move(outerKey))
+            , innerKey(std::move(innerKey))
+            , result(std::move(result))
+            , hash(std::move(hash))
+        {
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> outer) const&
+        {
+            return joinWith(std::move(outer), inner);
+        }
+
+        // Inner sequences that cannot be copied, like an `IEnumerable<T>`, can only be joined this way once.
+        template<typename T>
+        auto operator()(IEnumerable<T> outer) &&
+        {
+            return joinWith(std::move(outer), std::move(inner));
+        }
+    };
+
+    template<bool Grouped, typename Inner, typename OuterKey, typename InnerKey, typename Result, typename Hash>
+    inline auto makeJoin(Inner&& inner, OuterKey&& outerKey, InnerKey&& innerKey, Result&& result, Hash hash)
+    {
+        using InnerT = decltype(keepArgument(std::forward<Inner>(inner)));
+
+        return Join<Grouped, InnerT, std::decay_t<OuterKey>, std::decay_t<InnerKey>, std::decay_t<Result>, Hash>(
+            keepArgument(std::forward<Inner>(inner)),
+            std::forward<OuterKey>(outerKey),
+            std::forward<InnerKey>(innerKey),
+            std::forward<Result>(result),
+            std::move(hash));
+    }
+}
@@ -0,0 +1,213 @@
+// ┏━━━━━━━━━━━━━━━━━━┓
+// ┃ map_parallel.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━┛
+// `Seq::mapParallel` maps the elements of any sequence on the thread pool, including generators and file readers which
+// `Seq::parallel` cannot split. The consuming thread pulls elements from the source in batches and posts every batch
+// as a task of its own. Batches are kept in a window in source order, which doubles as the reorder buffer: results are
+// only yielded from the oldest batch, once it is done, while the pool keeps working on the younger ones. The window
+// never holds more than `maxInFlight` elements, so memory stays bounded no matter how long the source is. A thread
+// waiting for the oldest batch runs queued batches itself instead of sitting idle.
+#pragma once
+#include "buffer.hpp"
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "thread_pool.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::MapParallel
+{
+    // Elements in flight for every thread when the window is chosen automatically.
+    constexpr std::size_t IN_FLIGHT_PER_THREAD = 64;
+
+    // Batches a thread should get on average inside the window, which leaves room for stealing.
+    constexpr std::size_t BATCHES_PER_THREAD = 2;
+
+    template<typename T, typename U>
+    struct Batch
+    {
+        std::vector<T> inputs;
+        Buffer<U> outputs;
+        std::exception_ptr error;
+        std::atomic<bool> done{false};
+    };
+
+    // Batches posted to the pool in source order. Destroying it waits until the pool is done with every one of them.
+    template<typename T, typename U, typename Mapping>
+    class Window
+    {
+    private:
+        ThreadPool* pool;
+        const Mapping* mapping;
+        std::deque<std::unique_ptr<Batch<T, U>>> batches;
+
+        // Set once the consumer is gone, so batches that have not started yet are skipped.
+        std::atomic<bool> cancelled{false};
+
+        void run(Batch<T, U>& batch) const
+        {
+            if (!cancelled.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    for (const T& input : batch.inputs)
+                    {
+                        batch.outputs.emplace_back((*mapping)(input));
+                    }
+                }
+                catch (...)
+                {
+                    batch.error = std::current_exception();
+                }
+            }
+
+            batch.done.store(true, std::memory_order_release);
+        }
+
+    public:
+        Window(ThreadPool& pool, const Mapping& mapping)
+            : pool(&pool)
+            , mapping(&mapping)
+        {
+        }
+
+        Window(const Window&)            = delete;
+        Window& operator=(const Window&) = delete;
+
+        ~Window()
+        {
+            cancelled.store(true, std::memory_order_relaxed);
+
+            for (const std::unique_ptr<Batch<T, U>>& batch : batches)
+            {
+                wait(*batch);
+            }
+        }
+
+        std::size_t size() const { return batches.size(); }
+
+        void post(std::vector<T> inputs)
+        {
+            Batch<T, U>& batch = *batches.emplace_back(std::make_unique<Batch<T, U>>());
+            batch.outputs.reserve(inputs.size());
+            batch.inputs = std::move(inputs);
+            pool->post([this, &batch] { run(batch); });
+        }
+
+        void wait(const Batch<T, U>& batch) const
+        {
+            while (!batch.done.load(std::memory_order_acquire))
+            {
+                if (!pool->help())
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Waits for the oldest batch and hands it out, without removing it from the window yet.
+        auto oldest() const -> Batch<T, U>&
+        {
+            Batch<T, U>& batch = *batches.front();
+            wait(batch);
+            return batch;
+        }
+
+        void dropOldest() { batches.pop_front(); }
+    };
+
+    template<typename U, typename T, typename Mapping>
+    auto mapOrdered(IEnumerable<T> source, Mapping mapping, ThreadPool& pool, std::size_t batchSize,
+                    std::size_t batchesInFlight) -> IEnumerable<U>
+    {
+        Window<T, U, Mapping> window(pool, mapping);
+        auto it = source.begin();
+
+        while (true)
+        {
+            while (it != source.end() && window.size() < batchesInFlight)
+            {
+                std::vector<T> inputs;
+                inputs.reserve(batchSize);
+
+                for (; it != source.end() && inputs.size() < batchSize; ++it)
+                {
+                    if constexpr (std::is_copy_constructible_v<T>)
+                    {
+                        inputs.push_back(*it);
+                    }
+                    else
+                    {
+                        inputs.push_back(it.release());
+                    }
+                }
+
+                window.post(std::move(inputs));
+            }
+
+            if (window.size() == 0)
+            {
+                break;
+            }
+
+            // Results mapped before an exception are still yielded, the exception follows them
+            Batch<T, U>& batch = window.oldest();
+
+            for (U& output : batch.outputs)
+            {
+                co_yield output;
+            }
+
+            if (batch.error)
+            {
+                std::rethrow_exception(batch.error);
+            }
+
+            window.dropOldest();
+        }
+    }
+
+    template<typename Mapping>
+    class Operator
+    {
+    private:
+        Mapping mapping;
+        std::size_t threads;
+        std::size_t maxInFlight;
+
+    public:
+        Operator(Mapping mapping, std::size_t threads, std::size_t maxInFlight)
+            : mapping(std::move(mapping))
+            , threads(threads)
+            , maxInFlight(maxInFlight)
+        {
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const
+        {
+            static_assert(TypeInspect::IS_INVOKABLE<const Mapping&, const T&>,
+                          "Seq::mapParallel calls its mapping from multiple threads, it must be callable as const");
+
+            using U = TypeInspect::RemoveCVR<TypeInspect::ReturnValueOf<const Mapping&, const T&>>;
+
+            ThreadPool& pool            = ThreadPool::withThreads(threads);
+            const std::size_t window    = maxInFlight != 0 ? maxInFlight : IN_FLIGHT_PER_THREAD * pool.concurrency();
+            const std::size_t batchSize = std::max<std::size_t>(window / (pool.concurrency() * BATCHES_PER_THREAD), 1);
+            const std::size_t batches   = std::max<std::size_t>(window / batchSize, 1);
+
+            const SizeHint hint = sequence.sizeHint().elementwise();
+            return mapOrdered<U>(std::move(sequence), mapping, pool, batchSize, batches).withSizeHint(hint);
+        }
+    };
+}
@@ -0,0 +1,206 @@
+// ┏━━━━━━━━━━━━━━━━━┓
+// ┃ mapped_file.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━┛
+// `Seq::mmapLines` and `Seq::mmapRecords` read a file through a read-only memory mapping instead of copying it into a
+// container first. Lines are yielded as `std::string_view` and records as references straight into the mapping, so the
+// page cache is the only copy of the file. The kernel is told that the mapping is read sequentially, which makes it
+// read ahead more aggressively and drop pages behind the reader sooner. The mapping belongs to the coroutine frame of
+// the returned sequence and is unmapped when the sequence is destroyed. Platforms without `mmap` read the whole file
+// into memory instead, which keeps the same interface and the same lifetime of the views.
+#pragma once
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define SEQ_HAS_MMAP 1
+#else
+    #include <fstream>
+    #include <memory>
+    #define SEQ_HAS_MMAP 0
+#endif
+
+namespace Seq::_internal::Mapping
+{
+    class MappedFile
+    {
+    private:
+        const std::byte* data = nullptr;
+        std::size_t length    = 0;
+
+#if !SEQ_HAS_MMAP
+        std::unique_ptr<std::byte[]> contents;
+#endif
+
+        [[noreturn]] static void fail(const char* operatorName, const std::filesystem::path& path)
+        {
+            const std::string message = std::string(operatorName) + " could not map " + path.string();
+            throw std::system_error(errno, std::generic_category(), message);
+        }
+
+    public:
+        // Parameter operatorName is the public operator reading the file, used in error messages.
+        MappedFile(const std::filesystem::path& path, const char* operatorName)
+        {
+#if SEQ_HAS_MMAP
+            const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (descriptor < 0)
+            {
+                fail(operatorName, path);
+            }
+
+            struct stat status{};
+
+            if (::fstat(descriptor, &status) != 0)
+            {
+                const int error = errno;
+                ::close(descriptor);
+                errno = error;
+                fail(operatorName, path);
+            }
+
+            length = static_cast<std::size_t>(status.st_size);
+
+            // Mappings of zero bytes are not allowed, empty files simply have no data
+            if (length > 0)
+            {
+                void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+                if (mapped == MAP_FAILED)
+                {
+                    const int error = errno;
+                    ::close(descriptor);
+                    errno = error;
+                    fail(operatorName, path);
+                }
+
+                ::madvise(mapped, length, MADV_SEQUENTIAL);
+                data = static_cast<const std::byte*>(mapped);
+            }
+
+            // The mapping keeps the file alive on its own
+            ::close(descriptor);
+#else
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+
+            if (!in)
+            {
+                errno = ENOENT;
+                fail(operatorName, path);
+            }
+
+            length   = static_cast<std::size_t>(in.tellg());
+            contents = std::make_unique<std::byte[]>(length);
+            data     = contents.get();
+
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(contents.get()), static_cast<std::streamsize>(length));
+#endif
+        }
+
+        MappedFile(MappedFile&& other) noexcept
+            : data(std::exchange(other.data, nullptr))
+            , length(std::exchange(other.length, 0))
+#if !SEQ_HAS_MMAP
+            , contents(std::move(other.contents))
+#endif
+        {
+        }
+
+        ~MappedFile()
+        {
+#if SEQ_HAS_MMAP
+            if (data != nullptr)
+            {
+                ::munmap(const_cast<std::byte*>(data), length);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&)                = delete;
+        MappedFile& operator=(const MappedFile&)     = delete;
+        MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+        auto bytes() const -> std::span<const std::byte> { return {data, length}; }
+
+        auto text() const -> std::string_view { return {reinterpret_cast<const char*>(data), length}; }
+    };
+
+    // Splits at `\n` and drops a `\r` right before it. A final line break does not start another line.
+    inline auto yieldLines(MappedFile file) -> IEnumerable<std::string_view>
+    {
+        const std::string_view text = file.text();
+        std::size_t first           = 0;
+
+        while (first < text.size())
+        {
+            const void* found = std::memchr(text.data() + first, '\n', text.size() - first);
+            const std::size_t last  = found != nullptr
+                                          ? static_cast<std::size_t>(static_cast<const char*>(found) - text.data())
+                                          : text.size();
+
+            std::string_view line = text.substr(first, last - first);
+
+            if (line.ends_with('\r'))
+            {
+                line.remove_suffix(1);
+            }
+
+            co_yield line;
+            first = last + 1;
+        }
+    }
+
+    // The mapping starts on a page boundary and `sizeof(T)` is a multiple of `alignof(T)`, so every record is aligned.
+    template<typename T>
+    auto yieldRecords(MappedFile file) -> IEnumerable<T>
+    {
+        const std::span<const std::byte> bytes = file.bytes();
+        const T* records                       = reinterpret_cast<const T*>(bytes.data());
+
+        for (std::size_t idx = 0; idx < bytes.size() / sizeof(T); ++idx)
+        {
+            co_yield records[idx];
+        }
+    }
+
+    // The file is mapped right away, so a missing file is reported where the sequence is created.
+    inline auto lines(const std::filesystem::path& path) -> IEnumerable<std::string_view>
+    {
+        return yieldLines(MappedFile(path, "Seq::mmapLines"));
+    }
+
+    template<typename T>
+    auto records(const std::filesystem::path& path) -> IEnumerable<T>
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Seq::mmapRecords only supports trivially copyable records");
+
+        MappedFile file(path, "Seq::mmapRecords");
+        const std::size_t size = file.bytes().size();
+
+        if (size % sizeof(T) != 0)
+        {
+            throw std::runtime_error("Seq::mmapRecords found a partial record at the end of " + path.string());
+        }
+
+        return yieldRecords<T>(std::move(file)).withSizeHint(SizeHint::exact(size / sizeof(T)));
+    }
+}
+
+#undef SEQ_HAS_MMAP
@@ -0,0 +1,267 @@
+// ┏━━━━━━━━━━━━━━┓
+// ┃ ordering.hpp ┃
+// ┗━━━━━━━━━━━━━━┛
+// `Seq::sortBy` and its siblings never move the elements themselves while sorting. Every element is buffered once and
+// its keys are computed once, then stored next to the position of the element in a compact array of entries. Only
+// those entries are sorted, which keeps the data touched by comparisons small and contiguous even for large elements.
+// The sorted entries are a permutation of the buffer, so elements are yielded straight from where they were buffered.
+// An ordering can be refined with `thenBy` to break ties of the previous keys. Stable orderings break all remaining
+// ties by the position of the elements, which makes every backend produce the same stable result.
+#pragma once
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "sort_backends.hpp"
+
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Ordering
+{
+    template<typename Mapping, bool Descending>
+    struct SortKey
+    {
+        static constexpr bool DESCENDING = Descending;
+
+        Mapping mapping;
+    };
+
+    // Keys of an element and the position it was buffered at.
+    template<typename Index, typename... Keys>
+    struct Entry
+    {
+        std::tuple<Keys...> keys;
+        Index index;
+    };
+
+    // Strings and other keys with a three-way comparison are compared once per key instead of twice.
+    template<typename Key>
+    inline auto compareKeys(const Key& lhs, const Key& rhs) -> int
+    {
+        if constexpr (std::three_way_comparable<Key>)
+        {
+            const auto order = lhs <=> rhs;
+            return order < 0 ? -1 : (order > 0 ? 1 : 0);
+        }
+        else
+        {
+            return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+        }
+    }
+
+    // Compares entries key by key, each in its own direction, and finally by position if the ordering is stable.
+    // Behaves like a key of its own, so the sort backends can use it just like any other key.
+    template<bool Stable, typename Directions, typename Entry>
+    struct CompositeKey
+    {
+        const Entry* entry;
+
+        template<std::size_t KeyIdx = 0>
+        auto compare(const CompositeKey& other) const -> int
+        {
+            if constexpr (KeyIdx == std::tuple_size_v<Directions>)
+            {
+                if constexpr (Stable)
+                {
+                    return compareKeys(entry->index, other.entry->index);
+                }
+                else
+                {
+                    return 0;
+                }
+            }
+            else
+            {
+                const int order = compareKeys(std::get<KeyIdx>(entry->keys), std::get<KeyIdx>(other.entry->keys));
+
+                if (order != 0)
+                {
+                    return std::tuple_element_t<KeyIdx, Directions>::DESCENDING ? -order : order;
+                }
+
+                return compare<KeyIdx + 1>(other);
+            }
+        }
+
+        bool operator<(const CompositeKey& other) const { return compare(other) < 0; }
+    };
+
+    // Sorts the entries incrementally and returns the buffer position of the element that belongs to a position.
+    template<SortBackend Backend, bool Stable, typename SortKeys, typename Index, typename... Keys>
+    class Permutation
+    {
+    private:
+        using EntryT   = Entry<Index, Keys...>;
+        using FirstKey = std::tuple_element_t<0, std::tuple<Keys...>>;
+
+        static constexpr bool SINGLE_KEY = sizeof...(Keys) == 1;
+
+        static constexpr bool RADIX_ALLOWED = Backend == SortBackend::AUTO || Backend == SortBackend::RADIX;
+
+        // A single key is sorted by directly. Radix sort is stable on its own, so stable orderings of radix keys
+        // leave the ties to it instead of comparing positions.
+        static constexpr bool DIRECT_KEY =
+            SINGLE_KEY && (!Stable || (Sorting::EnsureIsRadixKey<FirstKey> && RADIX_ALLOWED));
+
+        static constexpr bool DESCENDING = DIRECT_KEY && std::tuple_element_t<0, SortKeys>::DESCENDING;
+
+        static constexpr SortBackend EFFECTIVE_BACKEND =
+            DIRECT_KEY && Stable && Backend == SortBackend::AUTO ? SortBackend::RADIX : Backend;
+
+        static auto keyOf(const EntryT& entry) -> decltype(auto)
+        {
+            if constexpr (DIRECT_KEY)
+            {
+                return std::get<0>(entry.keys);
+            }
+            else
+            {
+                return CompositeKey<Stable, SortKeys, EntryT>{&entry};
+            }
+        }
+
+        std::vector<EntryT> entries;
+        Sorting::IncrementalSort<EFFECTIVE_BACKEND, DESCENDING, EntryT, decltype(&keyOf)> sorter;
+
+    public:
+        explicit Permutation(std::vector<EntryT> entries)
+            : entries(std::move(entries))
+            , sorter(this->entries, &keyOf)
+        {
+        }
+
+        Permutation(const Permutation&)                = delete;
+        Permutation(Permutation&&)                     = delete;
+        Permutation& operator=(const Permutation&)     = delete;
+        Permutation& operator=(Permutation&&) noexcept = delete;
+
+        auto at(std::size_t position) -> std::size_t { return sorter.at(position).index; }
+    };
+
+    template<SortBackend Backend, bool Stable, typename SortKeys, typename Index, typename T>
+    inline auto permutationOf(const std::vector<T>& elements, const SortKeys& sortKeys)
+    {
+        return std::apply(
+            [&elements](const auto&... sortKey)
+            {
+                using EntryT = Entry<Index, std::remove_cvref_t<decltype(sortKey.mapping(elements.front()))>...>;
+
+                std::vector<EntryT> entries;
+                entries.reserve(elements.size());
+
+                for (std::size_t idx = 0; idx < elements.size(); ++idx)
+                {
+                    entries.push_back(EntryT{{sortKey.mapping(elements[idx])...}, static_cast<Index>(idx)});
+                }
+
+                using PermutationT = Permutation<Backend,
+                                                 Stable,
+                                                 SortKeys,
+                                                 Index,
+                                                 std::remove_cvref_t<decltype(sortKey.mapping(elements.front()))>...>;
+
+                return std::make_unique<PermutationT>(std::move(entries));
+            },
+            sortKeys);
+    }
+
+    template<SortBackend Backend, bool Stable, typename T, typename SortKeys>
+    auto yieldPermuted(IEnumerable<T> sequence, SortKeys sortKeys) -> IEnumerable<T>
+    {
+        std::vector<T> elements;
+
+        if (const SizeHint hint = sequence.sizeHint(); hint.isExact())
+        {
+            elements.reserve(hint.size());
+        }
+
+        elements.insert(elements.end(), sequence.begin(), sequence.end());
+
+        if (elements.empty())
+        {
+            co_return;
+        }
+
+        // Positions are stored in 32 bits whenever they fit, which keeps the entries of small keys compact
+        if (elements.size() <= std::numeric_limits<std::uint32_t>::max())
+        {
+            auto permutation = permutationOf<Backend, Stable, SortKeys, std::uint32_t>(elements, sortKeys);
+
+            for (std::size_t position = 0; position < elements.size(); ++position)
+            {
+                co_yield elements[permutation->at(position)];
+            }
+        }
+        else
+        {
+            auto permutation = permutationOf<Backend, Stable, SortKeys, std::size_t>(elements, sortKeys);
+
+            for (std::size_t position = 0; position < elements.size(); ++position)
+            {
+                co_yield elements[permutation->at(position)];
+            }
+        }
+    }
+
+    // The operator behind `Seq::sortBy` and its siblings, refined by `thenBy` and `thenByDescending`.
+    template<SortBackend Backend, bool Stable, typename... SortKeys>
+    class OrderBy
+    {
+    private:
+        std::tuple<SortKeys...> sortKeys;
+
+        template<bool Descending, typename Mapping>
+        auto refined(Mapping&& mapping) const
+        {
+            using Refinement = SortKey<std::decay_t<Mapping>, Descending>;
+
+            return OrderBy<Backend, Stable, SortKeys..., Refinement>(
+                std::tuple_cat(sortKeys, std::make_tuple(Refinement{std::forward<Mapping>(mapping)})));
+        }
+
+    public:
+        explicit OrderBy(std::tuple<SortKeys...> sortKeys)
+            : sortKeys(std::move(sortKeys))
+        {
+        }
+
+        // Orders elements with equal keys so far in ascending order of another key.
+        // Parameter mapping has signature `(T) -> U`.
+        template<typename Mapping>
+        auto thenBy(Mapping&& mapping) const
+        {
+            return refined<false>(std::forward<Mapping>(mapping));
+        }
+
+        // Orders elements with equal keys so far in descending order of another key.
+        // Parameter mapping has signature `(T) -> U`.
+        template<typename Mapping>
+        auto thenByDescending(Mapping&& mapping) const
+        {
+            return refined<true>(std::forward<Mapping>(mapping));
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const -> IEnumerable<T>
+        {
+            const SizeHint hint = sequence.sizeHint().elementwise();
+            return yieldPermuted<Backend, Stable>(std::move(sequence), sortKeys).withSizeHint(hint);
+        }
+    };
+
+    template<SortBackend Backend, bool Stable, bool Descending, typename Mapping>
+    inline auto orderBy(Mapping&& mapping)
+    {
+        using First = SortKey<std::decay_t<Mapping>, Descending>;
+        return OrderBy<Backend, Stable, First>(std::make_tuple(First{std::forward<Mapping>(mapping)}));
+    }
+}
@@ -0,0 +1,269 @@
+// ┏━━━━━━━━━━━━━━┓
+// ┃ parallel.hpp ┃
+// ┗━━━━━━━━━━━━━━┛
+// `Seq::parallel` turns a random-access source into a parallel pipeline. The stages following it are collected just
+// like in a regular `Fused::Pipeline`, but the source is cut into chunks of `grain` elements and every chunk runs
+// through the stages on the thread pool. Each chunk writes its results into its own buffer. Once every chunk is done,
+// the buffers are moved into the consuming operator in source order, so the output is the same as a sequential run.
+// Only stages that treat every element on its own (`Seq::map` and `Seq::filter`) can run in parallel. Any other
+// operator, including fused stages like `Seq::take`, takes over the results of the parallel part as an ordinary
+// sequence.
+#pragma once
+#include "buffer.hpp"
+#include "fused.hpp"
+#include "ienumerable.hpp"
+#include "seq_helper.hpp"
+#include "size_hint.hpp"
+#include "thread_pool.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Parallel
+{
+    // Chunks a thread should get on average when the grain is chosen automatically, which leaves room for stealing.
+    constexpr std::size_t CHUNKS_PER_THREAD = 8;
+
+    // Smallest automatically chosen grain, so that tiny chunks do not drown in scheduling overhead.
+    constexpr std::size_t MIN_GRAIN = 1024;
+
+    class Policy
+    {
+    private:
+        std::size_t threads;
+        std::size_t grain;
+
+    public:
+        Policy(std::size_t threads, std::size_t grain)
+            : threads(threads)
+            , grain(grain)
+        {
+        }
+
+        auto pool() const -> ThreadPool& { return ThreadPool::withThreads(threads); }
+
+        auto grainFor(std::size_t length, std::size_t concurrency) const -> std::size_t
+        {
+            if (grain != 0)
+            {
+                return grain;
+            }
+
+            const std::size_t chunks = concurrency * CHUNKS_PER_THREAD;
+            return std::max(MIN_GRAIN, (length + chunks - 1) / chunks);
+        }
+
+        // Sources without random access have nothing to split, they simply stay sequential.
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const -> IEnumerable<T>
+        {
+            return sequence;
+        }
+    };
+
+    template<typename T>
+    concept EnsureIsPolicy = TypeInspect::IS<TypeInspect::RemoveCVR<T>, Policy>;
+
+    template<typename Stage>
+    constexpr bool IS_PARALLELIZABLE = false;
+
+    template<typename Mapping>
+    constexpr bool IS_PARALLELIZABLE<Fused::MapStage<Mapping>> = true;
+
+    template<typename Predicate>
+    constexpr bool IS_PARALLELIZABLE<Fused::FilterStage<Predicate>> = true;
+
+    // `Source` is a borrowed view with random access, e.g. a `std::span` or a `std::ranges::subrange`.
+    template<typename Source, typename... Stages>
+    class Pipeline
+    {
+    public:
+        using Item = typename Fused::OutputOf<TypeInspect::ItemOf<Source>, Stages...>::Type;
+
+    private:
+        Source source;
+        Policy policy;
+        std::tuple<Stages...> stages;
+
+        auto chunkOf(std::size_t first, std::size_t last) const
+        {
+            const auto begin = std::ranges::begin(source);
+            return std::ranges::subrange(begin + static_cast<std::ptrdiff_t>(first),
+                                         begin + static_cast<std::ptrdiff_t>(last));
+        }
+
+        static auto yieldCollected(Buffer<Item> items) -> IEnumerable<Item>
+        {
+            for (Item& item : items)
+            {
+                co_yield std::move(item);
+            }
+        }
+
+        // Runs the parallel part only once the first element is pulled, for stages appended after it.
+        static auto collectOnPull(Pipeline pipeline) -> IEnumerable<Item>
+        {
+            Buffer<Item> items = pipeline.collect();
+
+            for (Item& item : items)
+            {
+                co_yield std::move(item);
+            }
+        }
+
+        auto collect() -> Buffer<Item>
+        {
+            Buffer<Item> items;
+
+            if (const SizeHint hint = sizeHint(); hint.isExact())
+            {
+                items.reserve(hint.size());
+            }
+
+            auto collectInto = [&items](auto&& elem) -> bool
+            {
+                items.emplace_back(std::forward<decltype(elem)>(elem));
+                return true;
+            };
+
+            run(collectInto);
+            return items;
+        }
+
+    public:
+        Pipeline(Source source, Policy policy, std::tuple<Stages...> stages)
+            : source(std::move(source))
+            , policy(policy)
+            , stages(std::move(stages))
+        {
+        }
+
+        // Any other stage starts a sequential pipeline on the results of the parallel part, in source order.
+        template<Fused::EnsureIsStage Stage>
+        auto append(Stage&& stage) &&
+        {
+            using Appended = TypeInspect::RemoveCVR<Stage>;
+
+            if constexpr (IS_PARALLELIZABLE<Appended>)
+            {
+                auto appended = std::tuple_cat(std::move(stages), std::make_tuple(std::forward<Stage>(stage)));
+                return Pipeline<Source, Stages..., Appended>(std::move(source), policy, std::move(appended));
+            }
+            else
+            {
+                const SizeHint hint = sizeHint();
+                return Fused::makePipeline(collectOnPull(std::move(*this)).withSizeHint(hint),
+                                           std::forward<Stage>(stage));
+            }
+        }
+
+        SizeHint sizeHint() const
+        {
+            return std::apply(
+                [this](const Stages&... stage) -> SizeHint
+                {
+                    SizeHint hint = SizeHint::exact(std::ranges::size(source));
+                    ((hint = stage.hint(hint)), ...);
+                    return hint;
+                },
+                stages);
+        }
+
+        // Runs the chunks on the thread pool, then hands their results to the sink in source order.
+        template<typename Sink>
+        void run(Sink& sink)
+        {
+            ThreadPool& pool         = policy.pool();
+            const std::size_t length = std::ranges::size(source);
+            const std::size_t grain  = policy.grainFor(length, pool.concurrency());
+            const std::size_t chunks = (length + grain - 1) / grain;
+
+            if (pool.concurrency() == 1 || chunks <= 1)
+            {
+                auto chained = Fused::chain(stages,
+                                            [&sink](auto&& elem) -> bool
+                                            {
+                                                return sink(std::forward<decltype(elem)>(elem));
+                                            });
+
+                Fused::pushFrom(source, chained);
+                return;
+            }
+
+            std::vector<Buffer<Item>> results(chunks);
+
+            pool.parallelFor(chunks,
+                             [this, grain, length, &results](std::size_t chunk)
+                             {
+                                 const std::size_t first = chunk * grain;
+                                 const std::size_t last  = std::min(length, first + grain);
+
+                                 Buffer<Item>& out = results[chunk];
+                                 out.reserve(last - first);
+
+                                 // Every chunk works on its own copy of the stages, so they never share mutable state
+                                 auto localStages = stages;
+                                 auto chained     = Fused::chain(localStages,
+                                                             [&out](auto&& elem) -> bool
+                                                             {
+                                                                 out.emplace_back(std::forward<decltype(elem)>(elem));
+                                                                 return true;
+                                                             });
+
+                                 Fused::pushFrom(chunkOf(first, last), chained);
+                             });
+
+            for (Buffer<Item>& result : results)
+            {
+                for (Item& item : result)
+                {
+                    if (!sink(std::move(item)))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
+        // Operators that are not fused get the results of the parallel part once all of them are ready.
+        operator IEnumerable<Item>() &&
+        {
+            Buffer<Item> items = collect();
+
+            const SizeHint hint = SizeHint::exact(items.size());
+            return yieldCollected(std::move(items)).withSizeHint(hint);
+        }
+    };
+
+    // Contiguous containers are borrowed as usual, other random-access containers as a pair of iterators.
+    template<typename SeqT>
+    inline auto makePipeline(const SeqT& sequence, const Policy& policy)
+    {
+        if constexpr (std::ranges::contiguous_range<const SeqT> && std::ranges::sized_range<const SeqT>)
+        {
+            return Pipeline<decltype(borrow(sequence))>(borrow(sequence), policy, {});
+        }
+        else if constexpr (std::ranges::random_access_range<const SeqT> && std::ranges::sized_range<const SeqT>)
+        {
+            auto view = std::ranges::subrange(std::ranges::begin(sequence), std::ranges::end(sequence));
+            return Pipeline<decltype(view)>(view, policy, {});
+        }
+        else
+        {
+            return wrapAsIEnumerable(ByValue(borrow(sequence)));
+        }
+    }
+}
+
+namespace Seq::_internal::Fused
+{
+    template<typename Source, typename... Stages>
+    constexpr bool IS_PIPELINE<Parallel::Pipeline<Source, Stages...>> = true;
+}
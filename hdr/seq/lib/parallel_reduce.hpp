@@ -0,0 +1,160 @@
+// ┏━━━━━━━━━━━━━━━━━━━━━┓
+// ┃ parallel_reduce.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━━┛
+// `Seq::reduceParallel` and `Seq::aggregateParallel` fold sized random-access sources on the thread pool. The source is
+// cut into leaves, every leaf is folded into a partial result of its own starting from the identity, and the partial
+// results are merged pairwise with their neighbour, level by level, until one is left. How the source is cut only
+// depends on its length, never on the number of threads or on which thread finishes first. Every run therefore
+// performs the very same operations in the very same order, which keeps floating-point results reproducible. Partial
+// results are written by different threads at the same time, so each of them gets cache lines of its own. Sources
+// without random access are folded sequentially on the calling thread.
+#pragma once
+#include "fused.hpp"
+#include "thread_pool.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::ParallelReduce
+{
+    // Smallest number of elements folded into a single partial result.
+    constexpr std::size_t MIN_LEAF = 4096;
+
+    // Most partial results a source is cut into, which is plenty for any number of threads.
+    constexpr std::size_t MAX_LEAVES = 256;
+
+    template<typename Accumulator>
+    struct alignas(CACHE_LINE_SIZE) Partial
+    {
+        std::optional<Accumulator> value;
+    };
+
+    inline auto leafCount(std::size_t length) -> std::size_t
+    {
+        return std::clamp<std::size_t>(length / MIN_LEAF, 1, MAX_LEAVES);
+    }
+
+    template<typename Sequence>
+    constexpr bool IS_SPLITTABLE = std::ranges::random_access_range<const TypeInspect::RemoveCVR<Sequence>>
+                                   && std::ranges::sized_range<const TypeInspect::RemoveCVR<Sequence>>;
+
+    // Parameter foldLeaf has signature `(Accumulator&, Subrange) -> void`.
+    // Parameter merge has signature `(Accumulator&, Accumulator&&) -> void`.
+    template<typename Accumulator, typename Range, typename FoldLeaf, typename Merge>
+    auto reduceTree(const Range& range, ThreadPool& pool, const Accumulator& identity, FoldLeaf foldLeaf, Merge merge)
+        -> Accumulator
+    {
+        const std::size_t length = std::ranges::size(range);
+        const std::size_t leaves = leafCount(length);
+        const auto begin         = std::ranges::begin(range);
+
+        std::vector<Partial<Accumulator>> partials(leaves);
+
+        pool.parallelFor(leaves,
+                         [&](std::size_t leaf)
+                         {
+                             const auto first = static_cast<std::ptrdiff_t>(length * leaf / leaves);
+                             const auto last  = static_cast<std::ptrdiff_t>(length * (leaf + 1) / leaves);
+
+                             Accumulator accum = identity;
+                             foldLeaf(accum, std::ranges::subrange(begin + first, begin + last));
+                             partials[leaf].value.emplace(std::move(accum));
+                         });
+
+        // Merges within a level are independent of each other, only the levels have to run one after another
+        for (std::size_t stride = 1; stride < leaves; stride *= 2)
+        {
+            const std::size_t pairs = (leaves + 2 * stride - 1) / (2 * stride);
+
+            pool.parallelFor(pairs,
+                             [&](std::size_t pair)
+                             {
+                                 const std::size_t left = pair * 2 * stride;
+
+                                 if (left + stride < leaves)
+                                 {
+                                     merge(*partials[left].value, std::move(*partials[left + stride].value));
+                                 }
+                             });
+        }
+
+        return std::move(*partials.front().value);
+    }
+
+    template<typename Sequence, typename Accumulator, typename Step, typename Combine>
+    auto reduce(Sequence&& sequence, ThreadPool& pool, const Accumulator& identity, const Step& step,
+                const Combine& combine) -> Accumulator
+    {
+        if constexpr (IS_SPLITTABLE<Sequence>)
+        {
+            return reduceTree(
+                sequence,
+                pool,
+                identity,
+                [&step](Accumulator& accum, const auto& leaf)
+                {
+                    for (const auto& elem : leaf)
+                    {
+                        accum = step(elem, accum);
+                    }
+                },
+                [&combine](Accumulator& left, Accumulator&& right)
+                {
+                    left = combine(std::move(left), std::move(right));
+                });
+        }
+        else
+        {
+            Accumulator out = identity;
+
+            Fused::forEach(std::forward<Sequence>(sequence),
+                           [&step, &out](const auto& elem) -> bool
+                           {
+                               out = step(elem, out);
+                               return true;
+                           });
+
+            return out;
+        }
+    }
+
+    template<typename Sequence, typename Accumulator, typename Step, typename Combine>
+    auto aggregate(Sequence&& sequence, ThreadPool& pool, const Accumulator& identity, const Step& step,
+                   const Combine& combine) -> Accumulator
+    {
+        if constexpr (IS_SPLITTABLE<Sequence>)
+        {
+            return reduceTree(
+                sequence,
+                pool,
+                identity,
+                [&step](Accumulator& accum, const auto& leaf)
+                {
+                    for (const auto& elem : leaf)
+                    {
+                        step(accum, elem);
+                    }
+                },
+                [&combine](Accumulator& left, Accumulator&& right) { combine(left, std::move(right)); });
+        }
+        else
+        {
+            Accumulator out = identity;
+
+            Fused::forEach(std::forward<Sequence>(sequence),
+                           [&step, &out](const auto& elem) -> bool
+                           {
+                               step(out, elem);
+                               return true;
+                           });
+
+            return out;
+        }
+    }
+}
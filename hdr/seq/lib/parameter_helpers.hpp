@@ -1,4 +1,7 @@
 #pragma once
+#include "selectors.hpp"
+#include "size_hint.hpp"
+
 #include <utility>
 
 template<typename T>
@@ -21,7 +24,7 @@ public:
     explicit operator T&() noexcept { return m_value; }
 
     ByValue(ByValue&& other) noexcept
-        : m_value(other.m_value)
+        : m_value(std::move(other.m_value))
     {
     }
 
@@ -31,3 +34,22 @@ public:
     ByValue& operator=(const ByValue&)     = delete;
     ByValue& operator=(ByValue&&) noexcept = delete;
 };
+
+template<typename T>
+class ByReference
+{
+private:
+    const T* m_value;
+
+public:
+    explicit ByReference(const T& value)
+        : m_value(&value)
+    {
+    }
+
+    auto begin() const { return Seq::_internal::Selectors::beginSelector(*m_value); }
+
+    auto end() const { return Seq::_internal::Selectors::endSelector(*m_value); }
+
+    auto sizeHint() const -> Seq::_internal::SizeHint { return Seq::_internal::hintOf(*m_value); }
+};
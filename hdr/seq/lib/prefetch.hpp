@@ -0,0 +1,260 @@
+// ┏━━━━━━━━━━━━━━┓
+// ┃ prefetch.hpp ┃
+// ┗━━━━━━━━━━━━━━┛
+// `Seq::prefetch` splits a pipeline in two halves that run at the same time. Everything before it is pulled by a thread
+// of its own, which moves the elements into a ring buffer of a fixed capacity. Everything after it takes them out on
+// the consuming thread. The ring has exactly one producer and one consumer, so both sides only ever publish their own
+// position with a release store and read the position of the other side with an acquire load, without any lock in
+// between. A side only sleeps (on `std::atomic::wait`) when the ring is full or empty, so a producer that is faster
+// than the consumer is held back once it is a whole ring ahead. Sleeping sides are woken up once half the ring is ready
+// for them (or the sequence ended), which keeps the threads from taking turns on every single element. Elements are
+// consumed in place and their slot is handed back once the next element is requested. Exceptions thrown by the producer
+// are rethrown on the consuming thread after every element before them was consumed. A consumer that stops early tells
+// the producer to stop and joins its thread.
+#pragma once
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq::_internal::Prefetch
+{
+    template<typename T>
+    class Ring
+    {
+    private:
+        // Both sides count the elements they are done with and keep the count shifted by one bit. The lowest bit tells
+        // the other side that no more elements will be produced or wanted.
+        static constexpr std::size_t STOPPED = 1;
+
+        std::vector<std::optional<T>> slots;
+        std::size_t mask;
+        std::size_t batch;
+
+        // Written by the consumer only.
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head{0};
+        std::atomic<std::uint32_t> freed{0};
+
+        // Written by the producer only, the error is published together with the stop bit.
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail{0};
+        std::atomic<std::uint32_t> filled{0};
+        std::exception_ptr error;
+
+        // A side that has to wait sleeps on the signal of the other side, which only changes once a whole batch of
+        // slots is ready for it. Neither side is woken up for every single element that way.
+        static void raise(std::atomic<std::uint32_t>& signal)
+        {
+            signal.fetch_add(1, std::memory_order_release);
+            signal.notify_one();
+        }
+
+    public:
+        explicit Ring(std::size_t capacity)
+            : slots(std::bit_ceil(capacity))
+            , mask(slots.size() - 1)
+            , batch(std::max<std::size_t>(slots.size() / 2, 1))
+        {
+        }
+
+        // Producer side, waits for a free slot and returns false once the consumer is gone.
+        template<typename Elem>
+        bool push(Elem&& elem)
+        {
+            const std::size_t position = tail.load(std::memory_order_relaxed) >> 1;
+
+            while (true)
+            {
+                const std::uint32_t signal = freed.load(std::memory_order_acquire);
+                const std::size_t consumer = head.load(std::memory_order_acquire);
+
+                if ((consumer & STOPPED) != 0)
+                {
+                    return false;
+                }
+
+                if (position - (consumer >> 1) < slots.size())
+                {
+                    break;
+                }
+
+                freed.wait(signal, std::memory_order_acquire);
+            }
+
+            slots[position & mask].emplace(std::forward<Elem>(elem));
+            tail.store((position + 1) << 1, std::memory_order_release);
+
+            if ((position + 1) % batch == 0)
+            {
+                raise(filled);
+            }
+
+            return true;
+        }
+
+        void finish(std::exception_ptr failure)
+        {
+            error = std::move(failure);
+            tail.store(tail.load(std::memory_order_relaxed) | STOPPED, std::memory_order_release);
+            raise(filled);
+        }
+
+        // Consumer side, waits for the next element or returns nothing at the end of the sequence.
+        auto front() -> T*
+        {
+            const std::size_t position = head.load(std::memory_order_relaxed) >> 1;
+
+            while (true)
+            {
+                const std::uint32_t signal = filled.load(std::memory_order_acquire);
+                const std::size_t producer = tail.load(std::memory_order_acquire);
+
+                if ((producer >> 1) != position)
+                {
+                    return &*slots[position & mask];
+                }
+
+                if ((producer & STOPPED) != 0)
+                {
+                    if (error)
+                    {
+                        std::rethrow_exception(error);
+                    }
+
+                    return nullptr;
+                }
+
+                filled.wait(signal, std::memory_order_acquire);
+            }
+        }
+
+        // Consumer side, hands the slot of the current element back to the producer.
+        void pop()
+        {
+            const std::size_t position = head.load(std::memory_order_relaxed) >> 1;
+            slots[position & mask].reset();
+            head.store((position + 1) << 1, std::memory_order_release);
+
+            if ((position + 1) % batch == 0)
+            {
+                raise(freed);
+            }
+        }
+
+        void cancel()
+        {
+            head.store(head.load(std::memory_order_relaxed) | STOPPED, std::memory_order_release);
+            raise(freed);
+        }
+    };
+
+    // Owns the thread pulling the upstream sequence. Destroying it stops and joins the thread.
+    template<typename T>
+    class Prefetcher
+    {
+    private:
+        Ring<T> ring;
+        std::thread producer;
+
+    public:
+        Prefetcher(IEnumerable<T> source, std::size_t capacity)
+            : ring(capacity)
+        {
+            producer = std::thread(
+                [this, source = std::move(source)]() mutable
+                {
+                    std::exception_ptr failure;
+
+                    try
+                    {
+                        auto it = source.begin();
+
+                        for (; it != source.end(); ++it)
+                        {
+                            const bool wantsMore = [&]
+                            {
+                                if constexpr (std::is_copy_constructible_v<T>)
+                                {
+                                    return ring.push(*it);
+                                }
+                                else
+                                {
+                                    return ring.push(it.release());
+                                }
+                            }();
+
+                            if (!wantsMore)
+                            {
+                                break;
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        failure = std::current_exception();
+                    }
+
+                    ring.finish(std::move(failure));
+                });
+        }
+
+        Prefetcher(const Prefetcher&)            = delete;
+        Prefetcher& operator=(const Prefetcher&) = delete;
+
+        ~Prefetcher()
+        {
+            ring.cancel();
+            producer.join();
+        }
+
+        auto front() -> T* { return ring.front(); }
+
+        void pop() { ring.pop(); }
+    };
+
+    template<typename T>
+    auto consume(IEnumerable<T> source, std::size_t capacity) -> IEnumerable<T>
+    {
+        Prefetcher<T> prefetcher(std::move(source), capacity);
+
+        for (T* elem = prefetcher.front(); elem != nullptr; elem = prefetcher.front())
+        {
+            co_yield *elem;
+            prefetcher.pop();
+        }
+    }
+
+    class Operator
+    {
+    private:
+        std::size_t capacity;
+
+    public:
+        explicit Operator(std::size_t capacity)
+            : capacity(capacity)
+        {
+            if (capacity == 0)
+            {
+                throw std::invalid_argument("Seq::prefetch needs room for at least one element");
+            }
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const -> IEnumerable<T>
+        {
+            const SizeHint hint = sequence.sizeHint().detached();
+            return consume(std::move(sequence), capacity).withSizeHint(hint);
+        }
+    };
+}
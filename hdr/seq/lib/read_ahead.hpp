@@ -0,0 +1,287 @@
+// ┏━━━━━━━━━━━━━━━━┓
+// ┃ read_ahead.hpp ┃
+// ┗━━━━━━━━━━━━━━━━┛
+// `Seq::readChunks` and `Seq::readLines` stream a file through two reused buffers instead of mapping it. A reader
+// thread of its own fills one buffer while the pipeline works on the other one, so the time spent waiting for the disk
+// overlaps with the time spent in the stages, and the pipeline only blocks when it is faster than the disk. Blocks are
+// handed out as views into the buffers, which means a block is only valid until the next one is requested and the
+// reader is never more than one block ahead. The reader starts with the first block as soon as the sequence is created
+// and is stopped and joined when the sequence is destroyed, even if it was not read to its end.
+#pragma once
+#include "ienumerable.hpp"
+
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace Seq::_internal::ReadAhead
+{
+    constexpr std::size_t DEFAULT_BLOCK_SIZE = std::size_t{1} << 20;
+
+    class Reader
+    {
+    private:
+        struct Buffer
+        {
+            std::vector<std::byte> data;
+            std::size_t size = 0;
+            bool isFull      = false;
+            std::exception_ptr error;
+        };
+
+        std::string operatorName;
+        std::string fileName;
+        std::FILE* file;
+
+        std::array<Buffer, 2> buffers;
+        std::size_t current = 0;
+        bool isHandedOut    = false;
+        bool isExhausted    = false;
+        bool isStopping     = false;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::thread worker;
+
+        // Reads until the buffer is full or the file ends, a short block is the last one.
+        auto fill(std::vector<std::byte>& data) -> std::size_t
+        {
+            std::size_t size = 0;
+
+            while (size < data.size())
+            {
+                const std::size_t read = std::fread(data.data() + size, 1, data.size() - size, file);
+
+                if (read == 0)
+                {
+                    if (std::ferror(file) != 0)
+                    {
+                        const std::string message = operatorName + " could not read " + fileName;
+                        throw std::system_error(errno, std::generic_category(), message);
+                    }
+
+                    break;
+                }
+
+                size += read;
+            }
+
+            return size;
+        }
+
+        // The buffers are filled strictly in turn, each one as soon as the pipeline has handed it back.
+        void readAll()
+        {
+            for (std::size_t idx = 0;; idx ^= 1)
+            {
+                Buffer& buffer = buffers[idx];
+
+                {
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [this, &buffer] { return !buffer.isFull || isStopping; });
+
+                    if (isStopping)
+                    {
+                        return;
+                    }
+                }
+
+                std::size_t size = 0;
+                std::exception_ptr error;
+
+                try
+                {
+                    size = fill(buffer.data);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                const bool isLast = error != nullptr || size < buffer.data.size();
+
+                {
+                    std::lock_guard lock(mutex);
+                    buffer.size   = size;
+                    buffer.error  = error;
+                    buffer.isFull = true;
+                    isExhausted   = isLast;
+                }
+
+                changed.notify_all();
+
+                if (isLast)
+                {
+                    return;
+                }
+            }
+        }
+
+    public:
+        // Parameter operatorName is the public operator reading the file, used in error messages.
+        Reader(const std::filesystem::path& path, std::size_t blockSize, const char* operatorName)
+            : operatorName(operatorName)
+            , fileName(path.string())
+            , file(std::fopen(fileName.c_str(), "rb"))
+        {
+            if (blockSize == 0)
+            {
+                if (file != nullptr)
+                {
+                    std::fclose(file);
+                }
+
+                throw std::invalid_argument(this->operatorName + " needs blocks of at least one byte");
+            }
+
+            if (file == nullptr)
+            {
+                const std::string message = this->operatorName + " could not open " + fileName;
+                throw std::system_error(errno, std::generic_category(), message);
+            }
+
+            // Reads go straight into the buffers below, another buffer in between would only copy them once more
+            std::setvbuf(file, nullptr, _IONBF, 0);
+
+            for (Buffer& buffer : buffers)
+            {
+                buffer.data.resize(blockSize);
+            }
+
+            worker = std::thread([this] { readAll(); });
+        }
+
+        // The reader thread points at this object.
+        Reader(const Reader&)            = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ~Reader()
+        {
+            {
+                std::lock_guard lock(mutex);
+                isStopping = true;
+            }
+
+            changed.notify_all();
+            worker.join();
+            std::fclose(file);
+        }
+
+        // Hands the previous block back to the reader and waits for the next one, which is empty once the file ends.
+        auto next() -> std::span<const std::byte>
+        {
+            std::unique_lock lock(mutex);
+
+            if (isHandedOut)
+            {
+                buffers[current].isFull = false;
+                current ^= 1;
+                changed.notify_all();
+            }
+
+            changed.wait(lock, [this] { return buffers[current].isFull || isExhausted; });
+            Buffer& buffer = buffers[current];
+
+            if (!buffer.isFull)
+            {
+                return {};
+            }
+
+            if (buffer.error != nullptr)
+            {
+                std::rethrow_exception(buffer.error);
+            }
+
+            isHandedOut = true;
+            return std::span<const std::byte>(buffer.data.data(), buffer.size);
+        }
+    };
+
+    inline auto yieldChunks(std::unique_ptr<Reader> reader) -> IEnumerable<std::span<const std::byte>>
+    {
+        for (std::span<const std::byte> block = reader->next(); !block.empty(); block = reader->next())
+        {
+            co_yield block;
+        }
+    }
+
+    // Lines within a block are views into it. Lines crossing the end of a block are put together in a string of their
+    // own, so they stay valid once the block is handed back to the reader.
+    inline auto yieldLines(std::unique_ptr<Reader> reader) -> IEnumerable<std::string_view>
+    {
+        std::string carried;
+
+        for (std::span<const std::byte> block = reader->next(); !block.empty(); block = reader->next())
+        {
+            const std::string_view text(reinterpret_cast<const char*>(block.data()), block.size());
+            std::size_t first = 0;
+
+            while (first < text.size())
+            {
+                const void* found = std::memchr(text.data() + first, '\n', text.size() - first);
+
+                if (found == nullptr)
+                {
+                    carried.append(text.substr(first));
+                    break;
+                }
+
+                const std::size_t last = static_cast<std::size_t>(static_cast<const char*>(found) - text.data());
+                std::string_view line  = text.substr(first, last - first);
+
+                if (!carried.empty())
+                {
+                    carried.append(line);
+                    line = carried;
+                }
+
+                if (line.ends_with('\r'))
+                {
+                    line.remove_suffix(1);
+                }
+
+                co_yield line;
+                carried.clear();
+                first = last + 1;
+            }
+        }
+
+        if (!carried.empty())
+        {
+            std::string_view line = carried;
+
+            if (line.ends_with('\r'))
+            {
+                line.remove_suffix(1);
+            }
+
+            co_yield line;
+        }
+    }
+
+    // The file is opened right away, so a missing file is reported where the sequence is created.
+    inline auto chunks(const std::filesystem::path& path, std::size_t blockSize)
+        -> IEnumerable<std::span<const std::byte>>
+    {
+        return yieldChunks(std::make_unique<Reader>(path, blockSize, "Seq::readChunks"));
+    }
+
+    inline auto lines(const std::filesystem::path& path, std::size_t blockSize) -> IEnumerable<std::string_view>
+    {
+        return yieldLines(std::make_unique<Reader>(path, blockSize, "Seq::readLines"));
+    }
+}
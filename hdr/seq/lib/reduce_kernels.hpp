@@ -0,0 +1,377 @@
+// ┏━━━━━━━━━━━━━━━━━━━━┓
+// ┃ reduce_kernels.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━┛
+// Arithmetic reductions like `Seq::sum` or `Seq::min` are carried out on blocks of contiguous elements. Each block is
+// folded into several independent accumulators (lanes) at once, which breaks the dependency chain of a single
+// accumulator. It lets the compiler emit SIMD instructions for whatever target it builds for (SSE, AVX2, NEON...)
+// without the library having to spell out any intrinsics. Floating-point additions are not associative, so a compiler
+// would never reorder a scalar loop like this on its own. Contiguous sources are processed as a single block, anything
+// else is staged through a small buffer on the stack first.
+#pragma once
+#include "fused.hpp"
+#include "type_inspect_utils.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace Seq
+{
+    // Strategy of `Seq::sum` and `Seq::average` for floating-point elements. Integers are always summed exactly.
+    // - `FAST` adds the elements in independent lanes, the error grows linearly with the length.
+    // - `PAIRWISE` adds blocks of elements in a balanced tree, the error grows logarithmically with the length.
+    // - `KAHAN` carries a compensation term for every lane, the error does not depend on the length.
+    // Note that compilation flags like `-ffast-math` are allowed to optimize away the compensation of `KAHAN`.
+    enum class Summation
+    {
+        FAST,
+        PAIRWISE,
+        KAHAN,
+    };
+}
+
+namespace Seq::_internal::Kernels
+{
+    // Number of independent accumulators. Wide enough to fill an AVX2 register with 32-bit elements.
+    constexpr std::size_t LANES = 8;
+
+    // Non-contiguous sources are copied into a buffer of this many elements before being reduced.
+    constexpr std::size_t STAGE_SIZE = 256;
+
+    // Blocks that `Summation::PAIRWISE` does not split any further.
+    constexpr std::size_t PAIRWISE_BLOCK = 128;
+
+    // Folds a block into every lane separately, then folds the lanes and the leftover elements into one value.
+    // Parameter combine has signature `(Accum, T) -> Accum` and must also accept `(Accum, Accum)`.
+    template<typename Accum, typename T, typename Combine>
+    inline auto foldLanes(std::span<const T> block, Accum identity, Combine combine) -> Accum
+    {
+        std::array<Accum, LANES> lanes;
+        lanes.fill(identity);
+
+        const std::size_t fullLanes = block.size() - block.size() % LANES;
+
+        for (std::size_t idx = 0; idx < fullLanes; idx += LANES)
+        {
+            for (std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                lanes[lane] = combine(lanes[lane], block[idx + lane]);
+            }
+        }
+
+        Accum out = identity;
+
+        for (const Accum& lane : lanes)
+        {
+            out = combine(out, lane);
+        }
+
+        for (std::size_t idx = fullLanes; idx < block.size(); ++idx)
+        {
+            out = combine(out, block[idx]);
+        }
+
+        return out;
+    }
+
+    // Signed integers are added up in their unsigned counterpart, which wraps around instead of overflowing. The lanes
+    // add elements in a different order than a plain loop, so partial sums may overflow where the loop's do not, while
+    // the wrapped total converted back is exactly the sum the loop computes.
+    template<typename Accum>
+    using Wrapping = std::conditional_t<std::is_integral_v<Accum> && std::is_signed_v<Accum>,
+                                        std::make_unsigned<Accum>,
+                                        std::type_identity<Accum>>::type;
+
+    template<typename Accum>
+    constexpr auto PLUS = [](Accum accum, auto elem) -> Accum
+    {
+        return accum + static_cast<Accum>(elem);
+    };
+
+    // Neumaier's variant of Kahan summation, which also stays accurate when the added value outweighs the sum.
+    template<typename Accum>
+    class CompensatedSum
+    {
+    private:
+        Accum sum          = Accum{};
+        Accum compensation = Accum{};
+
+    public:
+        void add(Accum value)
+        {
+            const Accum next = sum + value;
+
+            if (std::abs(sum) >= std::abs(value))
+            {
+                compensation += (sum - next) + value;
+            }
+            else
+            {
+                compensation += (value - next) + sum;
+            }
+
+            sum = next;
+        }
+
+        void add(const CompensatedSum& other)
+        {
+            add(other.sum);
+            compensation += other.compensation;
+        }
+
+        Accum result() const { return sum + compensation; }
+    };
+
+    // Branch-free Kahan summation per lane so the loop still vectorizes.
+    template<typename Accum, typename T>
+    inline auto kahanLanes(std::span<const T> block) -> CompensatedSum<Accum>
+    {
+        std::array<Accum, LANES> sums{};
+        std::array<Accum, LANES> compensations{};
+
+        const std::size_t fullLanes = block.size() - block.size() % LANES;
+
+        for (std::size_t idx = 0; idx < fullLanes; idx += LANES)
+        {
+            for (std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                const Accum value   = static_cast<Accum>(block[idx + lane]) - compensations[lane];
+                const Accum next    = sums[lane] + value;
+                compensations[lane] = (next - sums[lane]) - value;
+                sums[lane]          = next;
+            }
+        }
+
+        CompensatedSum<Accum> out;
+
+        for (std::size_t lane = 0; lane < LANES; ++lane)
+        {
+            out.add(sums[lane]);
+            out.add(-compensations[lane]);
+        }
+
+        for (std::size_t idx = fullLanes; idx < block.size(); ++idx)
+        {
+            out.add(static_cast<Accum>(block[idx]));
+        }
+
+        return out;
+    }
+
+    template<typename Accum, typename T>
+    inline auto pairwiseSum(std::span<const T> block) -> Accum
+    {
+        if (block.size() <= PAIRWISE_BLOCK)
+        {
+            return foldLanes<Accum>(block, Accum{}, PLUS<Accum>);
+        }
+
+        const std::size_t half = block.size() / 2;
+        return pairwiseSum<Accum>(block.first(half)) + pairwiseSum<Accum>(block.subspan(half));
+    }
+
+    // Sums blocks of elements as they arrive. `PAIRWISE` keeps one partial sum per level of a binary counter, so
+    // blocks of a streamed source are still combined in a balanced tree without knowing the length up front.
+    template<Summation Mode, typename Accum>
+    class Summer
+    {
+    private:
+        static constexpr Summation EFFECTIVE_MODE = std::is_floating_point_v<Accum> ? Mode : Summation::FAST;
+
+        Wrapping<Accum> total = Wrapping<Accum>{};
+        CompensatedSum<Accum> compensated;
+        std::array<Accum, 64> levels{};
+        std::uint64_t blocks = 0;
+
+    public:
+        template<typename T>
+        void add(std::span<const T> block)
+        {
+            if constexpr (EFFECTIVE_MODE == Summation::FAST)
+            {
+                total += foldLanes<Wrapping<Accum>>(block, Wrapping<Accum>{}, PLUS<Wrapping<Accum>>);
+            }
+            else if constexpr (EFFECTIVE_MODE == Summation::KAHAN)
+            {
+                compensated.add(kahanLanes<Accum>(block));
+            }
+            else
+            {
+                Accum carry       = pairwiseSum<Accum>(block);
+                std::size_t level = 0;
+
+                for (std::uint64_t occupied = blocks; (occupied & 1) != 0; occupied >>= 1, ++level)
+                {
+                    carry = levels[level] + carry;
+                }
+
+                levels[level] = carry;
+                ++blocks;
+            }
+        }
+
+        Accum result() const
+        {
+            if constexpr (EFFECTIVE_MODE == Summation::FAST)
+            {
+                return static_cast<Accum>(total);
+            }
+            else if constexpr (EFFECTIVE_MODE == Summation::KAHAN)
+            {
+                return compensated.result();
+            }
+            else
+            {
+                Accum out = Accum{};
+
+                for (std::size_t level = 0; level < levels.size(); ++level)
+                {
+                    if (((blocks >> level) & 1) != 0)
+                    {
+                        out += levels[level];
+                    }
+                }
+
+                return out;
+            }
+        }
+    };
+
+    // ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+    // ┃ Feeding blocks out of a sequence ┃
+    // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+    template<typename Sequence>
+    concept EnsureIsContiguous = std::ranges::contiguous_range<const TypeInspect::RemoveCVR<Sequence>>
+                                 && std::ranges::sized_range<const TypeInspect::RemoveCVR<Sequence>>;
+
+    // Hands the elements of a sequence to the sink in contiguous blocks of type `std::span<const T>`.
+    template<typename T, typename Sequence, typename BlockSink>
+    inline void forEachBlock(Sequence&& sequence, BlockSink&& sink)
+    {
+        if constexpr (requires { sequence.view(); })
+        {
+            forEachBlock<T>(sequence.view(), std::forward<BlockSink>(sink));
+        }
+        else if constexpr (Fused::EnsureIsBlockwise<Sequence>)
+        {
+            auto whole = [&sink](std::span<const T> block) -> bool
+            {
+                sink(block);
+                return true;
+            };
+
+            sequence.runBlocks(whole);
+        }
+        else if constexpr (EnsureIsContiguous<Sequence>)
+        {
+            sink(std::span<const T>(std::ranges::data(sequence), std::ranges::size(sequence)));
+        }
+        else
+        {
+            std::array<T, STAGE_SIZE> stage;
+            std::size_t staged = 0;
+
+            Fused::forEach(std::forward<Sequence>(sequence),
+                           [&stage, &staged, &sink](const auto& elem) -> bool
+                           {
+                               stage[staged++] = elem;
+
+                               if (staged == STAGE_SIZE)
+                               {
+                                   sink(std::span<const T>(stage));
+                                   staged = 0;
+                               }
+
+                               return true;
+                           });
+
+            if (staged > 0)
+            {
+                sink(std::span<const T>(stage.data(), staged));
+            }
+        }
+    }
+
+    template<Summation Mode, typename T, typename Accum, typename Sequence>
+    inline auto sum(Sequence&& sequence) -> Accum
+    {
+        Summer<Mode, Accum> summer;
+
+        forEachBlock<T>(std::forward<Sequence>(sequence),
+                        [&summer](std::span<const T> block)
+                        {
+                            summer.add(block);
+                        });
+
+        return summer.result();
+    }
+
+    // Returns nothing if the sequence is empty. Integers are averaged as double.
+    template<Summation Mode, typename T, typename Sequence>
+    inline auto average(Sequence&& sequence)
+    {
+        using Average = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+        Summer<Mode, Average> summer;
+        std::size_t count = 0;
+
+        forEachBlock<T>(std::forward<Sequence>(sequence),
+                        [&summer, &count](std::span<const T> block)
+                        {
+                            summer.add(block);
+                            count += block.size();
+                        });
+
+        return count == 0 ? std::nullopt : std::optional<Average>(summer.result() / static_cast<Average>(count));
+    }
+
+    // Returns the element that wins every comparison against the others, or nothing if the sequence is empty.
+    // Parameter isBetter has signature `(T, T) -> bool` and is expected to be a strict ordering like `<`.
+    // Only arithmetic elements go through the lanes, everything else is compared one by one.
+    template<typename T, typename Sequence, typename Compare>
+    inline auto select(Sequence&& sequence, Compare isBetter) -> std::optional<T>
+    {
+        std::optional<T> best;
+
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            const auto pick = [isBetter](T current, T candidate) -> T
+            {
+                return isBetter(candidate, current) ? candidate : current;
+            };
+
+            forEachBlock<T>(std::forward<Sequence>(sequence),
+                            [&best, &pick](std::span<const T> block)
+                            {
+                                // Empty containers and pipelines skipping past their end hand out empty blocks
+                                if (block.empty())
+                                {
+                                    return;
+                                }
+
+                                const T blockBest = foldLanes<T>(block, block.front(), pick);
+                                best              = best.has_value() ? pick(*best, blockBest) : blockBest;
+                            });
+        }
+        else
+        {
+            Fused::forEach(std::forward<Sequence>(sequence),
+                           [&best, &isBetter](const auto& elem) -> bool
+                           {
+                               if (!best.has_value() || isBetter(elem, *best))
+                               {
+                                   best = elem;
+                               }
+
+                               return true;
+                           });
+        }
+
+        return best;
+    }
+}
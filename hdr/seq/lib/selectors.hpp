@@ -7,13 +7,13 @@ namespace Seq::_internal::Selectors
     // ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
     // ┃ Types with `begin` and `end` member functions ┃
     // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
-    template<typename Seq, typename = std::void_t<decltype(std::declval<Seq>().begin())>>
+    template<typename Seq, typename = std::void_t<decltype(std::declval<const Seq&>().begin())>>
     inline auto beginSelector(const Seq& sequence)
     {
         return sequence.begin();
     }
 
-    template<typename Seq, typename = std::void_t<decltype(std::declval<Seq>().end())>>
+    template<typename Seq, typename = std::void_t<decltype(std::declval<const Seq&>().end())>>
     inline auto endSelector(const Seq& sequence)
     {
         return sequence.end();
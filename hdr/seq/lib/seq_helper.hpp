@@ -1,9 +1,18 @@
 #pragma once
+#include "fused.hpp"
 #include "ienumerable.hpp"
 #include "parameter_helpers.hpp"
+#include "size_hint.hpp"
+#include "sort_backends.hpp"
 #include "type_inspect_utils.hpp"
 
 #include <algorithm>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace Seq::_internal
@@ -11,23 +20,79 @@ namespace Seq::_internal
     using TypeInspect::ItemOf;
 
     template<typename Seq>
-    auto wrapAsIEnumerable(ByValue<Seq> sequence) -> IEnumerable<ItemOf<Seq>>
+    auto yieldElements(ByValue<Seq> sequence) -> IEnumerable<ItemOf<Seq>>
     {
-        for (const auto& elem : static_cast<Seq>(sequence))
+        for (const auto& elem : static_cast<Seq&>(sequence))
         {
             co_yield elem;
         }
     }
 
-    template<typename T, typename Accum>
-    auto sum(IEnumerable<T> sequence, Accum accum) -> Accum
+    template<typename Seq>
+    auto wrapAsIEnumerable(ByValue<Seq> sequence) -> IEnumerable<ItemOf<Seq>>
     {
-        for (const auto& elem : sequence)
+        const SizeHint hint = hintOf(static_cast<Seq&>(sequence)).elementwise();
+        return yieldElements(std::move(sequence)).withSizeHint(hint);
+    }
+
+    // `borrow` creates a non-owning view of an lvalue sequence so it can be iterated without being copied.
+    // Strings become `std::basic_string_view`, other contiguous containers `std::span` and the rest `ByReference`.
+    template<typename SeqT>
+    auto borrow(const SeqT& sequence)
+    {
+        static_assert(std::is_copy_constructible_v<ItemOf<SeqT>>,
+                      "Sequences of move-only elements must be moved into the pipeline, e.g. `std::move(items) | ...`");
+
+        if constexpr (TypeInspect::IS_BASIC_STRING<SeqT>)
+        {
+            return std::basic_string_view<typename SeqT::value_type, typename SeqT::traits_type>(sequence);
+        }
+        else if constexpr (std::ranges::contiguous_range<const SeqT> && std::ranges::sized_range<const SeqT>)
+        {
+            return std::span(std::ranges::data(sequence), std::ranges::size(sequence));
+        }
+        else
+        {
+            return ByReference(sequence);
+        }
+    }
+
+    // Sequences passed to an operator as an argument, like the inner side of `Seq::join`, are kept the way a fold
+    // consumes them. Lvalue containers are borrowed like the source of a pipeline, so they have to outlive the result.
+    // Everything else is owned.
+    template<typename SeqT>
+    auto keepArgument(SeqT&& sequence)
+    {
+        using Kept = TypeInspect::RemoveCVR<SeqT>;
+
+        constexpr bool IS_CONTAINER = !Fused::EnsureIsPipeline<Kept> && !Fused::IS_IENUMERABLE<Kept>;
+
+        if constexpr (IS_CONTAINER && std::is_lvalue_reference_v<SeqT>)
+        {
+            return borrow(sequence);
+        }
+        else
         {
-            accum += elem;
+            return Kept(std::move(sequence));
         }
+    }
+
+    // Number of values `Seq::range` produces. The distance is computed unsigned so it cannot overflow for signed types.
+    template<typename T>
+    auto rangeLength(T inclusiveMin, T exclusiveMax, T step) -> std::size_t
+    {
+        using U = std::make_unsigned_t<T>;
 
-        return accum;
+        if (step > 0 ? inclusiveMin >= exclusiveMax : inclusiveMin <= exclusiveMax)
+        {
+            return 0;
+        }
+
+        const U distance = step > 0 ? static_cast<U>(exclusiveMax) - static_cast<U>(inclusiveMin)
+                                    : static_cast<U>(inclusiveMin) - static_cast<U>(exclusiveMax);
+        const U stride   = step > 0 ? static_cast<U>(step) : static_cast<U>(U{0} - static_cast<U>(step));
+
+        return static_cast<std::size_t>(distance / stride + (distance % stride != 0 ? 1 : 0));
     }
 
     template<typename T>
@@ -48,22 +113,126 @@ namespace Seq::_internal
         }
     }
 
-    template<bool DiscardCompareProperty = false, typename T, typename U = T, typename Compare>
-    auto sortElementsBy(IEnumerable<T> sequence, Compare comp) -> IEnumerable<U>
+    template<typename T>
+    auto pairElements(IEnumerable<T> sequence) -> IEnumerable<std::pair<T, T>>
     {
-        std::vector<T> buffer{sequence.begin(), sequence.end()};
-        std::sort(buffer.begin(), buffer.end(), comp);
+        std::optional<T> previousElem;
 
-        for (const auto& elem : buffer)
+        for (const auto& elem : sequence)
+        {
+            if (previousElem.has_value())
+            {
+                co_yield std::make_pair(*previousElem, elem);
+            }
+
+            previousElem = elem;
+        }
+    }
+
+    template<typename T>
+    auto pairElementsWrapped(IEnumerable<T> sequence) -> IEnumerable<std::pair<T, T>>
+    {
+        bool atLeastOnePair = false;
+        std::optional<T> firstElem;
+        std::optional<T> previousElem;
+
+        for (const auto& elem : sequence)
         {
-            if constexpr (DiscardCompareProperty)
+            if (previousElem.has_value())
             {
-                co_yield std::get<0>(elem);
+                atLeastOnePair = true;
+                co_yield std::make_pair(*previousElem, elem);
             }
             else
             {
-                co_yield elem;
+                firstElem = elem;
             }
+
+            previousElem = elem;
+        }
+
+        if (atLeastOnePair)
+        {
+            co_yield std::make_pair(*previousElem, *firstElem);
+        }
+    }
+
+    // Parameter keyOf has signature `(T) -> Key` and selects what the buffered elements are compared by.
+    template<SortBackend Backend, bool Descending, typename T, typename KeyOf>
+    auto sortElementsBy(IEnumerable<T> sequence, KeyOf keyOf) -> IEnumerable<T>
+    {
+        std::vector<T> buffer;
+
+        if (const SizeHint hint = sequence.sizeHint(); hint.isExact())
+        {
+            buffer.reserve(hint.size());
+        }
+
+        buffer.insert(buffer.end(), sequence.begin(), sequence.end());
+        Sorting::IncrementalSort<Backend, Descending, T, KeyOf> sorter(buffer, keyOf);
+
+        for (std::size_t idx = 0; idx < buffer.size(); ++idx)
+        {
+            co_yield sorter.at(idx);
+        }
+    }
+
+    // Keeps the best elements seen so far in a heap with the worst of them on top, so every other element is only
+    // compared against that one. Elements with equal keys are ranked by their position in the sequence.
+    // Parameter mapping has signature `(T) -> Key`.
+    template<typename T, typename Mapping>
+    auto topElementsBy(IEnumerable<T> sequence, std::size_t count, Mapping mapping) -> IEnumerable<T>
+    {
+        using Key = std::remove_cvref_t<std::invoke_result_t<Mapping&, const T&>>;
+
+        struct Candidate
+        {
+            Key key;
+            std::size_t position;
+            T elem;
+        };
+
+        const auto isBetter = [](const Candidate& lhs, const Candidate& rhs) -> bool
+        {
+            return rhs.key < lhs.key || (!(lhs.key < rhs.key) && lhs.position < rhs.position);
+        };
+
+        if (count == 0)
+        {
+            co_return;
+        }
+
+        std::vector<Candidate> heap;
+
+        if (const SizeHint hint = sequence.sizeHint(); hint.isBounded())
+        {
+            heap.reserve(std::min(count, hint.size()));
+        }
+
+        std::size_t position = 0;
+
+        for (const T& elem : sequence)
+        {
+            if (heap.size() < count)
+            {
+                heap.push_back(Candidate{mapping(elem), position, elem});
+                std::push_heap(heap.begin(), heap.end(), isBetter);
+            }
+            else if (Key key = mapping(elem); heap.front().key < key)
+            {
+                std::pop_heap(heap.begin(), heap.end(), isBetter);
+                heap.back() = Candidate{std::move(key), position, elem};
+                std::push_heap(heap.begin(), heap.end(), isBetter);
+            }
+
+            ++position;
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), isBetter);
+
+        for (const Candidate& candidate : heap)
+        {
+            co_yield candidate.elem;
         }
     }
 }
@@ -0,0 +1,428 @@
+// ┏━━━━━━━━━━━━━━━━━━━━┓
+// ┃ set_operations.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━━┛
+// `Seq::intersect`, `Seq::except` and `Seq::unionWith` treat both of their sequences as sets, so every element comes
+// out at most once. By default the argument is indexed in a `FlatHash::FlatIndex` and the input is streamed against
+// it, which works for elements in any order and keeps the order of the input. Sequences that are known to be sorted in
+// ascending order on both sides, e.g. straight out of `Seq::sort`, are merged instead. Both are walked in lockstep
+// without any table and duplicates are recognized by comparing an element with the previous one. `Seq::except` checks
+// a Bloom filter before it probes the index of a large argument. The filter is a fraction of the size of the index and
+// mostly stays in cache, so elements that are not excluded rarely have to touch the index at all.
+#pragma once
+#include "flat_hash.hpp"
+#include "fused.hpp"
+#include "grouping.hpp"
+#include "ienumerable.hpp"
+#include "seq_helper.hpp"
+#include "size_hint.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq
+{
+    // Algorithm used by the set operators (`Seq::intersect`, `Seq::except` and `Seq::unionWith`).
+    // - `AUTO` picks `MERGE` if both sequences are known to be sorted in ascending order and `HASH` otherwise.
+    //   Sequences are known to be sorted after `Seq::sort`, after `Seq::range` counting upwards and after operators
+    //   that only drop elements from those, like `Seq::filter` or `Seq::take`.
+    // - `HASH` indexes the argument in a hash table. Results keep the order of the input.
+    // - `MERGE` walks both sequences in lockstep. Both have to be sorted in ascending order and so are the results.
+    enum class SetStrategy
+    {
+        AUTO,
+        HASH,
+        MERGE,
+    };
+}
+
+namespace Seq::_internal::SetOps
+{
+    enum class Operation
+    {
+        INTERSECT,
+        EXCEPT,
+        UNION,
+    };
+
+    // Arguments of `Seq::except` with this many distinct elements get a Bloom filter.
+    constexpr std::size_t BLOOM_THRESHOLD = std::size_t{1} << 16;
+
+    // Size of the Bloom filter per element, which keeps false positives well below one percent.
+    constexpr std::size_t BLOOM_BITS_PER_KEY = 16;
+
+    // A blocked Bloom filter, all bits of an element are in the same 64-bit word. A check is a single memory access.
+    class BloomFilter
+    {
+    private:
+        static constexpr int BITS_PER_ELEMENT = 4;
+
+        // Bit positions come from the middle of the scrambled hash, the word is picked by its high bits.
+        static constexpr int FIRST_POSITION_BIT = 16;
+        static constexpr int POSITION_WIDTH     = 6;
+
+        std::vector<std::uint64_t> words;
+        int shift = 0;
+
+        static auto bitsOf(std::uint64_t scrambled) -> std::uint64_t
+        {
+            std::uint64_t bits = 0;
+
+            for (int idx = 0; idx < BITS_PER_ELEMENT; ++idx)
+            {
+                bits |= std::uint64_t{1} << ((scrambled >> (FIRST_POSITION_BIT + idx * POSITION_WIDTH)) & 63);
+            }
+
+            return bits;
+        }
+
+        auto wordOf(std::uint64_t scrambled) const -> std::size_t
+        {
+            return static_cast<std::size_t>(scrambled >> shift);
+        }
+
+    public:
+        // Parameter scrambledHashes holds the hashes of every element, see `FlatHash::scramble`.
+        explicit BloomFilter(std::span<const std::uint64_t> scrambledHashes)
+        {
+            const std::size_t wanted = scrambledHashes.size() * BLOOM_BITS_PER_KEY / 64;
+            const std::size_t count  = std::bit_ceil(std::max<std::size_t>(wanted, 2));
+
+            words.assign(count, 0);
+            shift = 64 - std::countr_zero(count);
+
+            for (const std::uint64_t scrambled : scrambledHashes)
+            {
+                words[wordOf(scrambled)] |= bitsOf(scrambled);
+            }
+        }
+
+        // False means that the element was definitely not added, true that it most likely was.
+        bool mayContain(std::uint64_t scrambled) const
+        {
+            const std::uint64_t bits = bitsOf(scrambled);
+            return (words[wordOf(scrambled)] & bits) == bits;
+        }
+    };
+
+    template<typename T, typename Hash, typename Sequence>
+    auto indexElements(Sequence& sequence, const Hash& hash) -> FlatHash::FlatIndex<T, Hash>
+    {
+        FlatHash::FlatIndex<T, Hash> index(hash);
+        Grouping::presize(index, hintOf(sequence));
+
+        Fused::forEach(sequence,
+                       [&index]<typename Elem>(Elem&& elem) -> bool
+                       {
+                           index.insert(std::forward<Elem>(elem));
+                           return true;
+                       });
+
+        return index;
+    }
+
+    // Merging walks two sequences at once, so pipelines are pulled one element at a time.
+    template<typename Sequence>
+    auto pullable(Sequence sequence)
+    {
+        if constexpr (Fused::EnsureIsPipeline<Sequence>)
+        {
+            return IEnumerable<typename Sequence::Item>(std::move(sequence));
+        }
+        else
+        {
+            return sequence;
+        }
+    }
+
+    template<typename T, typename Other, typename Hash>
+    auto intersectHashed(IEnumerable<T> sequence, Other other, Hash hash) -> IEnumerable<T>
+    {
+        const FlatHash::FlatIndex<T, Hash> shared = indexElements<T>(other, hash);
+
+        std::vector<bool> yielded(shared.size(), false);
+        std::size_t remaining = shared.size();
+
+        for (const T& elem : sequence)
+        {
+            // Every shared element came out already, nothing else can match
+            if (remaining == 0)
+            {
+                co_return;
+            }
+
+            const std::optional<std::size_t> found = shared.find(elem, FlatHash::scramble(hash(elem)));
+
+            if (found.has_value() && !yielded[*found])
+            {
+                yielded[*found] = true;
+                --remaining;
+
+                co_yield elem;
+            }
+        }
+    }
+
+    template<typename T, typename Other, typename Hash>
+    auto exceptHashed(IEnumerable<T> sequence, Other other, Hash hash) -> IEnumerable<T>
+    {
+        const FlatHash::FlatIndex<T, Hash> excluded = indexElements<T>(other, hash);
+
+        std::optional<BloomFilter> filter;
+
+        if (excluded.size() >= BLOOM_THRESHOLD)
+        {
+            filter.emplace(excluded.scrambledHashes());
+        }
+
+        FlatHash::FlatIndex<T, Hash> seen(hash);
+
+        for (const T& elem : sequence)
+        {
+            const std::uint64_t scrambled = FlatHash::scramble(hash(elem));
+            const bool mayBeExcluded      = !filter.has_value() || filter->mayContain(scrambled);
+
+            if (mayBeExcluded && excluded.find(elem, scrambled).has_value())
+            {
+                continue;
+            }
+
+            if (seen.insert(elem, scrambled).second)
+            {
+                co_yield elem;
+            }
+        }
+    }
+
+    template<typename T, typename Other, typename Hash>
+    auto unionHashed(IEnumerable<T> sequence, Other other, Hash hash) -> IEnumerable<T>
+    {
+        FlatHash::FlatIndex<T, Hash> seen(hash);
+        Grouping::presize(seen, sequence.sizeHint());
+
+        for (const T& elem : sequence)
+        {
+            if (seen.insert(elem).second)
+            {
+                co_yield elem;
+            }
+        }
+
+        const auto rest = pullable(std::move(other));
+
+        for (const T& elem : rest)
+        {
+            if (seen.insert(elem).second)
+            {
+                co_yield elem;
+            }
+        }
+    }
+
+    // Both sequences are sorted, so duplicates of an element follow right after it.
+    template<typename T, typename Other>
+    auto intersectMerged(IEnumerable<T> sequence, Other other) -> IEnumerable<T>
+    {
+        const auto right    = pullable(std::move(other));
+        auto rightIt        = right.begin();
+        const auto rightEnd = right.end();
+
+        std::optional<T> previous;
+
+        for (const T& elem : sequence)
+        {
+            while (rightIt != rightEnd && *rightIt < elem)
+            {
+                ++rightIt;
+            }
+
+            // Nothing else can match once the argument is exhausted
+            if (!(rightIt != rightEnd))
+            {
+                co_return;
+            }
+
+            const bool isShared = !(elem < *rightIt);
+
+            if (isShared && (!previous.has_value() || *previous < elem))
+            {
+                previous = elem;
+                co_yield elem;
+            }
+        }
+    }
+
+    template<typename T, typename Other>
+    auto exceptMerged(IEnumerable<T> sequence, Other other) -> IEnumerable<T>
+    {
+        const auto right    = pullable(std::move(other));
+        auto rightIt        = right.begin();
+        const auto rightEnd = right.end();
+
+        std::optional<T> previous;
+
+        for (const T& elem : sequence)
+        {
+            while (rightIt != rightEnd && *rightIt < elem)
+            {
+                ++rightIt;
+            }
+
+            const bool isExcluded = rightIt != rightEnd && !(elem < *rightIt);
+
+            if (!isExcluded && (!previous.has_value() || *previous < elem))
+            {
+                previous = elem;
+                co_yield elem;
+            }
+        }
+    }
+
+    template<typename T, typename Other>
+    auto unionMerged(IEnumerable<T> sequence, Other other) -> IEnumerable<T>
+    {
+        const auto right    = pullable(std::move(other));
+        auto rightIt        = right.begin();
+        const auto rightEnd = right.end();
+
+        auto leftIt        = sequence.begin();
+        const auto leftEnd = sequence.end();
+
+        std::optional<T> previous;
+
+        while (leftIt != leftEnd || rightIt != rightEnd)
+        {
+            // Equal elements are taken from the input first
+            const bool isLeft = !(rightIt != rightEnd) || (leftIt != leftEnd && !(*rightIt < *leftIt));
+            const T& elem     = isLeft ? *leftIt : *rightIt;
+
+            if (!previous.has_value() || *previous < elem)
+            {
+                previous = elem;
+                co_yield elem;
+            }
+
+            if (isLeft)
+            {
+                ++leftIt;
+            }
+            else
+            {
+                ++rightIt;
+            }
+        }
+    }
+
+    template<typename T>
+    concept EnsureIsOrdered = requires(const T& lhs, const T& rhs) {
+        { lhs < rhs } -> std::convertible_to<bool>;
+    };
+
+    // The operator behind `Seq::intersect`, `Seq::except` and `Seq::unionWith`.
+    template<Operation Op, SetStrategy Strategy, typename Other, typename Hash>
+    class SetOperation
+    {
+    private:
+        Other other;
+        Hash hash;
+
+        template<typename T>
+        auto merged(IEnumerable<T> sequence, Other kept) const -> IEnumerable<T>
+        {
+            const SizeHint hint = sequence.sizeHint();
+
+            if constexpr (Op == Operation::INTERSECT)
+            {
+                return intersectMerged(std::move(sequence), std::move(kept)).withSizeHint(hint.subsequence());
+            }
+            else if constexpr (Op == Operation::EXCEPT)
+            {
+                return exceptMerged(std::move(sequence), std::move(kept)).withSizeHint(hint.subsequence());
+            }
+            else
+            {
+                const SizeHint combined = hint.combinedWith(hintOf(kept)).sortedAscending();
+                return unionMerged(std::move(sequence), std::move(kept)).withSizeHint(combined);
+            }
+        }
+
+        template<typename T>
+        auto hashed(IEnumerable<T> sequence, Other kept) const -> IEnumerable<T>
+        {
+            const SizeHint hint = sequence.sizeHint();
+
+            if constexpr (Op == Operation::INTERSECT)
+            {
+                return intersectHashed(std::move(sequence), std::move(kept), hash).withSizeHint(hint.subsequence());
+            }
+            else if constexpr (Op == Operation::EXCEPT)
+            {
+                return exceptHashed(std::move(sequence), std::move(kept), hash).withSizeHint(hint.subsequence());
+            }
+            else
+            {
+                const SizeHint combined = hint.combinedWith(hintOf(kept));
+                return unionHashed(std::move(sequence), std::move(kept), hash).withSizeHint(combined);
+            }
+        }
+
+        template<typename T>
+        auto combineWith(IEnumerable<T> sequence, Other kept) const -> IEnumerable<T>
+        {
+            static_assert(std::is_same_v<Fused::ItemOf<Other>, T>, "Set operators need elements of the same type");
+            static_assert(Strategy != SetStrategy::MERGE || EnsureIsOrdered<T>,
+                          "SetStrategy::MERGE needs elements that are comparable with `<`");
+
+            if constexpr (Strategy == SetStrategy::MERGE)
+            {
+                return merged(std::move(sequence), std::move(kept));
+            }
+            else if constexpr (Strategy == SetStrategy::HASH || !EnsureIsOrdered<T>)
+            {
+                return hashed(std::move(sequence), std::move(kept));
+            }
+            else
+            {
+                if (sequence.sizeHint().isAscending() && hintOf(kept).isAscending())
+                {
+                    return merged(std::move(sequence), std::move(kept));
+                }
+
+                return hashed(std::move(sequence), std::move(kept));
+            }
+        }
+
+    public:
+        SetOperation(Other other, Hash hash)
+            : other(std::move(other))
+            , hash(std::move(hash))
+        {
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const& -> IEnumerable<T>
+        {
+            return combineWith(std::move(sequence), other);
+        }
+
+        // Arguments that cannot be copied, like an `IEnumerable<T>`, can only be combined this way once.
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) && -> IEnumerable<T>
+        {
+            return combineWith(std::move(sequence), std::move(other));
+        }
+    };
+
+    template<Operation Op, SetStrategy Strategy, typename Other, typename Hash>
+    inline auto makeSetOperation(Other&& other, Hash hash)
+    {
+        using Kept = decltype(keepArgument(std::forward<Other>(other)));
+        return SetOperation<Op, Strategy, Kept, Hash>(keepArgument(std::forward<Other>(other)), std::move(hash));
+    }
+}
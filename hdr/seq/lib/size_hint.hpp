@@ -0,0 +1,163 @@
+// ┏━━━━━━━━━━━━━━━┓
+// ┃ size_hint.hpp ┃
+// ┗━━━━━━━━━━━━━━━┛
+// A `SizeHint` travels along with a sequence and tells what is known about its length without iterating it. The length
+// is either exact, an upper bound or unknown. Sinks use it to reserve memory up front and `Seq::length` or
+// `Seq::isEmpty` can answer in constant time when the length is exact. It also records whether the elements are known
+// to come in ascending order, which lets the set operators merge sorted sequences instead of hashing them.
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+
+namespace Seq::_internal
+{
+    enum class Cardinality
+    {
+        UNKNOWN,
+        UPPER_BOUND,
+        EXACT,
+    };
+
+    class SizeHint
+    {
+    private:
+        std::size_t count       = 0;
+        Cardinality cardinality = Cardinality::UNKNOWN;
+        bool ascending          = false;
+
+        SizeHint(std::size_t count, Cardinality cardinality)
+            : count(count)
+            , cardinality(cardinality)
+        {
+        }
+
+        // Carries the order of the elements over, for operators that leave the remaining elements in place.
+        auto keepingOrder(SizeHint hint) const -> SizeHint
+        {
+            hint.ascending = ascending;
+            return hint;
+        }
+
+    public:
+        SizeHint() = default;
+
+        static auto exact(std::size_t count) -> SizeHint { return {count, Cardinality::EXACT}; }
+
+        static auto upperBound(std::size_t count) -> SizeHint { return {count, Cardinality::UPPER_BOUND}; }
+
+        bool isExact() const { return cardinality == Cardinality::EXACT; }
+
+        bool isBounded() const { return cardinality != Cardinality::UNKNOWN; }
+
+        // Every element is less than or equal to the next one.
+        bool isAscending() const { return ascending; }
+
+        // Exact length or upper bound, only meaningful if the hint is bounded.
+        std::size_t size() const { return count; }
+
+        // ┏━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┓
+        // ┃ How operators transform their input ┃
+        // ┗━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━┛
+        // One output element for every input element (e.g. `Seq::map` or `Seq::sort`).
+        auto elementwise() const -> SizeHint { return {count, cardinality}; }
+
+        // The same elements in the same order (e.g. a pipeline pulled element-wise).
+        auto detached() const -> SizeHint { return keepingOrder(elementwise()); }
+
+        // The same elements in ascending order (e.g. `Seq::sort`).
+        auto sortedAscending() const -> SizeHint
+        {
+            SizeHint hint  = elementwise();
+            hint.ascending = true;
+            return hint;
+        }
+
+        // At most one output element for every input element (e.g. `Seq::filter`).
+        auto filtered() const -> SizeHint { return isBounded() ? SizeHint::upperBound(count) : SizeHint(); }
+
+        // Some of the input elements in their original order (e.g. `Seq::filter` or `Seq::distinct`).
+        auto subsequence() const -> SizeHint { return keepingOrder(filtered()); }
+
+        // Elements of two sequences, at most as many as both have together (e.g. `Seq::unionWith`).
+        auto combinedWith(const SizeHint& other) const -> SizeHint
+        {
+            if (!isBounded() || !other.isBounded())
+            {
+                return {};
+            }
+
+            return SizeHint::upperBound(count + other.count);
+        }
+
+        auto takeFirst(std::size_t limit) const -> SizeHint
+        {
+            if (!isBounded())
+            {
+                return keepingOrder(SizeHint::upperBound(limit));
+            }
+
+            return keepingOrder({std::min(count, limit), cardinality});
+        }
+
+        auto skipFirst(std::size_t skipped) const -> SizeHint
+        {
+            if (!isBounded())
+            {
+                return keepingOrder({});
+            }
+
+            return keepingOrder({count - std::min(count, skipped), cardinality});
+        }
+
+        auto chunked(std::size_t chunkSize) const -> SizeHint
+        {
+            if (chunkSize == 0)
+            {
+                return {};
+            }
+
+            return {count / chunkSize + (count % chunkSize != 0 ? 1 : 0), cardinality};
+        }
+
+        // Every run of `windowSize` consecutive elements.
+        auto windows(std::size_t windowSize) const -> SizeHint
+        {
+            if (windowSize == 0 || count < windowSize)
+            {
+                return {0, cardinality};
+            }
+
+            return {count - windowSize + 1, cardinality};
+        }
+
+        // Pairs of consecutive elements, optionally with an extra pair wrapping around.
+        auto paired(bool wrapAround) const -> SizeHint
+        {
+            if (count < 2)
+            {
+                return {0, cardinality};
+            }
+
+            return {wrapAround ? count : count - 1, cardinality};
+        }
+    };
+
+    // Sequences either carry their own hint or are containers that might know their size.
+    template<typename Sequence>
+    inline auto hintOf(const Sequence& sequence) -> SizeHint
+    {
+        if constexpr (requires { sequence.sizeHint(); })
+        {
+            return sequence.sizeHint();
+        }
+        else if constexpr (std::ranges::sized_range<const Sequence>)
+        {
+            return SizeHint::exact(std::ranges::size(sequence));
+        }
+        else
+        {
+            return {};
+        }
+    }
+}
@@ -0,0 +1,422 @@
+// ┏━━━━━━━━━━━━━━━━━━━┓
+// ┃ sort_backends.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━━━┛
+// The sort family (`Seq::sort`, `Seq::sortBy` and their descending variants) buffers the sequence and then hands the
+// buffer to one of these backends. Arithmetic keys go through an LSD radix sort, which needs a handful of linear passes
+// over the buffer instead of O(n log n) comparisons. Other keys of large inputs are sorted by a parallel merge sort on
+// the thread pool, everything else by `std::sort`. The choice can be forced through the `Backend` template parameter.
+// Elements are put into place as they are pulled, so a consumer that stops early skips most of the work.
+#pragma once
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Seq
+{
+    // Algorithm used by the sort family.
+    // - `AUTO` picks `RADIX` for arithmetic keys, `PARALLEL` for other large inputs and `STANDARD` otherwise.
+    // - `STANDARD` is a single-threaded `std::sort`.
+    // - `PARALLEL` sorts slices of the buffer on multiple threads, then merges them pairwise.
+    // - `RADIX` is a stable LSD radix sort, only available if the key is an integral or floating-point type. To stay
+    //   stable it always sorts the whole buffer up front instead of incrementally.
+    enum class SortBackend
+    {
+        AUTO,
+        STANDARD,
+        PARALLEL,
+        RADIX,
+    };
+}
+
+namespace Seq::_internal::Sorting
+{
+    // Radix sort is only chosen automatically from this many elements on, below the histograms do not pay off.
+    constexpr std::size_t RADIX_THRESHOLD = 1024;
+
+    // Parallel sort is only chosen automatically from this many elements on.
+    constexpr std::size_t PARALLEL_THRESHOLD = std::size_t{1} << 16;
+
+    // Slices of a parallel sort are never shorter than this.
+    constexpr std::size_t MIN_SLICE = 4096;
+
+    // Partitions of an incremental sort up to this length are sorted in one go.
+    constexpr std::size_t SMALL_PARTITION = 32;
+
+    // An incremental sort hands the rest of the buffer to the backend once this share of it has been requested.
+    constexpr std::size_t EAGER_SHARE = 8;
+
+    // Keys of 1, 2, 4 or 8 bytes, floating-point ones in IEEE 754 format.
+    template<typename Key>
+    concept EnsureIsRadixKey = std::is_arithmetic_v<Key>
+                               && (sizeof(Key) == 1 || sizeof(Key) == 2 || sizeof(Key) == 4 || sizeof(Key) == 8)
+                               && (!std::is_floating_point_v<Key> || std::numeric_limits<Key>::is_iec559);
+
+    template<std::size_t Size>
+    struct UnsignedOfSize;
+
+    template<>
+    struct UnsignedOfSize<1>
+    {
+        using Type = std::uint8_t;
+    };
+
+    template<>
+    struct UnsignedOfSize<2>
+    {
+        using Type = std::uint16_t;
+    };
+
+    template<>
+    struct UnsignedOfSize<4>
+    {
+        using Type = std::uint32_t;
+    };
+
+    template<>
+    struct UnsignedOfSize<8>
+    {
+        using Type = std::uint64_t;
+    };
+
+    template<typename Key>
+    using RadixBits = typename UnsignedOfSize<sizeof(Key)>::Type;
+
+    // Maps a key to an unsigned integer with the same ordering. Negative values of signed integers and floats sort
+    // below the positive ones once their sign bit is flipped, negative floats also need their remaining bits flipped.
+    template<EnsureIsRadixKey Key>
+    inline auto toRadixBits(Key key) -> RadixBits<Key>
+    {
+        using Bits              = RadixBits<Key>;
+        constexpr Bits SIGN_BIT = Bits{1} << (std::numeric_limits<Bits>::digits - 1);
+
+        const Bits bits = std::bit_cast<Bits>(key);
+
+        if constexpr (std::is_floating_point_v<Key>)
+        {
+            return (bits & SIGN_BIT) != 0 ? static_cast<Bits>(~bits) : static_cast<Bits>(bits | SIGN_BIT);
+        }
+        else if constexpr (std::is_signed_v<Key>)
+        {
+            return static_cast<Bits>(bits ^ SIGN_BIT);
+        }
+        else
+        {
+            return bits;
+        }
+    }
+
+    // Stable LSD radix sort on 8-bit digits. All histograms are counted in a single pass up front and digits that are
+    // the same for every element are skipped, so small keys in wide types only cost as many passes as they need.
+    template<bool Descending, typename T, typename KeyOf>
+    inline void radixSort(std::span<T> items, KeyOf keyOf)
+    {
+        using Key  = std::remove_cvref_t<std::invoke_result_t<KeyOf, const T&>>;
+        using Bits = RadixBits<Key>;
+
+        constexpr std::size_t DIGITS = sizeof(Bits);
+        constexpr std::size_t RADIX  = 256;
+
+        const auto bitsOf = [&keyOf](const T& item) -> Bits
+        {
+            const Bits bits = toRadixBits(keyOf(item));
+            return Descending ? static_cast<Bits>(~bits) : bits;
+        };
+
+        std::vector<std::array<std::size_t, RADIX>> histograms(DIGITS);
+
+        for (const T& item : items)
+        {
+            const Bits bits = bitsOf(item);
+
+            for (std::size_t digit = 0; digit < DIGITS; ++digit)
+            {
+                ++histograms[digit][(bits >> (digit * 8)) & 0xFF];
+            }
+        }
+
+        std::vector<T> scratch;
+        scratch.reserve(items.size());
+
+        if constexpr (std::is_default_constructible_v<T>)
+        {
+            scratch.resize(items.size());
+        }
+
+        // Passes scatter back and forth between the two buffers
+        std::span<T> from = items;
+        std::span<T> to   = scratch;
+
+        for (std::size_t digit = 0; digit < DIGITS; ++digit)
+        {
+            std::array<std::size_t, RADIX>& counts = histograms[digit];
+
+            if (std::ranges::any_of(counts, [&items](std::size_t count) { return count == items.size(); }))
+            {
+                continue;
+            }
+
+            std::array<std::size_t, RADIX> offsets{};
+
+            for (std::size_t bucket = 1; bucket < RADIX; ++bucket)
+            {
+                offsets[bucket] = offsets[bucket - 1] + counts[bucket - 1];
+            }
+
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+                for (T& item : from)
+                {
+                    to[offsets[(bitsOf(item) >> (digit * 8)) & 0xFF]++] = std::move(item);
+                }
+
+                std::swap(from, to);
+            }
+            else
+            {
+                // Without a default constructor the items are scattered through an index permutation instead
+                std::vector<std::size_t> sources(items.size());
+
+                for (std::size_t idx = 0; idx < items.size(); ++idx)
+                {
+                    sources[offsets[(bitsOf(items[idx]) >> (digit * 8)) & 0xFF]++] = idx;
+                }
+
+                scratch.clear();
+
+                for (const std::size_t idx : sources)
+                {
+                    scratch.push_back(std::move(items[idx]));
+                }
+
+                std::move(scratch.begin(), scratch.end(), items.begin());
+            }
+        }
+
+        if (from.data() != items.data())
+        {
+            std::move(from.begin(), from.end(), items.begin());
+        }
+    }
+
+    // Sorts slices of the buffer in parallel, then merges neighboring slices in rounds until one is left.
+    template<typename T, typename Compare>
+    inline void parallelSort(std::span<T> items, Compare comp)
+    {
+        ThreadPool& pool = ThreadPool::withThreads(0);
+
+        const std::size_t maxSlices = std::max<std::size_t>(items.size() / MIN_SLICE, 1);
+        const std::size_t slices    = std::min(std::bit_ceil(pool.concurrency()), maxSlices);
+        const std::size_t width     = (items.size() + slices - 1) / slices;
+
+        const auto boundary = [&items, width](std::size_t slice) -> std::ptrdiff_t
+        {
+            return static_cast<std::ptrdiff_t>(std::min(items.size(), slice * width));
+        };
+
+        pool.parallelFor(slices,
+                         [&items, &comp, &boundary](std::size_t slice)
+                         {
+                             std::sort(items.begin() + boundary(slice), items.begin() + boundary(slice + 1), comp);
+                         });
+
+        for (std::size_t merged = 1; merged < slices; merged *= 2)
+        {
+            pool.parallelFor((slices + 2 * merged - 1) / (2 * merged),
+                             [&items, &comp, &boundary, merged](std::size_t pair)
+                             {
+                                 const std::size_t first = pair * 2 * merged;
+                                 std::inplace_merge(items.begin() + boundary(first),
+                                                    items.begin() + boundary(first + merged),
+                                                    items.begin() + boundary(first + 2 * merged),
+                                                    comp);
+                             });
+        }
+    }
+
+    template<bool Descending, typename T, typename KeyOf>
+    inline auto comparatorOf(const KeyOf& keyOf)
+    {
+        return [&keyOf](const T& lhs, const T& rhs) -> bool
+        {
+            if constexpr (Descending)
+            {
+                return keyOf(rhs) < keyOf(lhs);
+            }
+            else
+            {
+                return keyOf(lhs) < keyOf(rhs);
+            }
+        };
+    }
+
+    // Sorts the buffer by the key every element maps to.
+    template<SortBackend Backend, bool Descending, typename T, typename KeyOf>
+    inline void sortBuffer(std::span<T> items, KeyOf keyOf)
+    {
+        using Key = std::remove_cvref_t<std::invoke_result_t<KeyOf, const T&>>;
+
+        const auto comp = comparatorOf<Descending, T>(keyOf);
+
+        if constexpr (Backend == SortBackend::RADIX)
+        {
+            static_assert(EnsureIsRadixKey<Key>, "SortBackend::RADIX only supports integral and floating-point keys");
+            radixSort<Descending>(items, keyOf);
+        }
+        else if constexpr (Backend == SortBackend::PARALLEL)
+        {
+            parallelSort(items, comp);
+        }
+        else if constexpr (Backend == SortBackend::STANDARD)
+        {
+            std::sort(items.begin(), items.end(), comp);
+        }
+        else if constexpr (EnsureIsRadixKey<Key>)
+        {
+            if (items.size() >= RADIX_THRESHOLD)
+            {
+                radixSort<Descending>(items, keyOf);
+            }
+            else
+            {
+                std::sort(items.begin(), items.end(), comp);
+            }
+        }
+        else
+        {
+            if (items.size() >= PARALLEL_THRESHOLD && ThreadPool::withThreads(0).concurrency() > 1)
+            {
+                parallelSort(items, comp);
+            }
+            else
+            {
+                std::sort(items.begin(), items.end(), comp);
+            }
+        }
+    }
+
+    // Puts the elements of a buffer into place only once they are requested, so a consumer that stops after the first
+    // k elements pays O(n + k log k) instead of a full sort. Every step partitions the unsorted part in front around a
+    // pivot like quicksort, but only keeps on splitting the partition the next position falls into (incremental
+    // quicksort). A consumer that got through a good share of the buffer most likely wants all of it, so from there on
+    // the rest is sorted by the backend in one go. Radix sort does the whole buffer up front to stay stable.
+    template<SortBackend Backend, bool Descending, typename T, typename KeyOf>
+    class IncrementalSort
+    {
+    private:
+        std::span<T> items;
+        KeyOf keyOf;
+
+        // Elements before this position are in their final place
+        std::size_t ready = 0;
+
+        // Ends of the partitions that still need sorting, the nearest one on top. Elements of a partition are never
+        // ordered before any element of an earlier partition.
+        std::vector<std::size_t> bounds;
+
+        void sortRemaining()
+        {
+            sortBuffer<Backend, Descending>(items.subspan(ready), keyOf);
+            ready = items.size();
+            bounds.clear();
+        }
+
+        void step()
+        {
+            if (Backend == SortBackend::RADIX || ready >= items.size() / EAGER_SHARE)
+            {
+                sortRemaining();
+                return;
+            }
+
+            const auto comp        = comparatorOf<Descending, T>(keyOf);
+            const std::size_t last = bounds.back();
+            const auto first       = items.begin() + static_cast<std::ptrdiff_t>(ready);
+            const auto end         = items.begin() + static_cast<std::ptrdiff_t>(last);
+
+            if (last - ready <= SMALL_PARTITION)
+            {
+                std::sort(first, end, comp);
+                ready = last;
+                bounds.pop_back();
+                return;
+            }
+
+            // Median of three as pivot, moved to the front of the partition
+            const auto middle = first + (end - first) / 2;
+            const auto back   = end - 1;
+
+            if (comp(*middle, *first))
+            {
+                std::iter_swap(middle, first);
+            }
+
+            if (comp(*back, *middle))
+            {
+                std::iter_swap(back, middle);
+            }
+
+            if (comp(*middle, *first))
+            {
+                std::iter_swap(middle, first);
+            }
+
+            std::iter_swap(first, middle);
+
+            // Three-way partition, so runs of equal elements are done in a single step
+            const T& pivot    = *first;
+            const auto less   = std::partition(first + 1, end, [&](const T& item) { return comp(item, pivot); });
+            const auto higher = std::partition(less, end, [&](const T& item) { return !comp(pivot, item); });
+            std::iter_swap(first, less - 1);
+
+            const auto lowerEnd = static_cast<std::size_t>(less - 1 - items.begin());
+            const auto equalEnd = static_cast<std::size_t>(higher - items.begin());
+
+            if (equalEnd < last)
+            {
+                bounds.push_back(equalEnd);
+            }
+
+            if (lowerEnd > ready)
+            {
+                bounds.push_back(lowerEnd);
+            }
+            else
+            {
+                ready = equalEnd;
+                bounds.pop_back();
+            }
+        }
+
+    public:
+        IncrementalSort(std::span<T> items, KeyOf keyOf)
+            : items(items)
+            , keyOf(std::move(keyOf))
+        {
+            if (!items.empty())
+            {
+                bounds.push_back(items.size());
+            }
+        }
+
+        // Returns the element that belongs to the position. Positions have to be requested in ascending order.
+        auto at(std::size_t position) -> T&
+        {
+            while (ready <= position)
+            {
+                step();
+            }
+
+            return items[position];
+        }
+    };
+}
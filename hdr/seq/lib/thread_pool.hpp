@@ -0,0 +1,304 @@
+// ┏━━━━━━━━━━━━━━━━━┓
+// ┃ thread_pool.hpp ┃
+// ┗━━━━━━━━━━━━━━━━━┛
+// A work-stealing thread pool behind the parallel operators of the library. Every worker owns a queue of tasks. It
+// takes the newest task of its own queue first and steals the oldest task of another queue once its own runs dry.
+// Parallel loops split their index range in halves and queue one half while working on the other, so stolen tasks
+// are always the largest pieces of work left. The thread waiting for a loop to finish helps out by running queued
+// tasks, which also makes it safe to start a parallel loop from inside another one.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Seq::_internal
+{
+    // Data written by different threads is kept this far apart, so the threads do not invalidate each other's caches.
+    // It is not `std::hardware_destructive_interference_size`, which may differ between translation units.
+    constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // Shared state of a running `parallelFor`, owned by the thread waiting for it.
+        struct Loop
+        {
+            std::atomic<std::size_t> remaining;
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+
+            explicit Loop(std::size_t count)
+                : remaining(count)
+            {
+            }
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+        std::atomic<std::size_t> queued{0};
+        std::atomic<std::size_t> nextQueue{0};
+        bool stopping = false;
+
+        struct WorkerIdentity
+        {
+            const ThreadPool* pool = nullptr;
+            std::size_t index      = 0;
+        };
+
+        static auto currentWorker() -> WorkerIdentity&
+        {
+            thread_local WorkerIdentity identity;
+            return identity;
+        }
+
+        auto ownQueue() const -> std::optional<std::size_t>
+        {
+            const WorkerIdentity& identity = currentWorker();
+            return identity.pool == this ? std::optional(identity.index) : std::nullopt;
+        }
+
+        // Tasks are counted before they are queued, so running one right away never takes the count below zero.
+        void submit(Task task)
+        {
+            const std::size_t target = ownQueue().value_or(nextQueue.fetch_add(1) % queues.size());
+
+            {
+                const std::scoped_lock lock(sleepMutex);
+                queued.fetch_add(1);
+            }
+
+            {
+                const std::scoped_lock lock(queues[target]->mutex);
+                queues[target]->tasks.push_back(std::move(task));
+            }
+
+            wakeUp.notify_one();
+        }
+
+        // Runs the newest task of the calling worker or steals the oldest one of another queue.
+        auto runOne() -> bool
+        {
+            Task task;
+            const std::optional<std::size_t> own = ownQueue();
+
+            if (own.has_value())
+            {
+                const std::scoped_lock lock(queues[*own]->mutex);
+
+                if (!queues[*own]->tasks.empty())
+                {
+                    task = std::move(queues[*own]->tasks.back());
+                    queues[*own]->tasks.pop_back();
+                }
+            }
+
+            for (std::size_t offset = 1; !task && offset <= queues.size(); ++offset)
+            {
+                Queue& victim = *queues[(own.value_or(0) + offset) % queues.size()];
+                const std::scoped_lock lock(victim.mutex);
+
+                if (!victim.tasks.empty())
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                }
+            }
+
+            if (!task)
+            {
+                return false;
+            }
+
+            queued.fetch_sub(1);
+            task();
+            return true;
+        }
+
+        void work(std::size_t index)
+        {
+            currentWorker() = {this, index};
+
+            while (true)
+            {
+                if (runOne())
+                {
+                    continue;
+                }
+
+                std::unique_lock lock(sleepMutex);
+                wakeUp.wait(lock, [this] { return stopping || queued.load() > 0; });
+
+                if (stopping && queued.load() == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        template<typename Body>
+        void split(Loop& loop, Body& body, std::size_t begin, std::size_t end)
+        {
+            while (end - begin > 1)
+            {
+                const std::size_t middle = begin + (end - begin) / 2;
+                submit([this, &loop, &body, middle, end] { split(loop, body, middle, end); });
+                end = middle;
+            }
+
+            if (!loop.failed.load())
+            {
+                try
+                {
+                    body(begin);
+                }
+                catch (...)
+                {
+                    if (!loop.failed.exchange(true))
+                    {
+                        loop.error = std::current_exception();
+                    }
+                }
+            }
+
+            loop.remaining.fetch_sub(1);
+        }
+
+    public:
+        // The thread calling `parallelFor` takes part in the work, so a pool of `threads` has one worker less.
+        explicit ThreadPool(std::size_t threads)
+        {
+            const std::size_t workerCount = std::max<std::size_t>(threads, 1) - 1;
+
+            for (std::size_t idx = 0; idx < workerCount; ++idx)
+            {
+                queues.push_back(std::make_unique<Queue>());
+            }
+
+            for (std::size_t idx = 0; idx < workerCount; ++idx)
+            {
+                workers.emplace_back([this, idx] { work(idx); });
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                const std::scoped_lock lock(sleepMutex);
+                stopping = true;
+            }
+
+            wakeUp.notify_all();
+
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&)                = delete;
+        ThreadPool(ThreadPool&&)                     = delete;
+        ThreadPool& operator=(const ThreadPool&)     = delete;
+        ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+        // Calls `body(idx)` for every idx in [0, count) and returns once all of them finished.
+        // The first exception thrown by the body is rethrown here after the remaining calls are skipped.
+        template<typename Body>
+        void parallelFor(std::size_t count, Body&& body)
+        {
+            if (workers.empty())
+            {
+                for (std::size_t idx = 0; idx < count; ++idx)
+                {
+                    body(idx);
+                }
+
+                return;
+            }
+
+            if (count == 0)
+            {
+                return;
+            }
+
+            Loop loop(count);
+            split(loop, body, 0, count);
+
+            while (loop.remaining.load() > 0)
+            {
+                if (!runOne())
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            if (loop.error)
+            {
+                std::rethrow_exception(loop.error);
+            }
+        }
+
+        // Queues the task without waiting for it to finish. Pools without workers run it right away instead.
+        void post(Task task)
+        {
+            if (workers.empty())
+            {
+                task();
+                return;
+            }
+
+            submit(std::move(task));
+        }
+
+        // Runs one queued task on the calling thread, returns false if there was none. Threads waiting for posted
+        // tasks call it to help out instead of sitting idle.
+        auto help() -> bool { return runOne(); }
+
+        // Number of threads taking part in a parallel loop, including the calling one.
+        std::size_t concurrency() const { return workers.size() + 1; }
+
+        // Pools are created on first use and live until the program exits, one for every requested thread count.
+        // A count of zero stands for the number of hardware threads.
+        static auto withThreads(std::size_t threads) -> ThreadPool&
+        {
+            static std::mutex registryMutex;
+            static std::map<std::size_t, std::unique_ptr<ThreadPool>> registry;
+
+            if (threads == 0)
+            {
+                threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            }
+
+            const std::scoped_lock lock(registryMutex);
+            std::unique_ptr<ThreadPool>& pool = registry[threads];
+
+            if (!pool)
+            {
+                pool = std::make_unique<ThreadPool>(threads);
+            }
+
+            return *pool;
+        }
+    };
+}
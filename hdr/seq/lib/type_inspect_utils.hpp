@@ -2,6 +2,7 @@
 #include "selectors.hpp"
 
 #include <cstdint>
+#include <string>
 
 namespace Seq::_internal::TypeInspect
 {
@@ -20,6 +21,12 @@ namespace Seq::_internal::TypeInspect
         Seq::_internal::Selectors::endSelector(sequence);
     };
 
+    template<typename T>
+    constexpr bool IS_BASIC_STRING = false;
+
+    template<typename CharT, typename Traits, typename Alloc>
+    constexpr bool IS_BASIC_STRING<std::basic_string<CharT, Traits, Alloc>> = true;
+
     template<typename SeqT>
     using ItemOf = RemoveCVR<decltype(*Seq::_internal::Selectors::beginSelector(std::declval<SeqT>()))>;
 
@@ -0,0 +1,221 @@
+// ┏━━━━━━━━━━━━━━━┓
+// ┃ windowing.hpp ┃
+// ┗━━━━━━━━━━━━━━━┛
+// `Seq::chunkBySize` and `Seq::windowed` hand out runs of consecutive elements as views instead of containers. Over a
+// borrowed contiguous container a run is a `std::span` (a `std::basic_string_view` for strings) into the container
+// itself, so not a single element is copied, and the runs are sliced off one after the other by the source of a fused
+// pipeline. Any other sequence is read into a buffer that is reused for every run and the views point into that
+// buffer, so a run is only valid until the next one is requested. Windows keep their buffer as a ring whose elements
+// are mirrored into a second half. The latest elements always form one contiguous range of it, and moving the window
+// ahead by one element is two stores.
+#pragma once
+#include "buffer.hpp"
+#include "fused.hpp"
+#include "ienumerable.hpp"
+#include "size_hint.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace Seq::_internal::Windowing
+{
+    // Borrowed contiguous containers, see `Seq::_internal::borrow`.
+    template<typename View>
+    concept EnsureIsContiguousView =
+        std::ranges::contiguous_range<const View> && std::ranges::sized_range<const View> && std::ranges::view<View>;
+
+    template<typename T, std::size_t Extent>
+    inline auto slice(std::span<T, Extent> view, std::size_t offset, std::size_t count) -> std::span<T>
+    {
+        return view.subspan(offset, count);
+    }
+
+    template<typename CharT, typename Traits>
+    inline auto slice(std::basic_string_view<CharT, Traits> view, std::size_t offset, std::size_t count)
+        -> std::basic_string_view<CharT, Traits>
+    {
+        return view.substr(offset, count);
+    }
+
+    // Chunks (`step == length`) or windows (`step == 1`) of a contiguous view, sliced off as they are requested. They
+    // become the source of a fused pipeline, so stages like `Seq::map` get them without a coroutine in between.
+    template<typename View>
+    class Slices
+    {
+    private:
+        View view;
+        std::size_t length;
+        std::size_t step;
+        std::size_t count;
+
+    public:
+        class Iterator
+        {
+        private:
+            const Slices* slices = nullptr;
+            std::size_t idx      = 0;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type   = std::ptrdiff_t;
+            using value_type        = View;
+            using reference         = View;
+
+            Iterator() = default;
+
+            Iterator(const Slices* slices, std::size_t idx)
+                : slices(slices)
+                , idx(idx)
+            {
+            }
+
+            View operator*() const
+            {
+                const std::size_t offset = idx * slices->step;
+                return slice(slices->view, offset, std::min(slices->length, slices->view.size() - offset));
+            }
+
+            Iterator& operator++()
+            {
+                ++idx;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator before = *this;
+                ++idx;
+                return before;
+            }
+
+            bool operator==(const Iterator& other) const { return idx == other.idx; }
+        };
+
+        Slices(View view, std::size_t length, std::size_t step)
+            : view(view)
+            , length(length)
+            , step(step)
+        {
+            if (step == length)
+            {
+                count = view.size() / length + (view.size() % length != 0 ? 1 : 0);
+            }
+            else
+            {
+                count = view.size() < length ? 0 : (view.size() - length) / step + 1;
+            }
+        }
+
+        Iterator begin() const { return Iterator(this, 0); }
+
+        Iterator end() const { return Iterator(this, count); }
+
+        std::size_t size() const { return count; }
+    };
+
+    template<typename T>
+    auto chunkBuffered(IEnumerable<T> sequence, std::size_t size) -> IEnumerable<std::span<const T>>
+    {
+        Buffer<T> buffer;
+        buffer.reserve(size);
+
+        for (const T& elem : sequence)
+        {
+            buffer.push_back(elem);
+
+            if (buffer.size() == size)
+            {
+                co_yield std::span<const T>(buffer);
+                buffer.clear();
+            }
+        }
+
+        if (!buffer.empty())
+        {
+            co_yield std::span<const T>(buffer);
+        }
+    }
+
+    // Every element sits in the ring twice, at `pos` and at `pos + size`, so the window starting right after the
+    // latest element is always `ring[next, next + size)`.
+    template<typename T>
+    auto windowBuffered(IEnumerable<T> sequence, std::size_t size) -> IEnumerable<std::span<const T>>
+    {
+        Buffer<T> ring;
+        ring.reserve(2 * size);
+
+        std::size_t next = 0;
+
+        for (const T& elem : sequence)
+        {
+            if (ring.size() < size)
+            {
+                ring.push_back(elem);
+
+                if (ring.size() < size)
+                {
+                    continue;
+                }
+
+                for (std::size_t idx = 0; idx < size; ++idx)
+                {
+                    ring.push_back(ring[idx]);
+                }
+            }
+            else
+            {
+                ring[next]        = elem;
+                ring[next + size] = elem;
+                next              = next + 1 == size ? 0 : next + 1;
+            }
+
+            co_yield std::span<const T>(ring.data() + next, size);
+        }
+    }
+
+    // The operator behind `Seq::chunkBySize` (`Overlapping = false`) and `Seq::windowed` (`Overlapping = true`).
+    template<bool Overlapping>
+    class Runs : public Fused::ViewOperatorTag
+    {
+    private:
+        std::size_t size;
+
+    public:
+        explicit Runs(std::size_t size)
+            : size(size)
+        {
+            if (size == 0)
+            {
+                throw std::invalid_argument(Overlapping ? "Seq::windowed needs windows of at least one element"
+                                                        : "Seq::chunkBySize needs chunks of at least one element");
+            }
+        }
+
+        template<EnsureIsContiguousView View>
+        auto operator()(View view) const
+        {
+            return Fused::Pipeline<Slices<View>>(Slices<View>(view, size, Overlapping ? 1 : size), {});
+        }
+
+        template<typename T>
+        auto operator()(IEnumerable<T> sequence) const -> IEnumerable<std::span<const T>>
+        {
+            const SizeHint hint = sequence.sizeHint();
+
+            if constexpr (Overlapping)
+            {
+                return windowBuffered(std::move(sequence), size).withSizeHint(hint.windows(size));
+            }
+            else
+            {
+                return chunkBuffered(std::move(sequence), size).withSizeHint(hint.chunked(size));
+            }
+        }
+    };
+}
@@ -1,17 +1,43 @@
 #pragma once
+#include "lib/async_enumerable.hpp"
+#include "lib/async_operators.hpp"
+#include "lib/batching.hpp"
+#include "lib/buffered_writer.hpp"
 #include "lib/config.hpp"
 #include "lib/debug.hpp"
+#include "lib/event_loop.hpp"
+#include "lib/external_sort.hpp"
+#include "lib/fused.hpp"
+#include "lib/grouping.hpp"
+#include "lib/joining.hpp"
+#include "lib/map_parallel.hpp"
+#include "lib/mapped_file.hpp"
+#include "lib/ordering.hpp"
+#include "lib/parallel.hpp"
+#include "lib/parallel_reduce.hpp"
+#include "lib/prefetch.hpp"
+#include "lib/read_ahead.hpp"
+#include "lib/reduce_kernels.hpp"
 #include "lib/seq_helper.hpp"
-#include "lib/seq_nocapture.hpp"
+#include "lib/set_operations.hpp"
 #include "lib/type_inspect_utils.hpp"
+#include "lib/windowing.hpp"
 
 #include <optional>
 #include <string>
+#include <type_traits>
 
 template<typename Func, typename T>
 auto operator|(IEnumerable<T>&& enumerable, Func&& function)
 {
-    return std::forward<Func>(function)(std::move(enumerable));
+    if constexpr (Seq::_internal::Fused::EnsureIsStage<Func>)
+    {
+        return Seq::_internal::Fused::makePipeline(std::move(enumerable), std::forward<Func>(function));
+    }
+    else
+    {
+        return std::forward<Func>(function)(std::move(enumerable));
+    }
 }
 
 template<typename Func, typename T>
@@ -20,22 +46,166 @@ auto operator|(IEnumerable<T>& enumerable, Func&& function)
     return std::move(enumerable) | std::forward<Func>(function);
 }
 
+// Stages run on every element of an asynchronous sequence as soon as it arrives. Folds would block the thread, their
+// asynchronous counterparts like `Seq::toVectorAsync` return a `Seq::Task` to await instead.
+template<typename Func, typename T>
+auto operator|(AsyncEnumerable<T>&& sequence, Func&& function)
+{
+    if constexpr (Seq::_internal::Fused::EnsureIsStage<Func>)
+    {
+        using Stage = Seq::_internal::TypeInspect::RemoveCVR<Func>;
+        return Seq::_internal::Async::throughStage(std::move(sequence), Stage(std::forward<Func>(function)));
+    }
+    else
+    {
+        static_assert(!Seq::_internal::Fused::EnsureIsFold<Func>,
+                      "Asynchronous sequences are consumed by operators like Seq::toVectorAsync");
+
+        return std::forward<Func>(function)(std::move(sequence));
+    }
+}
+
+template<typename Func, typename T>
+auto operator|(AsyncEnumerable<T>& sequence, Func&& function)
+{
+    return std::move(sequence) | std::forward<Func>(function);
+}
+
+template<typename Func, Seq::_internal::Fused::EnsureIsPipeline Pipeline>
+requires (!std::is_lvalue_reference_v<Pipeline>)
+auto operator|(Pipeline&& pipeline, Func&& function)
+{
+    if constexpr (Seq::_internal::Fused::EnsureIsStage<Func>)
+    {
+        return std::move(pipeline).append(std::forward<Func>(function));
+    }
+    else if constexpr (Seq::_internal::Fused::EnsureIsFold<Func>)
+    {
+        return std::forward<Func>(function)(std::move(pipeline));
+    }
+    else if constexpr (Seq::_internal::Batching::EnsureIsMode<Func>)
+    {
+        return std::forward<Func>(function)(std::move(pipeline));
+    }
+    else if constexpr (Seq::_internal::Fused::EnsureIsViewOperator<Func> && requires { function(pipeline.view()); })
+    {
+        return std::forward<Func>(function)(pipeline.view());
+    }
+    else
+    {
+        return IEnumerable<typename Pipeline::Item>(std::move(pipeline)) | std::forward<Func>(function);
+    }
+}
+
+template<typename Func, Seq::_internal::Fused::EnsureIsPipeline Pipeline>
+auto operator|(Pipeline& pipeline, Func&& function)
+{
+    return std::move(pipeline) | std::forward<Func>(function);
+}
+
+// Lvalue sequences are borrowed, so they have to outlive the pipeline built on top of them.
 template<Seq::_internal::TypeInspect::EnsureIsSeq SeqT, typename Func>
 auto operator|(const SeqT& sequence, Func&& function)
 {
-    return Seq::_internal::wrapAsIEnumerable(ByValue(sequence)) | std::forward<Func>(function);
+    if constexpr (Seq::_internal::Fused::EnsureIsStage<Func>)
+    {
+        return Seq::_internal::Fused::makePipeline(Seq::_internal::borrow(sequence), std::forward<Func>(function));
+    }
+    else if constexpr (Seq::_internal::Fused::EnsureIsFold<Func>)
+    {
+        return std::forward<Func>(function)(Seq::_internal::borrow(sequence));
+    }
+    else if constexpr (Seq::_internal::Parallel::EnsureIsPolicy<Func>)
+    {
+        return Seq::_internal::Parallel::makePipeline(sequence, function);
+    }
+    else if constexpr (Seq::_internal::Batching::EnsureIsMode<Func>)
+    {
+        return std::forward<Func>(function)(Seq::_internal::borrow(sequence));
+    }
+    else if constexpr (Seq::_internal::Fused::EnsureIsViewOperator<Func>
+                       && requires { function(Seq::_internal::borrow(sequence)); })
+    {
+        return std::forward<Func>(function)(Seq::_internal::borrow(sequence));
+    }
+    else
+    {
+        return Seq::_internal::wrapAsIEnumerable(ByValue(Seq::_internal::borrow(sequence)))
+               | std::forward<Func>(function);
+    }
+}
+
+// Rvalue sequences are moved into the pipeline which then owns them.
+template<Seq::_internal::TypeInspect::EnsureIsSeq SeqT, typename Func>
+requires (!std::is_lvalue_reference_v<SeqT>)
+auto operator|(SeqT&& sequence, Func&& function)
+{
+    return Seq::_internal::wrapAsIEnumerable(ByValue(std::move(sequence))) | std::forward<Func>(function);
 }
 
 namespace Seq
 {
+    // `Seq::aggregateParallel` is equivalent to `Seq::reduceParallel` but updates its accumulators in place, which
+    // suits accumulators too large to be passed around by value, e.g. histograms.
+    // Parameter identity is the accumulator every partial result starts from, e.g. an empty histogram.
+    // Parameter step has signature `(typeOf[identity]&, T) -> void`.
+    // Parameter combine has signature `(typeOf[identity]&, typeOf[identity]) -> void` and adds the second partial
+    // result to the first one.
+    // Parameter threads is the number of threads to use, including the calling one. 0 means one per hardware thread.
+    template<typename Accumulator, typename Step, typename Combine>
+    inline auto aggregateParallel(Accumulator&& identity, Step&& step, Combine&& combine, std::size_t threads = 0)
+    {
+        return _internal::Fused::Fold(
+            [identity = std::forward<Accumulator>(identity),
+             step     = std::forward<Step>(step),
+             combine  = std::forward<Combine>(combine),
+             threads]<typename Sequence>(Sequence&& sequence) -> std::decay_t<Accumulator>
+            {
+                _internal::ThreadPool& pool = _internal::ThreadPool::withThreads(threads);
+                return _internal::ParallelReduce::aggregate(std::forward<Sequence>(sequence),
+                                                            pool,
+                                                            identity,
+                                                            step,
+                                                            combine);
+            });
+    }
+
+    // `Seq::average` returns the arithmetic mean of the sequence or nothing if it is empty.
+    // Integers are averaged as double, floating-point elements keep their own type.
+    // Parameter Mode selects the summation strategy, see `Seq::Summation`.
+    template<Summation Mode = Summation::FAST>
+    inline auto average()
+    {
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> auto
+            {
+                using T = _internal::Fused::ItemOf<Sequence>;
+                static_assert(_internal::TypeInspect::EnsureIsSummable<T>,
+                              "Seq::average only supports integrals, float and double");
+
+                return _internal::Kernels::average<Mode, T>(std::forward<Sequence>(sequence));
+            });
+    }
+
+    // `Seq::batched` makes the stages following it pass their elements on in blocks of up to BlockSize elements.
+    // Each stage then runs over a whole block before the next stage sees it, which pays off for cheap stages like
+    // `Seq::map` with a plain arithmetic body. `Seq::sum`, `Seq::count`, `Seq::length`, `Seq::toVector` and the other
+    // folds consume the blocks directly, any other operator receives single elements again.
+    // Elements are read from the source a block ahead of what has been consumed.
+    template<std::size_t BlockSize = 256>
+    inline auto batched()
+    {
+        return _internal::Batching::Mode<BlockSize>();
+    }
+
     // `Seq::chunkBySize` divides the elements into chunks of the given size.
     // The last chunk may contain less elements if size was not a factor of length.
+    // Chunks of a contiguous container are views into it, `std::basic_string_view` for strings and `std::span<const T>`
+    // otherwise. Chunks of any other sequence are a `std::span<const T>` into a buffer that is reused for the next
+    // chunk, so they have to be copied to be kept around.
     inline auto chunkBySize(std::size_t size)
     {
-        return [size]<typename T>(IEnumerable<T> sequence) -> IEnumerable<std::vector<T>>
-        {
-            return _internal::chunkBySizeNoCapture(std::move(sequence), size);
-        };
+        return _internal::Windowing::Runs<false>(size);
     }
 
     // `Seq::contains` tests whether a given element is found in the input sequence.
@@ -61,39 +231,193 @@ namespace Seq
     template<typename Predicate>
     inline auto count(Predicate&& pred)
     {
-        return [pred = std::forward<Predicate>(pred)]<typename T>(IEnumerable<T> sequence) -> std::size_t
-        {
-            std::size_t count = 0;
-
-            for (const auto& elem : sequence)
+        return _internal::Fused::Fold(
+            [pred = std::forward<Predicate>(pred)]<typename Sequence>(Sequence&& sequence) -> std::size_t
             {
-                if (pred(elem))
+                std::size_t count = 0;
+
+                if constexpr (_internal::Fused::EnsureIsBlockwise<Sequence>)
                 {
-                    ++count;
+                    // Without a branch per element the loop over a block can be vectorized
+                    auto countBlock = [&pred, &count](const auto& block) -> bool
+                    {
+                        for (const auto& elem : block)
+                        {
+                            count += static_cast<std::size_t>(static_cast<bool>(pred(elem)));
+                        }
+
+                        return true;
+                    };
+
+                    sequence.runBlocks(countBlock);
                 }
-            }
+                else
+                {
+                    _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                              [&pred, &count](const auto& elem) -> bool
+                                              {
+                                                  if (pred(elem))
+                                                  {
+                                                      ++count;
+                                                  }
+
+                                                  return true;
+                                              });
+                }
+
+                return count;
+            });
+    }
+
+    // `Seq::countBy` returns every distinct key the elements are mapped to along with how many elements map to it.
+    // Keys come in the order they first appeared in. The result consists of `std::pair<Key, std::size_t>` elements.
+    // Parameter mapping has signature `(T) -> Key`.
+    // Parameter hash has signature `(Key) -> std::size_t` and defaults to `std::hash<Key>`.
+    template<typename Mapping, typename Hash = _internal::FlatHash::StdHash>
+    inline auto countBy(Mapping&& mapping, Hash hash = {})
+    {
+        return _internal::Fused::Fold(
+            [mapping = std::forward<Mapping>(mapping), hash]<typename Sequence>(Sequence&& sequence)
+            {
+                using SequenceT = _internal::TypeInspect::RemoveCVR<Sequence>;
+
+                const _internal::SizeHint hint = _internal::hintOf(sequence).filtered();
+                return _internal::Grouping::countElementsBy(SequenceT(std::forward<Sequence>(sequence)), mapping, hash)
+                    .withSizeHint(hint);
+            });
+    }
+
+    // `Seq::distinct` returns the elements without duplicates, in the order they first appeared in.
+    // Parameter hash has signature `(T) -> std::size_t` and defaults to `std::hash<T>`.
+    template<typename Hash = _internal::FlatHash::StdHash>
+    inline auto distinct(Hash hash = {})
+    {
+        return [hash]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().subsequence();
+            return _internal::Grouping::distinctElementsBy(std::move(sequence), std::identity(), hash)
+                .withSizeHint(hint);
+        };
+    }
 
-            return count;
+    // `Seq::distinctBy` returns the first element for every distinct key the elements are mapped to.
+    // Parameter mapping has signature `(T) -> Key`.
+    // Parameter hash has signature `(Key) -> std::size_t` and defaults to `std::hash<Key>`.
+    template<typename Mapping, typename Hash = _internal::FlatHash::StdHash>
+    inline auto distinctBy(Mapping&& mapping, Hash hash = {})
+    {
+        return [mapping = std::forward<Mapping>(mapping), hash]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().subsequence();
+            return _internal::Grouping::distinctElementsBy(std::move(sequence), mapping, hash).withSizeHint(hint);
         };
     }
 
+    // `Seq::except` returns the distinct elements that are NOT contained in the other sequence.
+    // Elements keep their order, unless both sequences are merged (see `Seq::SetStrategy::MERGE`).
+    // Sequences passed as lvalue containers are borrowed, so they have to outlive the result.
+    // Parameter Strategy selects the algorithm, see `Seq::SetStrategy`.
+    // Parameter hash has signature `(T) -> std::size_t` and defaults to `std::hash<T>`.
+    template<SetStrategy Strategy = SetStrategy::AUTO, typename Other, typename Hash = _internal::FlatHash::StdHash>
+    inline auto except(Other&& other, Hash hash = {})
+    {
+        using _internal::SetOps::Operation;
+        return _internal::SetOps::makeSetOperation<Operation::EXCEPT, Strategy>(std::forward<Other>(other), hash);
+    }
+
     // `Seq::exists` is a sibling function of `Seq::forall`.
     // Tests whether AT LEAST one element of the sequence satisfies the predicate.
     // Parameter pred has signature `(T) -> bool`.
     template<typename Predicate>
     inline auto exists(Predicate&& pred)
     {
-        return [pred = std::forward<Predicate>(pred)]<typename T>(IEnumerable<T> sequence) -> bool
-        {
-            for (const auto& elem : sequence)
+        return _internal::Fused::Fold(
+            [pred = std::forward<Predicate>(pred)]<typename Sequence>(Sequence&& sequence) -> bool
             {
-                if (pred(elem))
-                {
-                    return true;
-                }
-            }
+                bool found = false;
 
-            return false;
+                _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                          [&pred, &found](const auto& elem) -> bool
+                                          {
+                                              found = pred(elem);
+                                              return !found;
+                                          });
+
+                return found;
+            });
+    }
+
+    // `Seq::externalSort` sorts the elements in ascending order without holding more than a memory budget of them.
+    // Sorted runs that exceed the budget are spilled into temporary files and merged back lazily.
+    // Only the `sizeof` of buffered elements counts towards the budget, memory they own on the heap does not. A run
+    // holds at least 64 elements whatever the budget, and no more than 64 runs are read at once, more of them are
+    // merged into longer runs on disk first.
+    // Parameter serializer needs `write(std::ostream&, const T&)` and `read(std::istream&) -> std::optional<T>`.
+    // By default elements are written as raw bytes, which requires T to be trivially copyable.
+    template<typename Serializer = _internal::Spill::RawBytes>
+    inline auto externalSort(std::size_t memoryBudgetBytes, Serializer serializer = {})
+    {
+        return [memoryBudgetBytes, serializer]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().sortedAscending();
+
+            return _internal::Spill::externalSortElementsBy<false>(std::move(sequence),
+                                                                  memoryBudgetBytes,
+                                                                  std::identity(),
+                                                                  _internal::Spill::serializerFor<T>(serializer))
+                .withSizeHint(hint);
+        };
+    }
+
+    // `Seq::externalSortBy` is `Seq::externalSort` in ascending order of the key the elements are mapped to.
+    // Parameter mapping has signature `(T) -> U`.
+    template<typename Mapping, typename Serializer = _internal::Spill::RawBytes>
+    inline auto externalSortBy(std::size_t memoryBudgetBytes, Mapping&& mapping, Serializer serializer = {})
+    {
+        return [memoryBudgetBytes, mapping = std::forward<Mapping>(mapping), serializer]<typename T>(
+                   IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().elementwise();
+
+            return _internal::Spill::externalSortElementsBy<false>(std::move(sequence),
+                                                                  memoryBudgetBytes,
+                                                                  mapping,
+                                                                  _internal::Spill::serializerFor<T>(serializer))
+                .withSizeHint(hint);
+        };
+    }
+
+    // `Seq::externalSortByDescending` is `Seq::externalSort` in descending order of the key the elements are mapped to.
+    // Parameter mapping has signature `(T) -> U`.
+    template<typename Mapping, typename Serializer = _internal::Spill::RawBytes>
+    inline auto externalSortByDescending(std::size_t memoryBudgetBytes, Mapping&& mapping, Serializer serializer = {})
+    {
+        return [memoryBudgetBytes, mapping = std::forward<Mapping>(mapping), serializer]<typename T>(
+                   IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().elementwise();
+
+            return _internal::Spill::externalSortElementsBy<true>(std::move(sequence),
+                                                                 memoryBudgetBytes,
+                                                                 mapping,
+                                                                 _internal::Spill::serializerFor<T>(serializer))
+                .withSizeHint(hint);
+        };
+    }
+
+    // `Seq::externalSortDescending` is `Seq::externalSort` in descending order.
+    template<typename Serializer = _internal::Spill::RawBytes>
+    inline auto externalSortDescending(std::size_t memoryBudgetBytes, Serializer serializer = {})
+    {
+        return [memoryBudgetBytes, serializer]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        {
+            const _internal::SizeHint hint = sequence.sizeHint().elementwise();
+
+            return _internal::Spill::externalSortElementsBy<true>(std::move(sequence),
+                                                                 memoryBudgetBytes,
+                                                                 std::identity(),
+                                                                 _internal::Spill::serializerFor<T>(serializer))
+                .withSizeHint(hint);
         };
     }
 
@@ -102,9 +426,18 @@ namespace Seq
     template<typename Predicate>
     inline auto filter(Predicate&& pred)
     {
-        return [pred = std::forward<Predicate>(pred)]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        return _internal::Fused::FilterStage(std::forward<Predicate>(pred));
+    }
+
+    // `Seq::filterAsync` is equivalent to `Seq::filter` for an `AsyncEnumerable<T>` whose predicate has to wait for its
+    // answer. Each answer is awaited before the next element is requested.
+    // Parameter pred has signature `(T) -> Awaitable<bool>`, e.g. `(T) -> Seq::Task<bool>`.
+    template<typename Predicate>
+    inline auto filterAsync(Predicate&& pred)
+    {
+        return [pred = std::forward<Predicate>(pred)]<typename T>(AsyncEnumerable<T> sequence) -> AsyncEnumerable<T>
         {
-            return _internal::filterNoCapture(std::move(sequence), ByValue(pred));
+            return _internal::Async::filterAwaited(std::move(sequence), pred);
         };
     }
 
@@ -135,27 +468,102 @@ namespace Seq
     template<typename Predicate>
     inline auto forall(Predicate&& pred)
     {
-        return [pred = std::forward<Predicate>(pred)]<typename T>(IEnumerable<T> sequence) -> bool
-        {
-            for (const auto& elem : sequence)
+        return _internal::Fused::Fold(
+            [pred = std::forward<Predicate>(pred)]<typename Sequence>(Sequence&& sequence) -> bool
             {
-                if (!pred(elem))
-                {
-                    return false;
-                }
-            }
+                bool holds = true;
 
-            return true;
-        };
+                _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                          [&pred, &holds](const auto& elem) -> bool
+                                          {
+                                              holds = pred(elem);
+                                              return holds;
+                                          });
+
+                return holds;
+            });
+    }
+
+    // `Seq::groupBy` collects the elements into groups of elements that map to the same key.
+    // Groups come in the order their keys first appeared in and keep the order of their elements.
+    // The result consists of `std::pair<Key, std::vector<T>>` elements.
+    // Parameter mapping has signature `(T) -> Key`.
+    // Parameter hash has signature `(Key) -> std::size_t` and defaults to `std::hash<Key>`.
+    template<typename Mapping, typename Hash = _internal::FlatHash::StdHash>
+    inline auto groupBy(Mapping&& mapping, Hash hash = {})
+    {
+        return _internal::Fused::Fold(
+            [mapping = std::forward<Mapping>(mapping), hash]<typename Sequence>(Sequence&& sequence)
+            {
+                using SequenceT = _internal::TypeInspect::RemoveCVR<Sequence>;
+
+                const _internal::SizeHint hint = _internal::hintOf(sequence).filtered();
+                return _internal::Grouping::groupElementsBy(SequenceT(std::forward<Sequence>(sequence)), mapping, hash)
+                    .withSizeHint(hint);
+            });
+    }
+
+    // `Seq::groupJoin` pairs every element with all elements of the inner sequence that have the same key.
+    // Unlike `Seq::join`, elements without any match are kept and see an empty span. Matches keep their order.
+    // The inner sequence is read into a hash table once the result is iterated, the outer one is only streamed.
+    // Inner containers passed as lvalues are borrowed, so they have to outlive the result.
+    // Parameter outerKey has signature `(T) -> Key`.
+    // Parameter innerKey has signature `(U) -> Key`.
+    // Parameter result has signature `(T, std::span<const U>) -> R`.
+    // Parameter hash has signature `(Key) -> std::size_t` and defaults to `std::hash<Key>`.
+    template<typename Inner, typename OuterKey, typename InnerKey, typename Result,
+             typename Hash = _internal::FlatHash::StdHash>
+    inline auto groupJoin(Inner&& inner, OuterKey&& outerKey, InnerKey&& innerKey, Result&& result, Hash hash = {})
+    {
+        return _internal::Joining::makeJoin<true>(std::forward<Inner>(inner),
+                                                  std::forward<OuterKey>(outerKey),
+                                                  std::forward<InnerKey>(innerKey),
+                                                  std::forward<Result>(result),
+                                                  std::move(hash));
+    }
+
+    // `Seq::intersect` returns the distinct elements that are also contained in the other sequence.
+    // Elements keep their order. Both sequences are merged if they are sorted, see `Seq::SetStrategy`.
+    // Sequences passed as lvalue containers are borrowed, so they have to outlive the result.
+    // Parameter Strategy selects the algorithm, see `Seq::SetStrategy`.
+    // Parameter hash has signature `(T) -> std::size_t` and defaults to `std::hash<T>`.
+    template<SetStrategy Strategy = SetStrategy::AUTO, typename Other, typename Hash = _internal::FlatHash::StdHash>
+    inline auto intersect(Other&& other, Hash hash = {})
+    {
+        using _internal::SetOps::Operation;
+        return _internal::SetOps::makeSetOperation<Operation::INTERSECT, Strategy>(std::forward<Other>(other), hash);
     }
 
     // `Seq::isEmpty` passes in case a sequence does NOT contain any elements.
+    // Runs in constant time if the length of the sequence is known up front.
     inline auto isEmpty()
     {
-        return []<typename T>(IEnumerable<T> sequence) -> bool
-        {
-            return !(sequence.begin() != sequence.end());
-        };
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> bool
+            {
+                const _internal::SizeHint hint = _internal::hintOf(sequence);
+
+                if (hint.isBounded() && hint.size() == 0)
+                {
+                    return true;
+                }
+
+                if (hint.isExact())
+                {
+                    return false;
+                }
+
+                bool empty = true;
+
+                _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                          [&empty](const auto& /*unused*/) -> bool
+                                          {
+                                              empty = false;
+                                              return false;
+                                          });
+
+                return empty;
+            });
     }
 
     // `Seq::iter` consumes a sequence by applying a "return value"-less function to each element.
@@ -193,20 +601,75 @@ namespace Seq
         };
     }
 
-    // `Seq::length` returns the length of the sequence.
-    inline auto length()
+    // `Seq::iterAsync` consumes an `AsyncEnumerable<T>` by applying an action to each element, which is the
+    // asynchronous counterpart of a range-based for loop. Actions returning an awaitable are awaited before the next
+    // element is requested. The returned `Seq::Task<void>` has to be awaited or spawned on an event loop.
+    // Parameter action has signature `(T) -> void` or `(T) -> Awaitable<void>`.
+    template<typename Action>
+    inline auto iterAsync(Action&& action)
     {
-        return []<typename T>(IEnumerable<T> sequence) -> std::size_t
+        return [action = std::forward<Action>(action)]<typename T>(AsyncEnumerable<T> sequence) -> Task<void>
         {
-            std::size_t length = 0;
+            return _internal::Async::iterate(std::move(sequence), action);
+        };
+    }
 
-            for ([[maybe_unused]] const auto& elem : sequence)
+    // `Seq::join` pairs every element with each element of the inner sequence that has the same key.
+    // Results come in the order of the elements, matches of the same element in the order of the inner sequence.
+    // The inner sequence is read into a hash table once the result is iterated, the outer one is only streamed.
+    // Pass the smaller of both sequences as the inner one. Inner containers passed as lvalues are borrowed, so they
+    // have to outlive the result.
+    // Parameter outerKey has signature `(T) -> Key`.
+    // Parameter innerKey has signature `(U) -> Key`.
+    // Parameter result has signature `(T, U) -> R`.
+    // Parameter hash has signature `(Key) -> std::size_t` and defaults to `std::hash<Key>`.
+    template<typename Inner, typename OuterKey, typename InnerKey, typename Result,
+             typename Hash = _internal::FlatHash::StdHash>
+    inline auto join(Inner&& inner, OuterKey&& outerKey, InnerKey&& innerKey, Result&& result, Hash hash = {})
+    {
+        return _internal::Joining::makeJoin<false>(std::forward<Inner>(inner),
+                                                   std::forward<OuterKey>(outerKey),
+                                                   std::forward<InnerKey>(innerKey),
+                                                   std::forward<Result>(result),
+                                                   std::move(hash));
+    }
+
+    // `Seq::length` returns the length of the sequence.
+    // Runs in constant time if the length of the sequence is known up front, e.g. after `Seq::map` over a vector.
+    inline auto length()
+    {
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> std::size_t
             {
-                ++length;
-            }
+                if (const _internal::SizeHint hint = _internal::hintOf(sequence); hint.isExact())
+                {
+                    return hint.size();
+                }
 
-            return length;
-        };
+                std::size_t length = 0;
+
+                if constexpr (_internal::Fused::EnsureIsBlockwise<Sequence>)
+                {
+                    auto countBlock = [&length](const auto& block) -> bool
+                    {
+                        length += block.size();
+                        return true;
+                    };
+
+                    sequence.runBlocks(countBlock);
+                }
+                else
+                {
+                    _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                              [&length](const auto& /*unused*/) -> bool
+                                              {
+                                                  ++length;
+                                                  return true;
+                                              });
+                }
+
+                return length;
+            });
     }
 
     // `Seq::map` applies a transformation to its elements.
@@ -214,12 +677,18 @@ namespace Seq
     template<typename Mapping>
     inline auto map(Mapping&& mapping)
     {
-        return [mapping = std::forward<Mapping>(mapping)]<typename T>(IEnumerable<T> sequence) -> auto
-        {
-            static_assert(_internal::TypeInspect::IS_INVOKABLE<Mapping, T>);
-            using U = _internal::TypeInspect::ReturnValueOf<Mapping, T>;
+        return _internal::Fused::MapStage(std::forward<Mapping>(mapping));
+    }
 
-            return _internal::mapNoCapture<U>(std::move(sequence), ByValue(mapping));
+    // `Seq::mapAsync` is equivalent to `Seq::map` for an `AsyncEnumerable<T>` whose transformation has to wait for its
+    // result. Each result is awaited before the next element is requested.
+    // Parameter mapping has signature `(T) -> Awaitable<U>`, e.g. `(T) -> Seq::Task<U>`.
+    template<typename Mapping>
+    inline auto mapAsync(Mapping&& mapping)
+    {
+        return [mapping = std::forward<Mapping>(mapping)]<typename T>(AsyncEnumerable<T> sequence)
+        {
+            return _internal::Async::mapAwaited(std::move(sequence), mapping);
         };
     }
 
@@ -228,13 +697,80 @@ namespace Seq
     template<typename Mapping>
     inline auto mapi(Mapping&& mapping)
     {
-        return [mapping = std::forward<Mapping>(mapping)]<typename T>(IEnumerable<T> sequence) -> auto
-        {
-            static_assert(_internal::TypeInspect::IS_INVOKABLE<Mapping, T, std::size_t>);
-            using U = _internal::TypeInspect::ReturnValueOf<Mapping, T, std::size_t>;
+        return _internal::Fused::MapWithIndexStage(std::forward<Mapping>(mapping));
+    }
 
-            return _internal::mapWithIndexNoCapture<U>(std::move(sequence), ByValue(mapping));
-        };
+    // `Seq::mapParallel` is equivalent to `Seq::map` but applies the transformation on multiple threads. Unlike
+    // `Seq::parallel` it works on any sequence, e.g. `Seq::range` or `Seq::readLines`. Elements are pulled from the
+    // source in batches, which are mapped on a thread pool and yielded in their original order. It pays off for
+    // transformations that take microseconds per element, which must be safe to call from multiple threads at once.
+    // Parameter mapping has signature `(T) -> U`.
+    // Parameter threads is the number of threads to use, including the calling one. 0 means one per hardware thread.
+    // Parameter maxInFlight is the most elements taken from the source but not yet yielded. 0 chooses it based on the
+    // number of threads.
+    template<typename Mapping>
+    inline auto mapParallel(Mapping&& mapping, std::size_t threads = 0, std::size_t maxInFlight = 0)
+    {
+        using Operator = _internal::MapParallel::Operator<std::decay_t<Mapping>>;
+        return Operator(std::forward<Mapping>(mapping), threads, maxInFlight);
+    }
+
+    // `Seq::max` returns the greatest element of the sequence or nothing if it is empty.
+    // Ties are resolved in favor of the first element.
+    inline auto max()
+    {
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> auto
+            {
+                using T = _internal::Fused::ItemOf<Sequence>;
+
+                const auto isBetter = [](const T& candidate, const T& best) -> bool
+                {
+                    return best < candidate;
+                };
+
+                return _internal::Kernels::select<T>(std::forward<Sequence>(sequence), isBetter);
+            });
+    }
+
+    // `Seq::min` returns the smallest element of the sequence or nothing if it is empty.
+    // Ties are resolved in favor of the first element.
+    inline auto min()
+    {
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> auto
+            {
+                using T = _internal::Fused::ItemOf<Sequence>;
+
+                const auto isBetter = [](const T& candidate, const T& best) -> bool
+                {
+                    return candidate < best;
+                };
+
+                return _internal::Kernels::select<T>(std::forward<Sequence>(sequence), isBetter);
+            });
+    }
+
+    // `Seq::mmapLines` returns the lines of a text file, read through a read-only memory mapping of the file. Lines end
+    // at `\n`, a `\r` right before it is dropped and a line break at the very end does not start another line. Lines
+    // are views into the mapping, which is unmapped once the sequence is destroyed, so lines that need to outlive the
+    // sequence have to be copied (e.g. by `Seq::map` into a `std::string`).
+    // Throws `std::system_error` right away if the file cannot be mapped.
+    inline auto mmapLines(const std::filesystem::path& path) -> IEnumerable<std::string_view>
+    {
+        return _internal::Mapping::lines(path);
+    }
+
+    // `Seq::mmapRecords` returns the records of a binary file holding nothing but consecutive T, which has to be
+    // trivially copyable.
+    // Records are read straight from a read-only memory mapping of the file, which is unmapped once the sequence is
+    // destroyed. Their length is known up front.
+    // Throws `std::system_error` right away if the file cannot be mapped and `std::runtime_error` if its size is not a
+    // multiple of `sizeof(T)`.
+    template<typename T>
+    inline auto mmapRecords(const std::filesystem::path& path) -> IEnumerable<T>
+    {
+        return _internal::Mapping::records<T>(path);
     }
 
     // `Seq::pairwise` returns a sequence where all consecutive elements become paired.
@@ -243,17 +779,8 @@ namespace Seq
     {
         return []<typename T>(IEnumerable<T> sequence) -> IEnumerable<std::pair<T, T>>
         {
-            std::optional<T> previousElem;
-
-            for (const auto& elem : sequence)
-            {
-                if (previousElem.has_value())
-                {
-                    co_yield std::make_pair(*previousElem, elem);
-                }
-
-                previousElem = elem;
-            }
+            const _internal::SizeHint hint = sequence.sizeHint().paired(false);
+            return _internal::pairElements(std::move(sequence)).withSizeHint(hint);
         };
     }
 
@@ -263,30 +790,34 @@ namespace Seq
     {
         return []<typename T>(IEnumerable<T> sequence) -> IEnumerable<std::pair<T, T>>
         {
-            bool atLeastOnePair = false;
-            std::optional<T> firstElem;
-            std::optional<T> previousElem;
-
-            for (const auto& elem : sequence)
-            {
-                if (previousElem.has_value())
-                {
-                    atLeastOnePair = true;
-                    co_yield std::make_pair(*previousElem, elem);
-                }
-                else
-                {
-                    firstElem = elem;
-                }
+            const _internal::SizeHint hint = sequence.sizeHint().paired(true);
+            return _internal::pairElementsWrapped(std::move(sequence)).withSizeHint(hint);
+        };
+    }
 
-                previousElem = elem;
-            }
+    // `Seq::parallel` runs the `Seq::map` and `Seq::filter` stages that follow it on multiple threads.
+    // The source is split into chunks of grain elements which are processed by a work-stealing thread pool.
+    // Results keep the order of the source. Only borrowed containers with random access are split, e.g.
+    // `std::vector` or `std::deque`, every other sequence stays sequential. Mappings and predicates must be safe to
+    // call from multiple threads at once. Any other operator after them, e.g. `Seq::take`, runs sequentially on the
+    // results once all of them are ready.
+    // Parameter threads is the number of threads to use, including the calling one. 0 means one per hardware thread.
+    // Parameter grain is the number of elements processed by a single task. 0 chooses it based on the length.
+    inline auto parallel(std::size_t threads = 0, std::size_t grain = 0)
+    {
+        return _internal::Parallel::Policy(threads, grain);
+    }
 
-            if (atLeastOnePair)
-            {
-                co_yield std::make_pair(*previousElem, *firstElem);
-            }
-        };
+    // `Seq::prefetch` runs everything before it on a thread of its own, while the rest of the pipeline consumes what it
+    // produces. Elements are handed over in their original order through a ring buffer, which never holds more than
+    // capacity elements, so the producing half waits whenever it is that far ahead. Exceptions of the producing half
+    // are rethrown to the consumer once every element before them has been consumed. Dropping the sequence early stops
+    // the producing half as soon as it yields its next element. A consumer waiting for elements is handed them in
+    // batches of half the capacity, so keep it small for sources that produce slowly.
+    // Parameter capacity is the number of elements produced ahead of the consumer, rounded up to a power of two.
+    inline auto prefetch(std::size_t capacity)
+    {
+        return _internal::Prefetch::Operator(capacity);
     }
 
     // `Seq::range` returns every nth(=step) value from the interval [min, max).
@@ -298,12 +829,14 @@ namespace Seq
     {
         ASSERT(step != static_cast<T>(0), "Parameter step of `Seq::range` MUST NOT be 0");
 
+        const auto hint = _internal::SizeHint::exact(_internal::rangeLength(inclusiveMin, exclusiveMax, step));
+
         if (step > 0)
         {
-            return _internal::rangeIncreasing(inclusiveMin, exclusiveMax, step);
+            return _internal::rangeIncreasing(inclusiveMin, exclusiveMax, step).withSizeHint(hint.sortedAscending());
         }
 
-        return _internal::rangeDecreasing(inclusiveMin, exclusiveMax, step);
+        return _internal::rangeDecreasing(inclusiveMin, exclusiveMax, step).withSizeHint(hint);
     }
 
     // `Seq::range` returns all values from the interval [min, max).
@@ -324,6 +857,28 @@ namespace Seq
         return Seq::range(static_cast<T>(0), exclusiveMax);
     }
 
+    // `Seq::readChunks` returns the contents of a file as consecutive blocks of blockSize bytes, the last one possibly
+    // shorter. A thread of its own reads the next block while the current one is processed.
+    // Blocks are views into one of two reused buffers, so a block is only valid until the next one is requested.
+    // Throws `std::system_error` right away if the file cannot be opened and while reading if a read fails.
+    inline auto readChunks(const std::filesystem::path& path,
+                           std::size_t blockSize = _internal::ReadAhead::DEFAULT_BLOCK_SIZE)
+        -> IEnumerable<std::span<const std::byte>>
+    {
+        return _internal::ReadAhead::chunks(path, blockSize);
+    }
+
+    // `Seq::readLines` returns the lines of a text file like `Seq::mmapLines`, but reads the file block by block like
+    // `Seq::readChunks` instead of mapping it, which also works for pipes and files that change while they are read.
+    // Lines are only valid until the next one is requested.
+    // Throws `std::system_error` right away if the file cannot be opened and while reading if a read fails.
+    inline auto readLines(const std::filesystem::path& path,
+                          std::size_t blockSize = _internal::ReadAhead::DEFAULT_BLOCK_SIZE)
+        -> IEnumerable<std::string_view>
+    {
+        return _internal::ReadAhead::lines(path, blockSize);
+    }
+
     // `Seq::reduce` continuously applies a reduction function to the next element of the sequence and
     // an arbitrary initial value.
     // Parameter accum can have pretty much any type. Make sure it matches the return type of reduce.
@@ -331,162 +886,237 @@ namespace Seq
     template<typename Accumulator, typename Reduction>
     inline auto reduce(Accumulator&& accum, Reduction&& reduce)
     {
-        return [accum  = std::forward<Accumulator>(accum),
-                reduce = std::forward<Reduction>(reduce)]<typename T>(IEnumerable<T> sequence) -> Accumulator
-        {
-            Accumulator out = accum;
-
-            for (const auto& elem : sequence)
+        return _internal::Fused::Fold(
+            [accum  = std::forward<Accumulator>(accum),
+             reduce = std::forward<Reduction>(reduce)]<typename Sequence>(Sequence&& sequence) -> Accumulator
             {
-                out = reduce(elem, out);
-            }
+                Accumulator out = accum;
 
-            return out;
-        };
+                _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                          [&reduce, &out](const auto& elem) -> bool
+                                          {
+                                              out = reduce(elem, out);
+                                              return true;
+                                          });
+
+                return out;
+            });
+    }
+
+    // `Seq::reduceParallel` is equivalent to `Seq::reduce` but folds random-access containers on multiple threads.
+    // Every thread folds its own parts of the sequence, starting from the identity, and the partial results are
+    // combined in a fixed order that only depends on the length. Floating-point results are therefore the same on every
+    // run, regardless of the number of threads, though they may differ from those of `Seq::reduce`. Every other
+    // sequence is folded sequentially.
+    // Parameter identity is the accumulator every partial result starts from, e.g. 0 for sums or 1 for products.
+    // Parameter step has signature `(T, typeOf[identity]) -> typeOf[identity]`.
+    // Parameter combine has signature `(typeOf[identity], typeOf[identity]) -> typeOf[identity]` and must be
+    // associative.
+    // Parameter threads is the number of threads to use, including the calling one. 0 means one per hardware thread.
+    template<typename Accumulator, typename Step, typename Combine>
+    inline auto reduceParallel(Accumulator&& identity, Step&& step, Combine&& combine, std::size_t threads = 0)
+    {
+        return _internal::Fused::Fold(
+            [identity = std::forward<Accumulator>(identity),
+             step     = std::forward<Step>(step),
+             combine  = std::forward<Combine>(combine),
+             threads]<typename Sequence>(Sequence&& sequence) -> std::decay_t<Accumulator>
+            {
+                _internal::ThreadPool& pool = _internal::ThreadPool::withThreads(threads);
+                return _internal::ParallelReduce::reduce(std::forward<Sequence>(sequence),
+                                                         pool,
+                                                         identity,
+                                                         step,
+                                                         combine);
+            });
     }
 
+    // `Seq::skip` returns all elements of the sequence except the first count ones.
+    // Contiguous containers jump ahead instead of iterating over the skipped elements.
     inline auto skip(std::size_t count)
     {
-        return [count]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
-        {
-            return _internal::skipNoCapture(std::move(sequence), count);
-        };
+        return _internal::Fused::SkipStage(count);
+    }
+
+    // `Seq::skipWhile` bypasses elements as long as they satisfy the predicate, then returns the remaining ones.
+    // Parameter pred has signature `(T) -> bool`.
+    template<typename Predicate>
+    inline auto skipWhile(Predicate&& pred)
+    {
+        return _internal::Fused::SkipWhileStage(std::forward<Predicate>(pred));
     }
 
+    // `Seq::sort` sorts the elements in ascending order.
+    // Elements are sorted as they are pulled, so taking only the first k of n elements costs O(n + k log k).
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO>
     inline auto sort()
     {
         return []<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
         {
-            const auto compare = [](const auto& a, const auto& b) -> bool
+            const auto keyOf = [](const T& elem) -> const T&
             {
-                return a < b;
+                return elem;
             };
 
-            return _internal::sortElementsBy(std::move(sequence), compare);
+            const _internal::SizeHint hint = sequence.sizeHint().sortedAscending();
+            return _internal::sortElementsBy<Backend, false>(std::move(sequence), keyOf).withSizeHint(hint);
         };
     }
 
-    template<typename Mapping>
+    // `Seq::sortBy` sorts the elements in ascending order of the key they are mapped to.
+    // Keys are computed once per element and elements are never copied while sorting, see `Seq::_internal::Ordering`.
+    // Ties can be broken by further keys with `.thenBy(mapping)` or `.thenByDescending(mapping)`.
+    // Parameter mapping has signature `(T) -> U`.
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO, typename Mapping>
     inline auto sortBy(Mapping&& mapping)
     {
-        return [mapping = std::forward<Mapping>(mapping)]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
-        {
-            using U       = _internal::TypeInspect::ReturnValueOf<Mapping, T>;
-            using PairedT = std::pair<T, U>;
-
-            IEnumerable<PairedT> mappedSequence =
-                sequence | Seq::map([mapping](const auto& elem) { return std::make_pair(elem, mapping(elem)); });
-
-            const auto compare = [](const auto& pair1, const auto& pair2) -> bool
-            {
-                const U prop1 = std::get<1>(pair1);
-                const U prop2 = std::get<1>(pair2);
-
-                return prop1 < prop2;
-            };
-
-            return _internal::sortElementsBy<true, PairedT, T>(std::move(mappedSequence), compare);
-        };
+        return _internal::Ordering::orderBy<Backend, false, false>(std::forward<Mapping>(mapping));
     }
 
-    template<typename Mapping>
+    // `Seq::sortByDescending` sorts the elements in descending order of the key they are mapped to.
+    // Ties can be broken by further keys with `.thenBy(mapping)` or `.thenByDescending(mapping)`.
+    // Parameter mapping has signature `(T) -> U`.
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO, typename Mapping>
     inline auto sortByDescending(Mapping&& mapping)
     {
-        return [mapping = std::forward<Mapping>(mapping)]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
-        {
-            using U       = _internal::TypeInspect::ReturnValueOf<Mapping, T>;
-            using PairedT = std::pair<T, U>;
-
-            IEnumerable<PairedT> mappedSequence =
-                sequence | Seq::map([mapping](const auto& elem) { return std::make_pair(elem, mapping(elem)); });
-
-            const auto compare = [](const auto& pair1, const auto& pair2) -> bool
-            {
-                const U prop1 = std::get<1>(pair1);
-                const U prop2 = std::get<1>(pair2);
-
-                return prop1 > prop2;
-            };
-
-            return _internal::sortElementsBy<true, PairedT, T>(std::move(mappedSequence), compare);
-        };
+        return _internal::Ordering::orderBy<Backend, false, true>(std::forward<Mapping>(mapping));
     }
 
+    // `Seq::sortDescending` sorts the elements in descending order.
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO>
     inline auto sortDescending()
     {
         return []<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
         {
-            const auto compare = [](const auto& a, const auto& b) -> bool
+            const auto keyOf = [](const T& elem) -> const T&
             {
-                return a > b;
+                return elem;
             };
 
-            return _internal::sortElementsBy(std::move(sequence), compare);
+            const _internal::SizeHint hint = sequence.sizeHint().elementwise();
+            return _internal::sortElementsBy<Backend, true>(std::move(sequence), keyOf).withSizeHint(hint);
         };
     }
 
+    // `Seq::stableSortBy` is `Seq::sortBy`, except that elements with equal keys keep their original order.
+    // Parameter mapping has signature `(T) -> U`.
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO, typename Mapping>
+    inline auto stableSortBy(Mapping&& mapping)
+    {
+        return _internal::Ordering::orderBy<Backend, true, false>(std::forward<Mapping>(mapping));
+    }
+
+    // `Seq::stableSortByDescending` is `Seq::sortByDescending`, except that elements with equal keys keep their
+    // original order.
+    // Parameter mapping has signature `(T) -> U`.
+    // Parameter Backend selects the sorting algorithm, see `Seq::SortBackend`.
+    template<SortBackend Backend = SortBackend::AUTO, typename Mapping>
+    inline auto stableSortByDescending(Mapping&& mapping)
+    {
+        return _internal::Ordering::orderBy<Backend, true, true>(std::forward<Mapping>(mapping));
+    }
+
     // `Seq::sum` returns the sum of the sequence. Supports integrals, float and double.
     // By default it will use the T type of the sequence unless T is smaller than 4 bytes.
     // In those case (e.g. int16_t, char or bool) it uses int32_t.
     // If you know that an overflow will occur you can change UserOverride to a larger type.
-    template<typename UserOverride = void>
+    // Parameter Mode selects the summation strategy of floating-point elements, see `Seq::Summation`.
+    template<typename UserOverride = void, Summation Mode = Summation::FAST>
     inline auto sum()
     {
         using _internal::TypeInspect::EnsureIsSummable;
         using _internal::TypeInspect::FallbackSumInitial;
 
-        return []<EnsureIsSummable T>(IEnumerable<T> sequence) -> auto
-        {
-            if constexpr (EnsureIsSummable<UserOverride>)
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> auto
             {
-                static_assert(sizeof(UserOverride) >= sizeof(T),
-                              "UserOverride type in Seq::sum cannot be smaller than the input's T type");
+                using T = _internal::Fused::ItemOf<Sequence>;
+                static_assert(EnsureIsSummable<T>, "Seq::sum only supports integrals, float and double");
 
-                return _internal::sum(std::move(sequence), UserOverride{});
-            }
-            else
-            {
-                return _internal::sum(std::move(sequence), FallbackSumInitial<T>{});
-            }
-        };
+                if constexpr (EnsureIsSummable<UserOverride>)
+                {
+                    static_assert(sizeof(UserOverride) >= sizeof(T),
+                                  "UserOverride type in Seq::sum cannot be smaller than the input's T type");
+
+                    return _internal::Kernels::sum<Mode, T, UserOverride>(std::forward<Sequence>(sequence));
+                }
+                else
+                {
+                    return _internal::Kernels::sum<Mode, T, FallbackSumInitial<T>>(std::forward<Sequence>(sequence));
+                }
+            });
     }
 
     // `Seq::tail` returns all elements of the sequence EXCEPT the first one.
     inline auto tail()
     {
-        return []<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
-        {
-            std::size_t index = 0;
+        return _internal::Fused::SkipStage(1);
+    }
 
-            for (const auto& elem : sequence)
-            {
-                if (index != 0)
-                {
-                    co_yield elem;
-                }
+    // `Seq::take` returns the first count elements of the sequence or all of them if there are less.
+    // It stops pulling from the upstream sequence as soon as the limit is reached, a limit of zero pulls nothing.
+    inline auto take(std::size_t count)
+    {
+        return _internal::Fused::TakeStage(count);
+    }
 
-                ++index;
-            }
-        };
+    // `Seq::takeWhile` returns elements of the sequence as long as they satisfy the predicate.
+    // It stops pulling from the upstream sequence at the first element that fails.
+    // Parameter pred has signature `(T) -> bool`.
+    template<typename Predicate>
+    inline auto takeWhile(Predicate&& pred)
+    {
+        return _internal::Fused::TakeWhileStage(std::forward<Predicate>(pred));
     }
 
-    inline auto take(std::size_t count)
+    // `Seq::topK` returns the count elements with the largest keys, largest first.
+    // Elements with equal keys keep their original order.
+    // Unlike `Seq::sortByDescending` followed by `Seq::take` it only ever holds count elements in memory.
+    // Parameter mapping has signature `(T) -> U`.
+    template<typename Mapping>
+    inline auto topK(std::size_t count, Mapping&& mapping)
     {
-        return [count]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
+        return [count, mapping = std::forward<Mapping>(mapping)]<typename T>(IEnumerable<T> sequence) -> IEnumerable<T>
         {
-            return _internal::takeNoCapture(std::move(sequence), count);
+            const _internal::SizeHint hint = sequence.sizeHint().elementwise().takeFirst(count);
+            return _internal::topElementsBy(std::move(sequence), count, mapping).withSizeHint(hint);
         };
     }
 
+    // `Seq::toOstream` consumes a sequence by writing its elements to the stream, with the separator between them.
+    // Returns the number of elements written.
+    // Elements are collected in a buffer of a fixed size that is written whenever it runs full, so the memory used
+    // stays the same no matter how long the sequence is. Text and numbers are written by the buffer itself, any other
+    // element by its `operator<<`. So are numbers when the stream has flags, a field width or a locale set that would
+    // print them differently, floating-point numbers otherwise keep the precision of the stream.
+    // Failed writes set the flags of the stream like any other write to it.
+    inline auto toOstream(std::ostream& stream, std::string_view separator)
+    {
+        return _internal::Fused::Fold(
+            [stream = &stream, separator = std::string(separator)]<typename Sequence>(Sequence&& sequence)
+                -> std::size_t
+            {
+                return _internal::Writing::ostream(std::forward<Sequence>(sequence), *stream, separator);
+            });
+    }
+
     // `Seq::toString` consumes a char sequence by returning its string representation.
     // The initially reserved capacity and shrink parameters are configurable.
+    // If the length of the sequence is known up front, exactly that much is reserved instead.
     template<std::size_t InitialReserve = 16, bool EnableShrink = false>
     inline auto toString()
     {
         return [](IEnumerable<char> sequence) -> std::string
         {
+            const _internal::SizeHint hint = sequence.sizeHint();
+
             std::string out;
-            out.reserve(InitialReserve);
+            out.reserve(hint.isExact() ? hint.size() : InitialReserve);
 
             for (const auto& elem : sequence)
             {
@@ -504,26 +1134,109 @@ namespace Seq
 
     // `Seq::toVector` consumes a sequence by returning its vector representation.
     // The initially reserved capacity and shrink parameters are configurable.
+    // If the length of the sequence is known up front, exactly that much is reserved instead.
+    // Elements of move-only types are moved out of the sequence instead of being copied.
     // You might want to look at `Seq::toString` if you have a char sequence.
     template<std::size_t InitialReserve = 16, bool EnableShrink = false>
     inline auto toVector()
     {
-        return []<typename T>(IEnumerable<T> sequence) -> std::vector<T>
+        return _internal::Fused::Fold(
+            []<typename Sequence>(Sequence&& sequence) -> auto
+            {
+                using T = _internal::Fused::ItemOf<Sequence>;
+
+                const _internal::SizeHint hint = _internal::hintOf(sequence);
+
+                std::vector<T> out;
+                out.reserve(hint.isExact() ? hint.size() : InitialReserve);
+
+                if constexpr (_internal::Fused::EnsureIsBlockwise<Sequence>)
+                {
+                    auto appendBlock = [&out](const auto& block) -> bool
+                    {
+                        out.insert(out.end(), block.begin(), block.end());
+                        return true;
+                    };
+
+                    sequence.runBlocks(appendBlock);
+                }
+                else
+                {
+                    _internal::Fused::forEach(std::forward<Sequence>(sequence),
+                                              [&out](auto&& elem) -> bool
+                                              {
+                                                  out.emplace_back(std::forward<decltype(elem)>(elem));
+                                                  return true;
+                                              });
+                }
+
+                if constexpr (EnableShrink)
+                {
+                    out.shrink_to_fit();
+                }
+
+                return out;
+            });
+    }
+
+    // `Seq::toVectorAsync` consumes an `AsyncEnumerable<T>` by returning a `Seq::Task` of its vector representation.
+    // Elements of move-only types are moved out of the sequence instead of being copied.
+    inline auto toVectorAsync()
+    {
+        return []<typename T>(AsyncEnumerable<T> sequence) -> Task<std::vector<T>>
         {
-            std::vector<T> out;
-            out.reserve(InitialReserve);
+            return _internal::Async::collect(std::move(sequence));
+        };
+    }
 
-            for (const auto& elem : sequence)
-            {
-                out.emplace_back(elem);
-            }
+    // `Seq::unionWith` returns the distinct elements of both sequences, first those of the input, then the new ones of
+    // the other sequence. Sorted sequences are merged instead, which keeps the result sorted (see `Seq::SetStrategy`).
+    // Sequences passed as lvalue containers are borrowed, so they have to outlive the result.
+    // Parameter Strategy selects the algorithm, see `Seq::SetStrategy`.
+    // Parameter hash has signature `(T) -> std::size_t` and defaults to `std::hash<T>`.
+    template<SetStrategy Strategy = SetStrategy::AUTO, typename Other, typename Hash = _internal::FlatHash::StdHash>
+    inline auto unionWith(Other&& other, Hash hash = {})
+    {
+        using _internal::SetOps::Operation;
+        return _internal::SetOps::makeSetOperation<Operation::UNION, Strategy>(std::forward<Other>(other), hash);
+    }
 
-            if constexpr (EnableShrink)
+    // `Seq::windowed` returns every run of the given number of consecutive elements, each one element further than the
+    // one before. Sequences shorter than a window have no windows at all.
+    // Windows of a contiguous container are views into it like the chunks of `Seq::chunkBySize`. Windows of any other
+    // sequence are a `std::span<const T>` into a ring buffer and only valid until the next window is requested.
+    inline auto windowed(std::size_t size)
+    {
+        return _internal::Windowing::Runs<true>(size);
+    }
+
+    // `Seq::writeBinary` consumes a sequence of records by writing their bytes to a file, which is created or
+    // truncated first. T has to be trivially copyable, the file can be read back by `Seq::mmapRecords<T>`.
+    // Returns the number of records written.
+    // Records are collected in a buffer of a fixed size, while contiguous containers are written at once without
+    // being copied. Records neither have to be default constructible nor are they staged on the stack.
+    // Throws `std::system_error` if the file cannot be created or written.
+    inline auto writeBinary(const std::filesystem::path& path)
+    {
+        return _internal::Fused::Fold(
+            [path]<typename Sequence>(Sequence&& sequence) -> std::size_t
             {
-                out.shrink_to_fit();
-            }
+                return _internal::Writing::binary(std::forward<Sequence>(sequence), path);
+            });
+    }
 
-            return out;
-        };
+    // `Seq::writeLines` consumes a sequence by writing each element as a line of a text file, which is created or
+    // truncated first. Elements can be text (anything convertible to `std::string_view`), characters or numbers.
+    // Returns the number of lines written.
+    // Lines are collected in a buffer of a fixed size that is written whenever it runs full, so the memory used stays
+    // the same no matter how long the sequence is.
+    // Throws `std::system_error` if the file cannot be created or written.
+    inline auto writeLines(const std::filesystem::path& path)
+    {
+        return _internal::Fused::Fold(
+            [path]<typename Sequence>(Sequence&& sequence) -> std::size_t
+            {
+                return _internal::Writing::lines(std::forward<Sequence>(sequence), path);
+            });
     }
 }
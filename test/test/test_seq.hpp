@@ -1,9 +1,31 @@
 #pragma once
 #include "seq/seq.hpp"
+#include "utils/alloc_counter.hpp"
 #include "utils/assert.hpp"
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -11,11 +33,246 @@
 
 namespace SeqTest
 {
+    static void asyncEnumerable()
+    {
+        using namespace std::chrono_literals;
+
+        // A source that has to wait for every element it yields
+        const auto ticks = [](Seq::EventLoop* loop, int count, Seq::EventLoop::Duration period) -> AsyncEnumerable<int>
+        {
+            for (int tick = 0; tick < count; ++tick)
+            {
+                co_await loop->sleep(period);
+                co_yield tick;
+            }
+        };
+
+        const auto sumOf = [](AsyncEnumerable<int> sequence) -> Seq::Task<int>
+        {
+            int total = 0;
+
+            while (true)
+            {
+                const bool hasNext = co_await sequence.next();
+
+                if (!hasNext)
+                {
+                    break;
+                }
+
+                total += sequence.current();
+            }
+
+            co_return total;
+        };
+
+        Seq::EventLoop loop;
+        Assert::equal(loop.run(sumOf(ticks(&loop, 5, 10ms))), 10);
+        Assert::truthy(loop.now() == 50ms);
+
+        // Stages work on them as they are, `Seq::take` stops resuming the source once it has enough
+        const auto isOdd  = [](int x) { return x % 2 != 0; };
+        const auto square = [](int x) { return x * x; };
+
+        auto oddSquares = ticks(&loop, 1000, 1ms) | Seq::filter(isOdd) | Seq::map(square) | Seq::take(3);
+        Assert::equal(loop.run(std::move(oddSquares) | Seq::toVectorAsync()), {1, 9, 25});
+        Assert::truthy(loop.now() == 56ms);
+
+        // Pipelines waiting on their sources interleave on a single thread, both are done once the slower one is
+        {
+            Seq::EventLoop shared;
+            std::vector<std::string> events;
+
+            const auto logAs = [&events](std::string name)
+            {
+                return [&events, name](int tick) { events.push_back(name + " " + std::to_string(tick)); };
+            };
+
+            Seq::Task<void> fast = ticks(&shared, 4, 10ms) | Seq::iterAsync(logAs("fast"));
+            Seq::Task<void> slow = ticks(&shared, 2, 25ms) | Seq::iterAsync(logAs("slow"));
+
+            shared.spawn(fast);
+            shared.spawn(slow);
+            shared.run();
+
+            Assert::truthy(fast.isDone() && slow.isDone());
+            Assert::truthy(shared.now() == 50ms);
+            Assert::equal(events, {"fast 0", "fast 1", "slow 0", "fast 2", "fast 3", "slow 1"});
+        }
+
+        // Exceptions escaping the source reach the consumer waiting for the next element
+        const auto failing = []() -> AsyncEnumerable<int>
+        {
+            co_yield 1;
+            throw std::runtime_error("source closed");
+        };
+
+        Assert::throws<std::runtime_error>([&] { loop.run(failing() | Seq::toVectorAsync()); });
+    }
+
+    static void aggregateParallel()
+    {
+        const auto addTo = [](std::vector<int>& histogram, int x)
+        {
+            ++histogram[x % 10];
+        };
+
+        const auto merge = [](std::vector<int>& histogram, const std::vector<int>& other)
+        {
+            for (std::size_t digit = 0; digit < histogram.size(); ++digit)
+            {
+                histogram[digit] += other[digit];
+            }
+        };
+
+        const auto histogramOf = [&addTo, &merge](const auto& sequence, std::size_t threads = 0)
+        {
+            return sequence | Seq::aggregateParallel(std::vector<int>(10), addTo, merge, threads);
+        };
+
+        // Random-access containers are split, other sequences are aggregated on the calling thread
+
+        {
+            const std::vector<int> expected(10, 10'000);
+
+            std::vector<int> numbers(100'000);
+            std::iota(numbers.begin(), numbers.end(), 0);
+            const std::deque<int> queued(numbers.begin(), numbers.end());
+
+            for (const std::size_t threads : {1ul, 2ul, 4ul})
+            {
+                Assert::truthy(histogramOf(numbers, threads) == expected);
+                Assert::truthy(histogramOf(queued, threads) == expected);
+            }
+
+            Assert::truthy(histogramOf(Seq::range(100'000)) == expected);
+        }
+
+        // Empty sequences leave the identity as it is
+
+        {
+            Assert::truthy(histogramOf(std::vector<int>()) == std::vector<int>(10));
+        }
+    }
+
+    static void average()
+    {
+        const std::vector<int> grades = {2, 3, 5, 4};
+        const auto gradeAverage       = grades | Seq::average();
+
+        Assert::truthy(gradeAverage.has_value());
+        Assert::equal(*gradeAverage, 3.5);
+
+        const auto rangeAverage = Seq::range(1, 1001) | Seq::map([](int x) { return static_cast<float>(x); })
+                                  | Seq::average<Seq::Summation::PAIRWISE>();
+
+        Assert::equal(*rangeAverage, 500.5f);
+        Assert::falsey((std::vector<double>{} | Seq::average()).has_value());
+    }
+
+    static void batched()
+    {
+        const std::vector<int> numbers = Seq::range(0, 100) | Seq::toVector();
+
+        const auto isEven  = [](int x) { return x % 2 == 0; };
+        const auto doubled = [](int x) { return x * 2; };
+
+        // Blocks do not line up with the stages, nor with where `Seq::take` stops
+        Assert::equal((numbers | Seq::batched<8>() | Seq::filter(isEven) | Seq::take(13) | Seq::toVector()),
+                      {0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24});
+        Assert::equal((numbers | Seq::batched<4>() | Seq::take(8) | Seq::map(doubled) | Seq::toVector()),
+                      {0, 2, 4, 6, 8, 10, 12, 14});
+        Assert::equal((numbers | Seq::batched<7>() | Seq::skip(95) | Seq::toVector()), {95, 96, 97, 98, 99});
+
+        Assert::equal(numbers | Seq::batched<16>() | Seq::map(doubled) | Seq::sum(), 9900);
+        Assert::equal<std::size_t>(numbers | Seq::batched<16>() | Seq::count(isEven), 50ul);
+        Assert::equal<std::size_t>(numbers | Seq::batched<16>() | Seq::filter(isEven) | Seq::length(), 50ul);
+        Assert::equal(*(numbers | Seq::batched<16>() | Seq::map(doubled) | Seq::max()), 198);
+
+        // Sources without contiguous storage are read into blocks, stages in front of the mode stay fused
+        Assert::equal((Seq::range(0, 10) | Seq::batched<3>() | Seq::filter(isEven) | Seq::toVector()), {0, 2, 4, 6, 8});
+        Assert::equal((numbers | Seq::map(doubled) | Seq::batched<5>() | Seq::takeWhile([](int x) { return x < 9; })
+                       | Seq::toVector()),
+                      {0, 2, 4, 6, 8});
+
+        const std::string sentence = "batched mode";
+        Assert::equal(sentence | Seq::batched<4>() | Seq::filter([](char c) { return c != ' '; }) | Seq::toString(),
+                      std::string("batchedmode"));
+
+        // Other operators get single elements again
+        IEnumerable<int> evens = numbers | Seq::batched<32>() | Seq::filter(isEven);
+        Assert::equal((std::move(evens) | Seq::skip(47) | Seq::toVector()), {94, 96, 98});
+        Assert::equal((numbers | Seq::batched<32>() | Seq::take(3) | Seq::pairwise() | Seq::toVector()),
+                      {{0, 1}, {1, 2}});
+
+        Assert::equal((std::vector<int>{} | Seq::batched() | Seq::map(doubled) | Seq::toVector()), {});
+
+        // Blocks of booleans, which `std::vector<bool>` would pack into bits
+        const std::vector<bool> parities = numbers | Seq::batched<16>() | Seq::map(isEven) | Seq::toVector();
+        Assert::truthy(parities == (numbers | Seq::map(isEven) | Seq::toVector()));
+
+        const auto isOdd = std::logical_not();
+        Assert::equal<std::size_t>(parities | Seq::batched<16>() | Seq::filter(isOdd) | Seq::length(), 50ul);
+        Assert::truthy((parities | Seq::batched<16>() | Seq::take(3) | Seq::pairwise() | Seq::toVector())
+                       == std::vector<std::pair<bool, bool>>{{true, false}, {false, true}});
+    }
+
+    static void borrow()
+    {
+        // Lvalue containers are borrowed, not copied into the pipeline
+
+        {
+            std::vector<int> bigVector(10'000, 1);
+            const std::string bigText(10'000, 'x');
+
+            // First run fills the frame caches of this thread
+            Assert::equal<std::size_t>(bigVector | Seq::length(), 10'000ul);
+
+            const std::size_t before       = AllocCounter::count();
+            const std::size_t vectorLength = bigVector | Seq::length();
+            const std::size_t textLength   = bigText | Seq::length();
+
+            Assert::equal<std::size_t>(vectorLength, 10'000ul);
+            Assert::equal<std::size_t>(textLength, 10'000ul);
+
+#ifndef SEQ_DISABLE_FRAME_POOL
+            Assert::equal<std::size_t>(AllocCounter::count() - before, 0ul);
+#endif
+
+            // A borrowed source observes changes made before the pipeline is consumed
+            std::vector<int> numbers = {1, 2, 3};
+            auto doubled             = numbers | Seq::map([](int n) { return n * 2; });
+            numbers[0]               = 10;
+
+            Assert::equal(doubled | Seq::toVector(), {20, 4, 6});
+
+            const std::list<int> linkedNumbers = {1, 2, 3};
+            Assert::equal(linkedNumbers | Seq::sum(), 6);
+        }
+
+        // Temporaries are owned by the pipeline and outlive the full expression that created them
+
+        {
+            const auto makeFruits = []
+            {
+                return std::vector<std::string>{"Apple", "Banana", "Orange"};
+            };
+
+            auto initials = makeFruits() | Seq::map([](const std::string& fruit) { return fruit.front(); });
+            auto slices   = std::string("watermelon") | Seq::skip(5);
+
+            Assert::equal(initials | Seq::toString(), std::string("ABO"));
+            Assert::equal(slices | Seq::toString(), std::string("melon"));
+        }
+    }
+
     static void chunkBySize()
     {
+        const auto asVector = [](std::span<const int> chunk) { return std::vector<int>(chunk.begin(), chunk.end()); };
+
         auto firstFiveInteger = {1, 2, 3, 4, 5};
 
-        auto everyTwoItems = firstFiveInteger | Seq::chunkBySize(2) | Seq::toVector();
+        auto everyTwoItems = firstFiveInteger | Seq::chunkBySize(2) | Seq::map(asVector) | Seq::toVector();
 
         Assert::equal(everyTwoItems,
                       {
@@ -28,7 +285,34 @@ namespace SeqTest
 
         auto eachDigit = numericText | Seq::chunkBySize(1) | Seq::toVector();
 
-        Assert::equal(eachDigit, {{'1'}, {'2'}, {'3'}, {'4'}, {'5'}});
+        Assert::equal(eachDigit, {"1", "2", "3", "4", "5"});
+
+        // Chunks of contiguous containers point into the container
+        const std::vector<int> numbers = {1, 2, 3, 4, 5, 6, 7};
+        const auto chunks              = numbers | Seq::chunkBySize(3) | Seq::toVector();
+
+        Assert::truthy(chunks[1].data() == numbers.data() + 3);
+        Assert::equal<std::size_t>(chunks.back().size(), 1ul);
+        Assert::equal((numbers | Seq::skip(4) | Seq::chunkBySize(2) | Seq::map(asVector) | Seq::toVector()),
+                      {{5, 6}, {7}});
+
+        // Anything else is read into a buffer that is reused for every chunk
+        Assert::equal((Seq::range(1, 8) | Seq::chunkBySize(3) | Seq::map(asVector) | Seq::toVector()),
+                      {{1, 2, 3}, {4, 5, 6}, {7}});
+
+        const auto chunkRange = [](int length) { Seq::range(0, length) | Seq::chunkBySize(4) | Seq::length(); };
+
+        AllocCounter::countFor(chunkRange, 1);
+        Assert::equal(AllocCounter::countFor(chunkRange, 16), AllocCounter::countFor(chunkRange, 4000));
+
+        // Chunks of booleans, which `std::vector<bool>` would pack into bits
+        const auto isEven = [](int x) { return x % 2 == 0; };
+        const auto trues  = [](std::span<const bool> chunk) { return std::ranges::count(chunk, true); };
+
+        Assert::truthy((Seq::range(0, 10) | Seq::map(isEven) | Seq::chunkBySize(4) | Seq::map(trues) | Seq::toVector())
+                       == std::vector<std::ptrdiff_t>{2, 2, 1});
+
+        Assert::throws<std::invalid_argument>([] { Seq::chunkBySize(0); });
     }
 
     static void contains()
@@ -51,6 +335,126 @@ namespace SeqTest
         Assert::equal(largerThanSix, 0ul);
     }
 
+    static void countBy()
+    {
+        const std::vector<std::string> words = {"pear", "fig", "plum", "kiwi", "apple", "yam", "date"};
+
+        const auto wordLength = [](const std::string& word) { return word.size(); };
+        const auto byLength   = words | Seq::countBy(wordLength) | Seq::toVector();
+        Assert::truthy(byLength == std::vector<std::pair<std::size_t, std::size_t>>{{4, 4}, {3, 2}, {5, 1}});
+
+        // The table grows far beyond its initial size on a streamed source without a length
+        const auto remainders = Seq::range(200'000)
+                                | Seq::filter([](int n) { return n % 2 == 0; })
+                                | Seq::countBy([](int n) { return n % 50'000; })
+                                | Seq::toVector();
+
+        Assert::equal(remainders.size(), 25'000ul);
+        Assert::truthy(remainders | Seq::forall([](const auto& pair) { return pair.second == 4; }));
+        Assert::equal(remainders.back().first, 49'998);
+    }
+
+    static void distinct()
+    {
+        const std::vector<int> numbers = {3, 1, 3, 3, 2, 1, 5};
+        Assert::equal((numbers | Seq::distinct() | Seq::toVector()), {3, 1, 2, 5});
+        Assert::equal((std::vector<int>{} | Seq::distinct() | Seq::toVector()), {});
+
+        // A custom hash, even a terrible one, only changes the speed
+        const auto collidingHash = [](int n) -> std::size_t { return static_cast<std::size_t>(n % 3); };
+        Assert::equal((Seq::range(3'000) | Seq::map([](int n) { return n % 700; }) | Seq::distinct(collidingHash)
+                       | Seq::length()),
+                      700ul);
+
+        // Streams, so it works on unbounded sequences as long as enough distinct elements follow
+        const auto firstSquaresModTen = Seq::range(1'000'000'000)
+                                        | Seq::map([](int n) { return (n * n) % 10; })
+                                        | Seq::distinct()
+                                        | Seq::take(6)
+                                        | Seq::toVector();
+
+        Assert::equal(firstSquaresModTen, {0, 1, 4, 9, 6, 5});
+    }
+
+    static void distinctBy()
+    {
+        const std::vector<std::string> words = {"pear", "fig", "plum", "kiwi", "apple", "yam", "date"};
+
+        const auto firstOfEachLength =
+            words | Seq::distinctBy([](const std::string& word) { return word.size(); }) | Seq::toVector();
+        Assert::equal(firstOfEachLength, {"pear", "fig", "apple"});
+
+        const auto firstOfEachInitial =
+            words | Seq::distinctBy([](const std::string& word) { return std::string(1, word.front()); })
+            | Seq::toVector();
+        Assert::equal(firstOfEachInitial, {"pear", "fig", "kiwi", "apple", "yam", "date"});
+    }
+
+    static void except()
+    {
+        const std::vector<int> numbers = {5, 3, 9, 3, 1, 5, 7};
+        const std::vector<int> unlucky = {9, 13, 1};
+
+        // Distinct elements in their original order
+        Assert::equal((numbers | Seq::except(unlucky) | Seq::toVector()), {5, 3, 7});
+        Assert::equal((numbers | Seq::except(std::vector<int>{}) | Seq::toVector()), {5, 3, 9, 1, 7});
+
+        // Sorted sequences are merged, the result stays sorted
+        const auto merged = numbers | Seq::sort() | Seq::except(Seq::range(0, 8, 2)) | Seq::toVector();
+        Assert::equal(merged, {1, 3, 5, 7, 9});
+        const auto forced = Seq::except<Seq::SetStrategy::MERGE>(std::vector<int>{1, 3});
+        Assert::equal((numbers | Seq::sort() | forced | Seq::toVector()), {5, 7, 9});
+
+        // Large arguments are checked against a Bloom filter first, which must never drop an element
+        const auto odd = Seq::range(200'000) | Seq::except<Seq::SetStrategy::HASH>(Seq::range(0, 200'000, 2))
+                       | Seq::toVector();
+
+        Assert::equal(odd.size(), 100'000ul);
+        Assert::truthy(odd | Seq::forall([](int n) { return n % 2 == 1; }));
+    }
+
+    static void exceptions()
+    {
+        const auto yieldThenFail = []() -> IEnumerable<int>
+        {
+            co_yield 1;
+            co_yield 2;
+            throw std::runtime_error("source failed");
+        };
+
+        const auto failImmediately = []() -> IEnumerable<int>
+        {
+            throw std::logic_error("source failed");
+            co_return;
+        };
+
+        // Exceptions escaping a coroutine reach the consumer instead of ending the sequence early
+        Assert::throws<std::runtime_error>([&] { yieldThenFail() | Seq::toVector(); });
+        Assert::throws<std::logic_error>([&] { failImmediately() | Seq::isEmpty(); });
+
+        // Elements yielded before the exception are still seen
+        std::vector<int> seen;
+        Assert::throws<std::runtime_error>([&] { yieldThenFail() | Seq::iter([&seen](int n) { seen.push_back(n); }); });
+        Assert::equal(seen, {1, 2});
+
+        // Stages running inside coroutines of their own pass exceptions through as well
+        const auto failOnThree = [](int n)
+        {
+            if (n == 3)
+            {
+                throw std::out_of_range("three");
+            }
+
+            return n;
+        };
+
+        Assert::throws<std::out_of_range>(
+            [&]
+            {
+                Seq::range(10) | Seq::map(failOnThree) | Seq::pairwise() | Seq::toVector();
+            });
+    }
+
     static void exists()
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
@@ -62,6 +466,125 @@ namespace SeqTest
         Assert::falsey(hasDividableBySix);
     }
 
+    static void externalSort()
+    {
+        const auto spilledRuns = []
+        {
+            return std::ranges::count_if(std::filesystem::directory_iterator(std::filesystem::temp_directory_path()),
+                                         [](const auto& entry)
+                                         { return entry.path().filename().string().starts_with("seq-spill-"); });
+        };
+
+        const auto runsBefore = spilledRuns();
+
+        std::mt19937 generator(3);
+        std::uniform_int_distribution<int> ints(-500, 500);
+
+        std::vector<int> numbers(20'000);
+        std::generate(numbers.begin(), numbers.end(), [&] { return ints(generator); });
+
+        auto ascending = numbers;
+        std::sort(ascending.begin(), ascending.end());
+
+        // A budget of 4 KiB holds 1024 ints, so the numbers are spread over 20 runs on disk
+        Assert::truthy((numbers | Seq::externalSort(4096) | Seq::toVector()) == ascending);
+        Assert::truthy((numbers | Seq::externalSortDescending(4096) | Seq::toVector())
+                       == std::vector<int>(ascending.rbegin(), ascending.rend()));
+
+        // Budgets below a few elements still fill runs of 64, whose 313 runs are merged in more than one pass
+        Assert::truthy((numbers | Seq::externalSort(1) | Seq::toVector()) == ascending);
+
+        // Sequences within the budget are sorted in memory
+        Assert::equal((std::vector{3, 1, 2} | Seq::externalSort(4096) | Seq::toVector()), {1, 2, 3});
+        Assert::equal((std::vector<int>{} | Seq::externalSort(4096) | Seq::toVector()), {});
+
+        // Key projections, merged lazily from disk
+        struct Reading
+        {
+            int sensor;
+            double value;
+        };
+
+        const auto readings = Seq::range(10'000)
+                              | Seq::map([](int n) { return Reading{n, static_cast<double>((n * 37) % 1000)}; })
+                              | Seq::externalSortByDescending(8192,
+                                                              [](const Reading& reading) { return reading.value; })
+                              | Seq::take(3)
+                              | Seq::map([](const Reading& reading) { return reading.value; })
+                              | Seq::toVector();
+
+        Assert::equal(readings, {999.0, 999.0, 999.0});
+
+        // Elements that are not trivially copyable need a serializer
+        struct LengthPrefixed
+        {
+            void write(std::ostream& out, const std::string& word) const
+            {
+                const std::size_t length = word.size();
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(word.data(), static_cast<std::streamsize>(length));
+            }
+
+            auto read(std::istream& in) const -> std::optional<std::string>
+            {
+                std::size_t length = 0;
+
+                if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)))
+                {
+                    return std::nullopt;
+                }
+
+                std::string word(length, '\0');
+                in.read(word.data(), static_cast<std::streamsize>(length));
+                return word;
+            }
+        };
+
+        // Budgets count the element together with its key, these words are spread over five runs
+        const auto wordOf = [](int n)
+        {
+            return std::string(static_cast<std::size_t>(n % 7 + 1), static_cast<char>('a' + n % 26));
+        };
+
+        const auto lengthOf = [](const std::string& word) { return word.size(); };
+        const auto words    = Seq::range(300) | Seq::map(wordOf) | Seq::toVector();
+
+        std::vector<std::size_t> lengths = words | Seq::map(lengthOf) | Seq::toVector();
+        std::ranges::sort(lengths);
+
+        const auto byLength = words
+                              | Seq::externalSortBy(sizeof(std::pair<std::string, std::size_t>) * 64,
+                                                    lengthOf,
+                                                    LengthPrefixed{})
+                              | Seq::map(lengthOf)
+                              | Seq::toVector();
+
+        Assert::truthy(byLength == lengths);
+
+        // Failures while reading runs back reach the consumer
+
+        {
+            struct FailingRead
+            {
+                void write(std::ostream& out, const int& n) const { out.write(reinterpret_cast<const char*>(&n), 4); }
+
+                auto read(std::istream& /*in*/) const -> std::optional<int>
+                {
+                    throw std::runtime_error("Corrupted run");
+                }
+            };
+
+            Assert::throws<std::runtime_error>(
+                [&]
+                {
+                    numbers | Seq::externalSort(4096, FailingRead{}) | Seq::toVector();
+                });
+        }
+
+        // Temporary files are gone once the sorted sequences are
+        Assert::equal(spilledRuns(), runsBefore);
+    }
+
     static void filter()
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
@@ -71,6 +594,33 @@ namespace SeqTest
         Assert::equal(evenNumbers, {2, 4});
     }
 
+    static void filterAsync()
+    {
+        using namespace std::chrono_literals;
+
+        const auto idsOf = [](std::vector<int> ids) -> AsyncEnumerable<int>
+        {
+            for (const int id : ids)
+            {
+                co_yield id;
+            }
+        };
+
+        // Asks a slow service whether the id is allowed
+        const auto isAllowed = [](Seq::EventLoop* loop, int id) -> Seq::Task<bool>
+        {
+            co_await loop->sleep(5ms);
+            co_return id % 3 != 0;
+        };
+
+        Seq::EventLoop loop;
+        const auto askService = [&loop, &isAllowed](int id) { return isAllowed(&loop, id); };
+        auto allowed          = idsOf({1, 2, 3, 4, 5, 6}) | Seq::filterAsync(askService);
+
+        Assert::equal(loop.run(std::move(allowed) | Seq::toVectorAsync()), {1, 2, 4, 5});
+        Assert::truthy(loop.now() == 30ms);
+    }
+
     static void find()
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
@@ -94,6 +644,195 @@ namespace SeqTest
         Assert::truthy(largerThanZero);
     }
 
+    static void framePool()
+    {
+        const auto typicalPipeline = []
+        {
+            return Seq::range(100)
+                   | Seq::filter([](int n) { return n % 3 == 0; })
+                   | Seq::map([](int n) { return n * 2; })
+                   | Seq::take(10)
+                   | Seq::sum();
+        };
+
+        // First run fills the frame caches of this thread
+        Assert::equal(typicalPipeline(), 270);
+
+        const std::size_t before = AllocCounter::count();
+        Assert::equal(typicalPipeline(), 270);
+        const std::size_t allocations = AllocCounter::count() - before;
+
+#ifdef SEQ_DISABLE_FRAME_POOL
+        Assert::truthy(allocations > 0);
+#else
+        Assert::equal<std::size_t>(allocations, 0ul);
+#endif
+
+        // Frames released after the free-lists of their thread are gone still find their way back to the heap
+        struct Holder
+        {
+            std::optional<IEnumerable<int>> sequence;
+        };
+
+        std::thread(
+            []
+            {
+                // Constructed before the free-lists of this thread, so it is destroyed after them
+                thread_local Holder holder;
+                holder.sequence.emplace(Seq::range(10) | Seq::map([](int n) { return n * 2; }));
+            })
+            .join();
+    }
+
+    static void fused()
+    {
+        const std::vector<int> firstTenInteger = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+        // Fused stages over a borrowed container run as a plain loop without a single coroutine frame
+
+        {
+            const std::size_t before = AllocCounter::count();
+
+            const int sumOfEvenSquares = firstTenInteger
+                                         | Seq::filter([](int n) { return n % 2 == 0; })
+                                         | Seq::map([](int n) { return n * n; })
+                                         | Seq::sum();
+
+            Assert::equal(sumOfEvenSquares, 220);
+            Assert::equal<std::size_t>(AllocCounter::count() - before, 0ul);
+        }
+
+        // Folds stop pulling from the source as soon as their result is known
+
+        {
+            int visited = 0;
+
+            const bool hasLargerThanThree = firstTenInteger
+                                            | Seq::map(
+                                                [&visited](int n)
+                                                {
+                                                    ++visited;
+                                                    return n;
+                                                })
+                                            | Seq::exists([](int n) { return n > 3; });
+
+            Assert::truthy(hasLargerThanThree);
+            Assert::equal(visited, 4);
+        }
+
+        // A pipeline can still be type-erased and mixed with operators that are not fused
+
+        {
+            IEnumerable<std::size_t> erased =
+                firstTenInteger | Seq::skip(2) | Seq::mapi([](int n, std::size_t i) { return n * i; });
+
+            Assert::equal(erased | Seq::take(3) | Seq::toVector(), {0, 4, 10});
+
+            auto pipeline = firstTenInteger | Seq::take(4);
+            std::vector<int> iterated;
+
+            for (int n : pipeline)
+            {
+                iterated.emplace_back(n);
+            }
+
+            Assert::equal(iterated, {1, 2, 3, 4});
+            auto largePairs = firstTenInteger
+                              | Seq::filter([](int n) { return n > 8; })
+                              | Seq::pairwise()
+                              | Seq::toVector();
+
+            Assert::equal(largePairs,
+                          {
+                              {9, 10}
+            });
+        }
+    }
+
+    static void groupBy()
+    {
+        struct Order
+        {
+            std::string customer;
+            int amount;
+        };
+
+        const std::vector<Order> orders = {
+            {"mira", 20}, {"jon", 5}, {"mira", 7}, {"ana", 12}, {"jon", 30}, {"mira", 1},
+        };
+
+        const auto byCustomer = orders | Seq::groupBy([](const Order& order) { return order.customer; })
+                                | Seq::map(
+                                    [](const auto& group)
+                                    {
+                                        const auto amountOf = [](const Order& order) { return order.amount; };
+                                        return std::make_pair(group.first,
+                                                              group.second | Seq::map(amountOf) | Seq::toVector());
+                                    })
+                                | Seq::toVector();
+
+        Assert::equal(byCustomer.size(), 3ul);
+        Assert::equal(byCustomer[0].first, std::string("mira"));
+        Assert::equal(byCustomer[0].second, {20, 7, 1});
+        Assert::equal(byCustomer[1].first, std::string("jon"));
+        Assert::equal(byCustomer[1].second, {5, 30});
+        Assert::equal(byCustomer[2].first, std::string("ana"));
+        Assert::equal(byCustomer[2].second, {12});
+
+        // Every element ends up in exactly one group
+        const auto parity = Seq::range(100'001) | Seq::groupBy([](int n) { return n % 2 == 0; }) | Seq::toVector();
+
+        Assert::equal(parity.size(), 2ul);
+        Assert::equal(parity[0].second.size(), 50'001ul);
+        Assert::equal(parity[1].second.size(), 50'000ul);
+        Assert::truthy(std::ranges::is_sorted(parity[1].second));
+    }
+
+    static void groupJoin()
+    {
+        const std::vector<std::pair<int, std::string>> customers = {{1, "ana"}, {2, "jon"}, {3, "mira"}};
+        const std::vector<std::pair<int, int>> orders            = {{3, 20}, {1, 5}, {3, 7}, {4, 9}};
+
+        const auto firstOf = [](const auto& pair) { return pair.first; };
+
+        const auto totals =
+            customers
+            | Seq::groupJoin(orders,
+                             firstOf,
+                             firstOf,
+                             [](const auto& customer, std::span<const std::pair<int, int>> placed)
+                             {
+                                 const auto amountOf = [](const auto& order) { return order.second; };
+                                 return std::make_pair(customer.second, placed | Seq::map(amountOf) | Seq::sum());
+                             })
+            | Seq::toVector();
+
+        // Elements without any match are kept
+        Assert::equal(totals.size(), 3ul);
+        Assert::equal(totals[0], std::make_pair(std::string("ana"), 5));
+        Assert::equal(totals[1], std::make_pair(std::string("jon"), 0));
+        Assert::equal(totals[2], std::make_pair(std::string("mira"), 27));
+    }
+
+    static void intersect()
+    {
+        const std::vector<std::string> monday  = {"ana", "jon", "mira", "jon", "eli"};
+        const std::vector<std::string> tuesday = {"eli", "mira", "tom", "mira"};
+
+        // Distinct elements in their original order
+        Assert::equal((monday | Seq::intersect(tuesday) | Seq::toVector()), {"mira", "eli"});
+        Assert::equal((monday | Seq::intersect(std::vector<std::string>{}) | Seq::toVector()), {});
+
+        // Sorted sequences are merged
+        const auto both = monday | Seq::sort() | Seq::intersect(tuesday | Seq::sort()) | Seq::toVector();
+        Assert::equal(both, {"eli", "mira"});
+
+        const auto multiples = Seq::range(0, 1000, 6) | Seq::intersect(Seq::range(0, 1000, 4)) | Seq::toVector();
+        Assert::equal(multiples.size(), 84ul);
+        Assert::truthy(std::ranges::is_sorted(multiples));
+        Assert::truthy(multiples | Seq::forall([](int n) { return n % 12 == 0; }));
+    }
+
     static void isEmpty()
     {
         const std::initializer_list<int> emptyInitializer = {};
@@ -107,6 +846,88 @@ namespace SeqTest
         Assert::falsey(isNotZeroLength);
     }
 
+    static void iterAsync()
+    {
+        using namespace std::chrono_literals;
+
+        const auto idsOf = [](std::vector<int> ids) -> AsyncEnumerable<int>
+        {
+            for (const int id : ids)
+            {
+                co_yield id;
+            }
+        };
+
+        Seq::EventLoop loop;
+        std::vector<int> seen;
+
+        loop.run(idsOf({1, 2, 3}) | Seq::iterAsync([&seen](int id) { seen.push_back(id); }));
+        Assert::equal(seen, {1, 2, 3});
+
+        // Awaitable actions finish before the next element is requested
+        const auto store = [](Seq::EventLoop* loop, std::vector<int>* stored, int id) -> Seq::Task<void>
+        {
+            co_await loop->sleep(2ms);
+            stored->push_back(id * 10);
+        };
+
+        std::vector<int> stored;
+        const auto storeOne = [&loop, &stored, &store](int id) { return store(&loop, &stored, id); };
+        loop.run(idsOf({1, 2, 3}) | Seq::iterAsync(storeOne));
+
+        Assert::equal(stored, {10, 20, 30});
+        Assert::truthy(loop.now() == 6ms);
+    }
+
+    static void join()
+    {
+        const std::vector<std::pair<int, std::string>> customers = {{1, "ana"}, {2, "jon"}, {3, "mira"}, {3, "mara"}};
+        const std::vector<std::pair<int, int>> orders            = {{3, 20}, {1, 5}, {4, 9}, {1, 7}};
+
+        const auto firstOf = [](const auto& pair) { return pair.first; };
+
+        const auto matched =
+            orders
+            | Seq::join(customers,
+                        firstOf,
+                        firstOf,
+                        [](const auto& order, const auto& customer)
+                        { return customer.second + ":" + std::to_string(order.second); })
+            | Seq::toVector();
+
+        // Outer order first, matches of one element in inner order, elements without a match dropped
+        Assert::equal(matched, {"mira:20", "mara:20", "ana:5", "ana:7"});
+
+        // Inner sides of every kind, partitioned once they are large enough
+        auto halved      = Seq::range(300'000) | Seq::map([](int n) { return std::make_pair(n / 2, n); });
+        const auto found = Seq::range(0, 300'000, 500)
+                         | Seq::join(halved,
+                                     std::identity(),
+                                     firstOf,
+                                     [](int, const std::pair<int, int>& match) { return match.second; })
+                         | Seq::toVector();
+
+        Assert::equal(found.size(), 600ul);
+        Assert::equal(found[0], 0);
+        Assert::equal(found[1], 1);
+        Assert::equal(found[599], 299'001);
+
+        const auto unique = Seq::range(0, 600'000, 1000)
+                          | Seq::join(Seq::range(300'000), std::identity(), std::identity(), std::plus())
+                          | Seq::toVector();
+
+        Assert::equal(unique.size(), 300ul);
+        Assert::equal(unique[299], 598'000);
+
+        const auto owned = std::vector<int>{2, 2, 3} | Seq::join(std::vector<int>{3, 2, 5, 2},
+                                                                 std::identity(),
+                                                                 std::identity(),
+                                                                 [](int lhs, int rhs) { return lhs * 10 + rhs; })
+                           | Seq::toVector();
+
+        Assert::equal(owned, {22, 22, 22, 22, 33});
+    }
+
     static void length()
     {
         const std::initializer_list<int> emptyInitializer = {};
@@ -150,74 +971,589 @@ namespace SeqTest
         }
     }
 
-    static void pairwise()
+    static void mapAsync()
     {
-        auto firstFiveInteger = {1, 2, 3, 4, 5};
-
-        auto integerPairs = firstFiveInteger | Seq::pairwise() | Seq::toVector();
-
-        Assert::equal(integerPairs,
-                      {
-                          {1, 2},
-                          {2, 3},
-                          {3, 4},
-                          {4, 5}
-        });
+        using namespace std::chrono_literals;
 
-        auto onlyOneInteger = {0};
+        const auto idsOf = [](std::vector<int> ids) -> AsyncEnumerable<int>
+        {
+            for (const int id : ids)
+            {
+                co_yield id;
+            }
+        };
+
+        // Looks the name up in a slow service
+        const auto nameOf = [](Seq::EventLoop* loop, int id) -> Seq::Task<std::string>
+        {
+            co_await loop->sleep(5ms);
+            co_return "user" + std::to_string(id);
+        };
 
-        auto noPairs = onlyOneInteger | Seq::pairwise() | Seq::toVector();
+        Seq::EventLoop loop;
+        auto names = idsOf({1, 2, 3}) | Seq::mapAsync([&loop, &nameOf](int id) { return nameOf(&loop, id); });
 
-        Assert::equal(noPairs, {});
+        Assert::equal(loop.run(std::move(names) | Seq::toVectorAsync()), {"user1", "user2", "user3"});
+        Assert::truthy(loop.now() == 15ms);
     }
 
-    static void pairwiseWrap()
+    static void mapParallel()
     {
-        auto firstFiveInteger = {1, 2, 3, 4, 5};
-
-        auto integerPairs = firstFiveInteger | Seq::pairwiseWrap() | Seq::toVector();
+        const auto square = [](int x) -> int64_t
+        {
+            return int64_t{x} * x;
+        };
 
-        Assert::equal(integerPairs,
-                      {
-                          {1, 2},
-                          {2, 3},
-                          {3, 4},
-                          {4, 5},
-                          {5, 1}
-        });
+        const auto sequential = Seq::range(10'000) | Seq::map(square) | Seq::toVector();
 
-        auto onlyOneInteger = {0};
+        // Results keep the order of the source regardless of thread count and window
 
-        auto noPairs = onlyOneInteger | Seq::pairwiseWrap() | Seq::toVector();
+        {
+            for (const std::size_t threads : {1ul, 2ul, 4ul})
+            {
+                for (const std::size_t maxInFlight : {0ul, 1ul, 7ul})
+                {
+                    const auto parallel = Seq::range(10'000)
+                                          | Seq::mapParallel(square, threads, maxInFlight)
+                                          | Seq::toVector();
+
+                    Assert::truthy(parallel == sequential);
+                }
+            }
+
+            const auto labels = Seq::range(5)
+                                | Seq::filter([](int x) { return x % 2 == 0; })
+                                | Seq::mapParallel([](int x) { return std::to_string(x); })
+                                | Seq::toVector();
+
+            Assert::equal(labels, {"0", "2", "4"});
+
+            const auto isEven = [](int x) { return x % 2 == 0; };
+            const auto flags  = Seq::range(1000) | Seq::mapParallel(isEven, 4, 7) | Seq::toVector();
+            Assert::truthy(flags == (Seq::range(1000) | Seq::map(isEven) | Seq::toVector()));
+        }
 
-        Assert::equal(noPairs, {});
+        // No more than maxInFlight elements are taken from the source ahead of the consumer
 
-        auto firstTwoInteger = {1, 2};
+        {
+            const auto endless = [](int* pulled) -> IEnumerable<int>
+            {
+                for (int i = 0;; ++i)
+                {
+                    ++*pulled;
+                    co_yield i;
+                }
+            };
+
+            int pulled      = 0;
+            int consumed    = 0;
+            bool wasBounded = true;
+
+            for (const int64_t x : endless(&pulled) | Seq::mapParallel(square, 4, 16) | Seq::take(100))
+            {
+                Assert::equal(x, square(consumed));
+                wasBounded = wasBounded && pulled - consumed <= 16 + 1;
+                ++consumed;
+            }
+
+            Assert::equal(consumed, 100);
+            Assert::truthy(wasBounded);
+        }
 
-        auto backToBackPairs = firstTwoInteger | Seq::pairwiseWrap() | Seq::toVector();
+        // Exceptions of the mapping follow every result before them
 
-        Assert::equal(backToBackPairs,
-                      {
-                          {1, 2},
-                          {2, 1}
-        });
+        {
+            const auto failing = [](int x) -> int64_t
+            {
+                if (x == 500)
+                {
+                    throw std::runtime_error("Unlucky number");
+                }
+
+                return x;
+            };
+
+            std::vector<int64_t> seen;
+
+            Assert::throws<std::runtime_error>(
+                [&]
+                {
+                    for (const int64_t x : Seq::range(1000) | Seq::mapParallel(failing, 4, 64))
+                    {
+                        seen.push_back(x);
+                    }
+                });
+            Assert::equal(seen.size(), 500ul);
+        }
     }
 
-    static void range()
+    static void mmapLines()
     {
-        // Basic integers
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-mmap-lines.txt";
 
-        Assert::equal(Seq::range(5) | Seq::toVector(), {0, 1, 2, 3, 4});
-        Assert::equal(Seq::range(1, 5) | Seq::toVector(), {1, 2, 3, 4});
+        const auto writeFile = [&path](std::string_view contents)
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        };
 
-        // Huge long numbers
+        const auto isMapped = [&path]() -> bool
+        {
+            std::ifstream maps("/proc/self/maps");
+            std::string line;
 
-        Assert::equal(Seq::range(222222222222222, 222222222222225) | Seq::toVector(),
-                      {222222222222222, 222222222222223, 222222222222224});
+            while (std::getline(maps, line))
+            {
+                if (line.find(path.filename().string()) != std::string::npos)
+                {
+                    return true;
+                }
+            }
 
-        // With steps
+            return false;
+        };
 
-        Assert::equal(Seq::range(0, 30, 5) | Seq::toVector(), {0, 5, 10, 15, 20, 25});
+        writeFile("alpha\nbeta\r\n\ngamma");
+        Assert::equal((Seq::mmapLines(path) | Seq::toVector()), {"alpha", "beta", "", "gamma"});
+
+        // A line break at the end does not start another line
+        writeFile("one\ntwo\n");
+        Assert::equal((Seq::mmapLines(path) | Seq::map([](std::string_view line) { return std::string(line); })
+                       | Seq::toVector()),
+                      {"one", "two"});
+
+        writeFile("");
+        Assert::truthy(Seq::mmapLines(path) | Seq::isEmpty());
+
+        // The mapping lives exactly as long as the sequence
+        {
+            writeFile("mapped\n");
+            const IEnumerable<std::string_view> lines = Seq::mmapLines(path);
+            Assert::truthy(isMapped() || !std::filesystem::exists("/proc/self/maps"));
+        }
+
+        Assert::falsey(isMapped());
+        std::filesystem::remove(path);
+
+        Assert::throws<std::system_error>([&] { Seq::mmapLines(path); });
+    }
+
+    static void mmapRecords()
+    {
+        struct Reading
+        {
+            std::int32_t sensor;
+            float value;
+        };
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-mmap-records.bin";
+        const std::vector<Reading> readings = {{1, 0.5f}, {2, 1.5f}, {1, 2.5f}};
+
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(readings.data()),
+                      static_cast<std::streamsize>(readings.size() * sizeof(Reading)));
+        }
+
+        const auto ofFirstSensor = [](const Reading& reading) { return reading.sensor == 1; };
+        const auto valueOf       = [](const Reading& reading) { return reading.value; };
+
+        Assert::equal<std::size_t>(Seq::mmapRecords<Reading>(path).sizeHint().size(), 3ul);
+        Assert::equal(Seq::mmapRecords<Reading>(path) | Seq::filter(ofFirstSensor) | Seq::map(valueOf) | Seq::sum(),
+                      3.0f);
+
+        // Files ending in the middle of a record are rejected
+        {
+            std::ofstream(path, std::ios::binary | std::ios::app) << 'x';
+        }
+
+        Assert::throws<std::runtime_error>([&] { Seq::mmapRecords<Reading>(path); });
+        std::filesystem::remove(path);
+    }
+
+    static void moveOnly()
+    {
+        // Move-only elements pass through the pipeline and get moved out by the consumer
+
+        {
+            auto evenPointers = Seq::range(6)
+                                | Seq::map([](int n) { return std::make_unique<int>(n); })
+                                | Seq::filter([](const auto& ptr) { return *ptr % 2 == 0; })
+                                | Seq::toVector();
+
+            Assert::equal<std::size_t>(evenPointers.size(), 3ul);
+            Assert::equal(*evenPointers.back(), 4);
+
+            std::vector<std::unique_ptr<int>> owned;
+            owned.emplace_back(std::make_unique<int>(7));
+
+            auto movedOut = std::move(owned) | Seq::toVector();
+            Assert::equal(*movedOut.front(), 7);
+        }
+
+        // Element types do not need a default constructor
+
+        {
+            struct Meters
+            {
+                explicit Meters(int value)
+                    : value(value)
+                {
+                }
+
+                int value;
+            };
+
+            auto distances = Seq::range(1, 4)
+                             | Seq::map([](int n) { return Meters(n * 100); })
+                             | Seq::map([](const Meters& m) { return m.value; })
+                             | Seq::toVector();
+
+            Assert::equal(distances, {100, 200, 300});
+        }
+
+        // Yielding lvalues does not copy them
+
+        {
+            struct CopyCounted
+            {
+                int* copies;
+
+                explicit CopyCounted(int* copies)
+                    : copies(copies)
+                {
+                }
+
+                CopyCounted(const CopyCounted& other)
+                    : copies(other.copies)
+                {
+                    ++*copies;
+                }
+            };
+
+            int copies = 0;
+            const std::vector<CopyCounted> items(5, CopyCounted(&copies));
+            copies = 0;
+
+            const std::size_t kept = items
+                                     | Seq::filter([](const CopyCounted&) { return true; })
+                                     | Seq::skip(1)
+                                     | Seq::take(3)
+                                     | Seq::count([](const CopyCounted&) { return true; });
+
+            Assert::equal<std::size_t>(kept, 3ul);
+            Assert::equal(copies, 0);
+        }
+    }
+
+    static void max()
+    {
+        const std::vector<int> temperatures = {3, -7, 12, 41, 0, 41, 8, -2, 5, 19, 23};
+        Assert::equal(*(temperatures | Seq::max()), 41);
+
+        auto fruits = {"Banana", "Orange", "Apple"};
+        Assert::equal(*(fruits | Seq::map([](const char* fruit) { return std::string(fruit); }) | Seq::max()),
+                      std::string("Orange"));
+
+        Assert::equal(*(Seq::range(1000) | Seq::max()), 999);
+        Assert::falsey((Seq::range(0) | Seq::max()).has_value());
+
+        // Borrowed containers without any element left
+        const std::vector<int> none;
+        Assert::falsey((none | Seq::max()).has_value());
+        Assert::falsey((std::vector{1, 2, 3} | Seq::skip(5) | Seq::max()).has_value());
+
+        const std::vector<int> three = {1, 2, 3};
+        Assert::falsey((three | Seq::skip(5) | Seq::max()).has_value());
+    }
+
+    static void min()
+    {
+        const std::vector<float> temperatures = {3.5f, -7.25f, 12.f, 41.f, 0.f, -7.5f, 8.f, -2.f, 5.f, 19.f};
+        Assert::equal(*(temperatures | Seq::min()), -7.5f);
+
+        auto fruits = {"Banana", "Orange", "Apple"};
+        Assert::equal(*(fruits | Seq::map([](const char* fruit) { return std::string(fruit); }) | Seq::min()),
+                      std::string("Apple"));
+
+        Assert::equal(*(Seq::range(1000, 0, -1) | Seq::min()), 1);
+        Assert::falsey((std::vector<int>{} | Seq::min()).has_value());
+
+        // Borrowed containers without any element left
+        const std::vector<double> none;
+        Assert::falsey((none | Seq::min()).has_value());
+
+        const std::vector<double> three = {1.0, 2.0, 3.0};
+        Assert::falsey((three | Seq::skip(5) | Seq::min()).has_value());
+        Assert::equal(*(three | Seq::skip(2) | Seq::min()), 3.0);
+    }
+
+    static void pairwise()
+    {
+        auto firstFiveInteger = {1, 2, 3, 4, 5};
+
+        auto integerPairs = firstFiveInteger | Seq::pairwise() | Seq::toVector();
+
+        Assert::equal(integerPairs,
+                      {
+                          {1, 2},
+                          {2, 3},
+                          {3, 4},
+                          {4, 5}
+        });
+
+        auto onlyOneInteger = {0};
+
+        auto noPairs = onlyOneInteger | Seq::pairwise() | Seq::toVector();
+
+        Assert::equal(noPairs, {});
+    }
+
+    static void pairwiseWrap()
+    {
+        auto firstFiveInteger = {1, 2, 3, 4, 5};
+
+        auto integerPairs = firstFiveInteger | Seq::pairwiseWrap() | Seq::toVector();
+
+        Assert::equal(integerPairs,
+                      {
+                          {1, 2},
+                          {2, 3},
+                          {3, 4},
+                          {4, 5},
+                          {5, 1}
+        });
+
+        auto onlyOneInteger = {0};
+
+        auto noPairs = onlyOneInteger | Seq::pairwiseWrap() | Seq::toVector();
+
+        Assert::equal(noPairs, {});
+
+        auto firstTwoInteger = {1, 2};
+
+        auto backToBackPairs = firstTwoInteger | Seq::pairwiseWrap() | Seq::toVector();
+
+        Assert::equal(backToBackPairs,
+                      {
+                          {1, 2},
+                          {2, 1}
+        });
+    }
+
+    static void parallel()
+    {
+        std::vector<int> numbers(100'000);
+        std::iota(numbers.begin(), numbers.end(), 0);
+
+        const auto square = [](int x) -> int64_t
+        {
+            return int64_t{x} * x;
+        };
+
+        const auto isEven = [](int64_t x) -> bool
+        {
+            return x % 2 == 0;
+        };
+
+        const auto sequential = numbers | Seq::map(square) | Seq::filter(isEven) | Seq::toVector();
+
+        // Results keep the order of the source regardless of thread count and grain
+
+        {
+            for (const std::size_t threads : {1ul, 2ul, 4ul})
+            {
+                const auto parallel = numbers
+                                      | Seq::parallel(threads, 777)
+                                      | Seq::map(square)
+                                      | Seq::filter(isEven)
+                                      | Seq::toVector();
+
+                Assert::truthy(parallel == sequential);
+            }
+
+            const auto total = numbers | Seq::parallel() | Seq::map(square) | Seq::sum();
+            Assert::equal(total, numbers | Seq::map(square) | Seq::sum());
+        }
+
+        // Random-access containers are split too, everything else stays sequential
+
+        {
+            const std::deque<int> queued(numbers.begin(), numbers.end());
+            auto fromDeque = queued | Seq::parallel(4, 1000) | Seq::map(square) | Seq::filter(isEven);
+
+            static_assert(Seq::_internal::Fused::EnsureIsPipeline<decltype(fromDeque)>);
+            Assert::truthy((fromDeque | Seq::toVector()) == sequential);
+            Assert::equal((Seq::range(5) | Seq::parallel() | Seq::map(square) | Seq::toVector()),
+                          {0, 1, 4, 9, 16});
+        }
+
+        // Operators that are not fused take over the results as an ordinary sequence
+
+        {
+            const auto descending = numbers
+                                    | Seq::parallel(4, 1000)
+                                    | Seq::filter([](int x) { return x % 1000 == 0; })
+                                    | Seq::sortDescending()
+                                    | Seq::take(3)
+                                    | Seq::toVector();
+
+            Assert::equal(descending, {99'000, 98'000, 97'000});
+
+            // So do fused stages that cannot run in parallel, right after the parallel ones
+            const auto firstSquares = numbers
+                                      | Seq::parallel(4, 1000)
+                                      | Seq::map(square)
+                                      | Seq::take(5)
+                                      | Seq::toVector();
+            Assert::equal(firstSquares, {0, 1, 4, 9, 16});
+
+            const auto skipped = numbers
+                                 | Seq::parallel(4, 1000)
+                                 | Seq::filter([](int x) { return x % 1000 == 0; })
+                                 | Seq::skip(98)
+                                 | Seq::map([](int x) { return x / 1000; })
+                                 | Seq::toVector();
+            Assert::equal(skipped, {98, 99});
+        }
+
+        // Boolean results, which `std::vector<bool>` would pack into bits
+
+        {
+            const auto parities = numbers | Seq::parallel(4, 1000) | Seq::map(isEven) | Seq::toVector();
+            Assert::truthy(parities == (numbers | Seq::map(isEven) | Seq::toVector()));
+
+            const auto distinctParities = numbers
+                                          | Seq::parallel(4, 1000)
+                                          | Seq::map(isEven)
+                                          | Seq::distinct()
+                                          | Seq::toVector();
+
+            Assert::truthy(distinctParities == std::vector{true, false});
+        }
+
+        // The first exception thrown by a mapping reaches the caller
+
+        {
+            Assert::throws<std::runtime_error>(
+                [&]
+                {
+                    numbers
+                        | Seq::parallel(4, 1000)
+                        | Seq::map(
+                            [](int x)
+                            {
+                                if (x == 54'321)
+                                {
+                                    throw std::runtime_error("Unlucky number");
+                                }
+
+                                return x;
+                            })
+                        | Seq::toVector();
+                });
+        }
+    }
+
+    static void prefetch()
+    {
+        const auto square = [](int x) -> int64_t
+        {
+            return int64_t{x} * x;
+        };
+
+        // Elements arrive in their original order, produced on another thread
+
+        {
+            const std::thread::id consumer = std::this_thread::get_id();
+            std::atomic<bool> producedElsewhere = true;
+
+            const auto prefetched = Seq::range(100'000)
+                                    | Seq::map(
+                                        [consumer, &producedElsewhere](int x)
+                                        {
+                                            if (std::this_thread::get_id() == consumer)
+                                            {
+                                                producedElsewhere = false;
+                                            }
+
+                                            return x;
+                                        })
+                                    | Seq::map(square)
+                                    | Seq::prefetch(3)
+                                    | Seq::toVector();
+
+            Assert::truthy(prefetched == (Seq::range(100'000) | Seq::map(square) | Seq::toVector()));
+            Assert::truthy(producedElsewhere.load());
+            Assert::equal((std::vector<std::string>{"a", "b"} | Seq::prefetch(1) | Seq::toVector()), {"a", "b"});
+        }
+
+        // The producer stays at most a ring ahead and stops once the consumer is gone
+
+        {
+            const auto endless = [](std::atomic<int>* produced) -> IEnumerable<int>
+            {
+                for (int i = 0;; ++i)
+                {
+                    produced->fetch_add(1);
+                    co_yield i;
+                }
+            };
+
+            std::atomic<int> produced = 0;
+            const auto firstFive = endless(&produced) | Seq::prefetch(8) | Seq::take(5) | Seq::toVector();
+
+            Assert::equal(firstFive, {0, 1, 2, 3, 4});
+            Assert::truthy(produced.load() <= 5 + 8 + 1);
+        }
+
+        // Exceptions of the producer follow every element yielded before them
+
+        {
+            const auto failing = []() -> IEnumerable<int>
+            {
+                for (int i = 0; i < 10; ++i)
+                {
+                    co_yield i;
+                }
+
+                throw std::runtime_error("Source ran dry");
+            };
+
+            std::vector<int> seen;
+
+            Assert::throws<std::runtime_error>(
+                [&]
+                {
+                    for (const int x : failing() | Seq::prefetch(4))
+                    {
+                        seen.push_back(x);
+                    }
+                });
+            Assert::equal(seen.size(), 10ul);
+        }
+
+        // A ring without room for a single element is rejected
+
+        {
+            Assert::throws<std::invalid_argument>([] { Seq::prefetch(0); });
+        }
+    }
+
+    static void range()
+    {
+        // Basic integers
+
+        Assert::equal(Seq::range(5) | Seq::toVector(), {0, 1, 2, 3, 4});
+        Assert::equal(Seq::range(1, 5) | Seq::toVector(), {1, 2, 3, 4});
+
+        // Huge long numbers
+
+        Assert::equal(Seq::range(222222222222222, 222222222222225) | Seq::toVector(),
+                      {222222222222222, 222222222222223, 222222222222224});
+
+        // With steps
+
+        Assert::equal(Seq::range(0, 30, 5) | Seq::toVector(), {0, 5, 10, 15, 20, 25});
         Assert::equal(Seq::range(0, 10, 3) | Seq::toVector(), {0, 3, 6, 9});
 
         // With negative steps
@@ -229,6 +1565,68 @@ namespace SeqTest
         Assert::truthy(Seq::range(0) | Seq::isEmpty());
     }
 
+    static void readChunks()
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-read-chunks.bin";
+
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << "0123456789";
+        }
+
+        const auto asText = [](std::span<const std::byte> block)
+        {
+            return std::string(reinterpret_cast<const char*>(block.data()), block.size());
+        };
+
+        Assert::equal((Seq::readChunks(path, 4) | Seq::map(asText) | Seq::toVector()), {"0123", "4567", "89"});
+        Assert::equal((Seq::readChunks(path, 5) | Seq::map(asText) | Seq::toVector()), {"01234", "56789"});
+        Assert::equal<std::size_t>(Seq::readChunks(path) | Seq::length(), 1ul);
+
+        // Stopping early has to stop the reader ahead of it as well
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(1 << 16, 'x');
+        }
+
+        Assert::equal(Seq::readChunks(path, 16) | Seq::take(2) | Seq::map(asText) | Seq::toVector(),
+                      {std::string(16, 'x'), std::string(16, 'x')});
+
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc);
+        }
+
+        Assert::truthy(Seq::readChunks(path, 4) | Seq::isEmpty());
+
+        Assert::throws<std::invalid_argument>([&] { Seq::readChunks(path, 0); });
+        std::filesystem::remove(path);
+
+        Assert::throws<std::system_error>([&] { Seq::readChunks(path); });
+    }
+
+    static void readLines()
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-read-lines.txt";
+
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << "alpha\nbeta\r\n\ngamma";
+        }
+
+        const auto copy = [](std::string_view line) { return std::string(line); };
+
+        // Blocks of 4 bytes cut right through most of the lines and between `\r` and `\n`
+        Assert::equal((Seq::readLines(path, 4) | Seq::map(copy) | Seq::toVector()), {"alpha", "beta", "", "gamma"});
+        Assert::equal((Seq::readLines(path, 3) | Seq::map(copy) | Seq::toVector()), {"alpha", "beta", "", "gamma"});
+        Assert::equal((Seq::readLines(path) | Seq::map(copy) | Seq::toVector()), {"alpha", "beta", "", "gamma"});
+
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << "one\ntwo\n";
+        }
+
+        Assert::equal((Seq::readLines(path, 4) | Seq::map(copy) | Seq::toVector()), {"one", "two"});
+        std::filesystem::remove(path);
+
+        Assert::throws<std::system_error>([&] { Seq::readLines(path); });
+    }
+
     static void reduce()
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
@@ -277,10 +1675,167 @@ namespace SeqTest
         });
     }
 
+    static void reduceParallel()
+    {
+        const auto add = [](double x, double accum)
+        {
+            return accum + x;
+        };
+
+        const auto combine = [](double left, double right)
+        {
+            return left + right;
+        };
+
+        // Floating-point sums come out exactly the same regardless of the number of threads
+
+        {
+            std::vector<double> terms(1'000'000);
+
+            for (std::size_t idx = 0; idx < terms.size(); ++idx)
+            {
+                terms[idx] = (idx % 2 == 0 ? 1.0 : -1.0) / static_cast<double>(idx + 1);
+            }
+
+            const double reference = terms | Seq::reduceParallel(0.0, add, combine, 1);
+
+            for (const std::size_t threads : {1ul, 2ul, 3ul, 4ul, 0ul})
+            {
+                for (int run = 0; run < 3; ++run)
+                {
+                    Assert::truthy((terms | Seq::reduceParallel(0.0, add, combine, threads)) == reference);
+                }
+            }
+
+            Assert::truthy(std::abs(reference - std::log(2.0)) < 1e-5);
+        }
+
+        // Sequences without random access give the same result as `Seq::reduce`
+
+        {
+            const auto sum = [](int x, int64_t accum)
+            {
+                return accum + x;
+            };
+
+            const auto combineSums = [](int64_t left, int64_t right)
+            {
+                return left + right;
+            };
+
+            std::vector<int> numbers(100'000);
+            std::iota(numbers.begin(), numbers.end(), 1);
+            const std::list<int> linked(numbers.begin(), numbers.end());
+
+            Assert::equal((numbers | Seq::reduceParallel(int64_t{0}, sum, combineSums, 4)), int64_t{5'000'050'000});
+            Assert::equal((linked | Seq::reduceParallel(int64_t{0}, sum, combineSums, 4)), int64_t{5'000'050'000});
+            Assert::equal((Seq::range(1, 11) | Seq::reduceParallel(int64_t{0}, sum, combineSums)),
+                          (Seq::range(1, 11) | Seq::reduce(int64_t{0}, sum)));
+        }
+    }
+
+    static void sizeHint()
+    {
+        const std::vector<int> hundredIntegers(100, 1);
+
+        // Operators that keep or predictably change the length produce exact hints
+
+        {
+            const auto hint = (hundredIntegers | Seq::map([](int x) { return x * 2; }) | Seq::skip(10)).sizeHint();
+
+            Assert::truthy(hint.isExact());
+            Assert::equal<std::size_t>(hint.size(), 90ul);
+
+            Assert::equal<std::size_t>(Seq::range(0, 10, 3).sizeHint().size(), 4ul);
+            Assert::equal<std::size_t>(Seq::range(10, 0, -3).sizeHint().size(), 4ul);
+            Assert::equal<std::size_t>(Seq::range(5, 5).sizeHint().size(), 0ul);
+            Assert::equal<std::size_t>((Seq::range(10) | Seq::chunkBySize(3)).sizeHint().size(), 4ul);
+            Assert::equal<std::size_t>((Seq::range(10) | Seq::pairwise()).sizeHint().size(), 9ul);
+            Assert::equal<std::size_t>((Seq::range(10) | Seq::pairwiseWrap()).sizeHint().size(), 10ul);
+            Assert::equal<std::size_t>((Seq::range(10) | Seq::sortDescending()).sizeHint().size(), 10ul);
+        }
+
+        // Filtering only keeps an upper bound, custom coroutines know nothing
+
+        {
+            const auto filtered = (hundredIntegers | Seq::filter([](int x) { return x > 0; })).sizeHint();
+
+            Assert::falsey(filtered.isExact());
+            Assert::truthy(filtered.isBounded());
+            Assert::equal<std::size_t>(filtered.size(), 100ul);
+
+            auto letters = []() -> IEnumerable<char>
+            {
+                co_yield 'a';
+                co_yield 'b';
+            };
+
+            Assert::falsey(letters().sizeHint().isBounded());
+            Assert::equal<std::size_t>((letters() | Seq::take(5)).sizeHint().size(), 5ul);
+            Assert::equal<std::size_t>(letters() | Seq::length(), 2ul);
+            Assert::falsey(letters() | Seq::isEmpty());
+        }
+
+        // Order is known after sorting and counting upwards, and survives operators that only drop elements
+
+        {
+            Assert::truthy(Seq::range(10).sizeHint().isAscending());
+            Assert::truthy((Seq::range(10) | Seq::filter([](int x) { return x % 2 == 0; })).sizeHint().isAscending());
+            Assert::truthy((hundredIntegers | Seq::sort() | Seq::take(5)).sizeHint().isAscending());
+            Assert::falsey(Seq::range(10, 0, -1).sizeHint().isAscending());
+            Assert::falsey((Seq::range(10) | Seq::map([](int x) { return -x; })).sizeHint().isAscending());
+            Assert::falsey((hundredIntegers | Seq::sortDescending()).sizeHint().isAscending());
+        }
+
+        // Length and emptiness are answered without running the pipeline when possible
+
+        {
+            std::size_t mappingCalls = 0;
+            const auto countingMap   = Seq::map(
+                [&mappingCalls](int x)
+                {
+                    ++mappingCalls;
+                    return x;
+                });
+
+            Assert::equal<std::size_t>(hundredIntegers | countingMap | Seq::length(), 100ul);
+            Assert::truthy(Seq::range(0) | Seq::isEmpty());
+            Assert::equal<std::size_t>(mappingCalls, 0ul);
+        }
+
+        // Sinks reserve exactly as much as needed
+
+        {
+            const auto doubled = hundredIntegers | Seq::map([](int x) { return x * 2; }) | Seq::toVector();
+            Assert::equal<std::size_t>(doubled.capacity(), 100ul);
+
+            const auto text = std::string(40, 'x') | Seq::toString();
+            Assert::equal<std::size_t>(text.capacity(), 40ul);
+        }
+    }
+
     static void skip()
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
         Assert::equal((firstFiveInteger | Seq::skip(2) | Seq::toVector()), {3, 4, 5});
+        Assert::equal((firstFiveInteger | Seq::skip(7) | Seq::toVector()), {});
+
+        // Contiguous sources jump ahead, so no stage is left to iterate over the skipped elements
+        using Skipped = decltype(firstFiveInteger | Seq::skip(2) | Seq::tail());
+        static_assert(std::is_same_v<Skipped, Seq::_internal::Fused::Pipeline<std::span<const int>>>);
+
+        Assert::equal((Seq::range(5) | Seq::skip(2) | Seq::tail() | Seq::toVector()), {3, 4});
+    }
+
+    static void skipWhile()
+    {
+        auto mixedIntegers = {1, 3, 4, 5, 6};
+
+        auto fromFirstEven = mixedIntegers | Seq::skipWhile([](int n) { return n % 2 != 0; }) | Seq::toVector();
+        Assert::equal(fromFirstEven, {4, 5, 6});
+
+        auto noneSkipped = mixedIntegers | Seq::skipWhile([](int n) { return n > 10; }) | Seq::toVector();
+        Assert::equal(noneSkipped, {1, 3, 4, 5, 6});
     }
 
     static void sort()
@@ -304,6 +1859,200 @@ namespace SeqTest
         Assert::equal(wordsByLengthDesc, {"cccc", "bbb", "dd", "a"});
     }
 
+    static void sortBackends()
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> ints(-1'000'000, 1'000'000);
+        std::uniform_real_distribution<double> reals(-1e6, 1e6);
+
+        std::vector<int> numbers(100'000);
+        std::vector<double> measurements(100'000);
+        std::generate(numbers.begin(), numbers.end(), [&] { return ints(generator); });
+        std::generate(measurements.begin(), measurements.end(), [&] { return reals(generator); });
+
+        auto ascending = numbers;
+        std::sort(ascending.begin(), ascending.end());
+        const std::vector<int> descending(ascending.rbegin(), ascending.rend());
+
+        // Every backend agrees with `std::sort`
+
+        {
+            using enum Seq::SortBackend;
+
+            Assert::truthy((numbers | Seq::sort<STANDARD>() | Seq::toVector()) == ascending);
+            Assert::truthy((numbers | Seq::sort<PARALLEL>() | Seq::toVector()) == ascending);
+            Assert::truthy((numbers | Seq::sort<RADIX>() | Seq::toVector()) == ascending);
+            Assert::truthy((numbers | Seq::sort<AUTO>() | Seq::toVector()) == ascending);
+
+            Assert::truthy((numbers | Seq::sortDescending<PARALLEL>() | Seq::toVector()) == descending);
+            Assert::truthy((numbers | Seq::sortDescending<RADIX>() | Seq::toVector()) == descending);
+        }
+
+        // Negative, positive and signed zero floating-point keys keep their order in radix sort
+
+        {
+            auto sortedMeasurements = measurements;
+            std::sort(sortedMeasurements.begin(), sortedMeasurements.end());
+
+            Assert::truthy((measurements | Seq::sort<Seq::SortBackend::RADIX>() | Seq::toVector())
+                           == sortedMeasurements);
+
+            const std::vector<float> mixedSigns = {0.5f, -0.f, -2.25f, 0.f, 1e30f, -1e30f, -0.5f};
+            Assert::equal((mixedSigns | Seq::sort<Seq::SortBackend::RADIX>() | Seq::toVector()),
+                          {-1e30f, -2.25f, -0.5f, -0.f, 0.f, 0.5f, 1e30f});
+        }
+
+        // Radix sort by key is stable, elements with equal keys keep their original order
+
+        {
+            const std::vector<std::string> words = {"pear", "fig", "plum", "kiwi", "date", "lime", "apple", "yam"};
+            const auto wordLength = [](const std::string& word) { return word.size(); };
+            const auto byLength   = words | Seq::sortBy<Seq::SortBackend::RADIX>(wordLength) | Seq::toVector();
+
+            Assert::equal(byLength, {"fig", "yam", "pear", "plum", "kiwi", "date", "lime", "apple"});
+
+            const auto byNegatedLength = words
+                                         | Seq::sortByDescending<Seq::SortBackend::PARALLEL>(
+                                             [](const auto& word) { return -static_cast<int>(word.size()); })
+                                         | Seq::toVector();
+
+            Assert::equal(byNegatedLength.front().size(), 3ul);
+            Assert::equal(byNegatedLength.back(), std::string("apple"));
+        }
+    }
+
+    static void sortLazily()
+    {
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int> ints(0, 5'000);
+
+        std::vector<int> numbers(50'000);
+        std::generate(numbers.begin(), numbers.end(), [&] { return ints(generator); });
+
+        auto ascending = numbers;
+        std::sort(ascending.begin(), ascending.end());
+
+        // Every prefix matches the fully sorted sequence, including runs of duplicates
+        for (const std::size_t count : {0ul, 1ul, 10ul, 1'000ul, 10'000ul, 50'000ul})
+        {
+            const std::vector<int> prefix(ascending.begin(), ascending.begin() + static_cast<std::ptrdiff_t>(count));
+
+            Assert::truthy((numbers | Seq::sort<Seq::SortBackend::STANDARD>() | Seq::take(count) | Seq::toVector())
+                           == prefix);
+            Assert::truthy((numbers | Seq::sort() | Seq::take(count) | Seq::toVector()) == prefix);
+        }
+
+        const std::vector<int> sameEverywhere(10'000, 3);
+        Assert::equal((sameEverywhere | Seq::sortDescending() | Seq::take(3) | Seq::toVector()), {3, 3, 3});
+
+        // Taking a few elements does not pay for sorting all of them
+
+        struct CountedKey
+        {
+            int value;
+            std::size_t* comparisons;
+
+            bool operator<(const CountedKey& other) const
+            {
+                ++*comparisons;
+                return value < other.value;
+            }
+        };
+
+        std::size_t comparisons = 0;
+        const auto countedKey   = [&comparisons](int n) { return CountedKey{n, &comparisons}; };
+
+        const auto smallest = numbers | Seq::sortBy(countedKey) | Seq::take(10) | Seq::toVector();
+        Assert::truthy(smallest == std::vector<int>(ascending.begin(), ascending.begin() + 10));
+        Assert::truthy(comparisons < numbers.size() * 6);
+
+        comparisons         = 0;
+        const auto largest  = numbers | Seq::sortByDescending(countedKey) | Seq::take(10) | Seq::toVector();
+        Assert::truthy(largest == std::vector<int>(ascending.rbegin(), ascending.rbegin() + 10));
+        Assert::truthy(comparisons < numbers.size() * 6);
+    }
+
+    static void stableSortBy()
+    {
+        const std::vector<std::string> words = {"pear", "fig", "plum", "kiwi", "date", "lime", "apple", "yam"};
+        const auto wordLength                = [](const std::string& word) { return word.size(); };
+
+        Assert::equal((words | Seq::stableSortBy(wordLength) | Seq::toVector()),
+                      {"fig", "yam", "pear", "plum", "kiwi", "date", "lime", "apple"});
+        Assert::equal((words | Seq::stableSortByDescending(wordLength) | Seq::toVector()),
+                      {"apple", "pear", "plum", "kiwi", "date", "lime", "fig", "yam"});
+
+        // Every backend keeps equal keys in order, also with few distinct keys on a large input
+        std::vector<std::pair<int, int>> pairs(50'000);
+
+        for (int idx = 0; idx < static_cast<int>(pairs.size()); ++idx)
+        {
+            pairs[static_cast<std::size_t>(idx)] = {(idx * 7919) % 13, idx};
+        }
+
+        const auto isStable = [](const std::vector<std::pair<int, int>>& sorted)
+        {
+            return std::ranges::is_sorted(sorted);
+        };
+
+        const auto groupOf = [](const std::pair<int, int>& pair) { return pair.first; };
+
+        using enum Seq::SortBackend;
+        Assert::truthy(isStable(pairs | Seq::stableSortBy<AUTO>(groupOf) | Seq::toVector()));
+        Assert::truthy(isStable(pairs | Seq::stableSortBy<STANDARD>(groupOf) | Seq::toVector()));
+        Assert::truthy(isStable(pairs | Seq::stableSortBy<PARALLEL>(groupOf) | Seq::toVector()));
+        Assert::truthy(isStable(pairs | Seq::stableSortBy<RADIX>(groupOf) | Seq::toVector()));
+
+        // Elements are buffered once and yielded in place, keys are computed once per element
+        struct Tracked
+        {
+            int value;
+            int* copies;
+
+            Tracked(int value, int* copies)
+                : value(value)
+                , copies(copies)
+            {
+            }
+
+            Tracked(const Tracked& other)
+                : value(other.value)
+                , copies(other.copies)
+            {
+                ++*copies;
+            }
+
+            Tracked& operator=(const Tracked& other) = default;
+        };
+
+        int copies       = 0;
+        int computedKeys = 0;
+
+        std::vector<Tracked> tracked;
+
+        for (int idx = 0; idx < 1'000; ++idx)
+        {
+            tracked.emplace_back((idx * 31) % 1'000, &copies);
+        }
+
+        copies = 0;
+
+        const auto descendingSum = tracked
+                                   | Seq::stableSortByDescending(
+                                       [&computedKeys](const Tracked& item)
+                                       {
+                                           ++computedKeys;
+                                           return std::to_string(item.value);
+                                       })
+                                   | Seq::take(3)
+                                   | Seq::map([](const Tracked& item) { return item.value; })
+                                   | Seq::toVector();
+
+        Assert::equal(descendingSum, {999, 998, 997});
+        Assert::equal(copies, 1'000);
+        Assert::equal(computedKeys, 1'000);
+    }
+
     static void sum()
     {
         auto booleans = {true, false, true, true};
@@ -320,6 +2069,35 @@ namespace SeqTest
 
         auto intsWithOverflow = {std::numeric_limits<int>::max(), 1};
         Assert::equal(intsWithOverflow | Seq::sum<uint64_t>(), 2147483648ul);
+
+        // Long contiguous and streamed sources go through every lane
+
+        const std::vector<int64_t> largeInts(100'003, 3);
+        Assert::equal(largeInts | Seq::sum(), int64_t{300'009});
+        Assert::equal(Seq::range(100'003) | Seq::map([](int x) { return int64_t{x}; }) | Seq::sum(),
+                      int64_t{5'000'250'003});
+
+        // Lanes add in another order than a plain loop, which must not overflow where the loop does not
+        constexpr int MAX_INT    = std::numeric_limits<int>::max();
+        std::vector<int> nearMax = {MAX_INT, -1, -1, -1, -1, -1, -1, -1, 1, 0, 0, 0, 0, 0, 0, 0};
+        Assert::equal(nearMax | Seq::sum(), MAX_INT - 6);
+        std::vector<int> nearMin = {-MAX_INT - 1, 1, 1, 1, 1, 1, 1, 1, -1, 0, 0, 0, 0, 0, 0, 0};
+        Assert::equal(nearMin | Seq::sum(), -MAX_INT + 5);
+
+        // Floating-point sums can trade speed for accuracy, a naive loop would be off by almost 0.1
+
+        const std::vector<float> tenths(10'000, 0.1f);
+        const auto isAccurate = [](float total) -> bool
+        {
+            return std::abs(total - 1000.f) < 1e-3f;
+        };
+
+        Assert::truthy(isAccurate(tenths | Seq::sum<void, Seq::Summation::KAHAN>()));
+        Assert::truthy(isAccurate(tenths | Seq::sum<void, Seq::Summation::PAIRWISE>()));
+        Assert::truthy(isAccurate(Seq::range(10'000) | Seq::map([](int) { return 0.1f; })
+                                  | Seq::sum<void, Seq::Summation::KAHAN>()));
+        Assert::truthy(isAccurate(Seq::range(10'000) | Seq::map([](int) { return 0.1f; })
+                                  | Seq::sum<void, Seq::Summation::PAIRWISE>()));
     }
 
     static void tail()
@@ -341,14 +2119,399 @@ namespace SeqTest
     {
         auto firstFiveInteger = {1, 2, 3, 4, 5};
         Assert::equal((firstFiveInteger | Seq::take(2) | Seq::toVector()), {1, 2});
+        Assert::equal((firstFiveInteger | Seq::take(9) | Seq::toVector()), {1, 2, 3, 4, 5});
+
+        struct AliveFlag
+        {
+            bool* alive;
+
+            ~AliveFlag() { *alive = false; }
+        };
+
+        const auto naturals = [](bool* alive) -> IEnumerable<int>
+        {
+            *alive = true;
+            const AliveFlag flag{alive};
+
+            for (int i = 0;; ++i)
+            {
+                co_yield i;
+            }
+        };
+
+        // Upstream work stops as soon as the limit is reached, even for unbounded sequences
+
+        {
+            bool alive         = false;
+            int mappedElements = 0;
+
+            IEnumerable<int> firstThree = naturals(&alive)
+                                          | Seq::map(
+                                              [&mappedElements](int n)
+                                              {
+                                                  ++mappedElements;
+                                                  return n * n;
+                                              })
+                                          | Seq::take(3);
+
+            Assert::equal(firstThree | Seq::toVector(), {0, 1, 4});
+            Assert::equal(mappedElements, 3);
+        }
+
+        // Upstream frames are destroyed right after the last element, not when the sequence goes out of scope
+
+        {
+            bool alive = false;
+
+            IEnumerable<int> firstTwo = naturals(&alive)
+                                        | Seq::pairwise()
+                                        | Seq::map([](const auto& pair) { return pair.second; })
+                                        | Seq::take(2);
+            std::vector<int> seconds;
+
+            for (int n : firstTwo)
+            {
+                seconds.emplace_back(n);
+            }
+
+            Assert::equal(seconds, {1, 2});
+            Assert::falsey(alive);
+        }
+
+        // A limit of zero pulls nothing at all
+
+        {
+            int mappedElements = 0;
+
+            const auto countingSquare = [&mappedElements](int n)
+            {
+                ++mappedElements;
+                return n * n;
+            };
+
+            const std::vector<int> numbers = {1, 2, 3};
+            Assert::equal((numbers | Seq::map(countingSquare) | Seq::take(0) | Seq::toVector()), {});
+
+            bool alive                 = false;
+            IEnumerable<int> noSquares = naturals(&alive) | Seq::map(countingSquare) | Seq::take(0);
+            Assert::equal(noSquares | Seq::toVector(), {});
+            Assert::equal((numbers | Seq::take(0) | Seq::map(countingSquare) | Seq::toVector()), {});
+
+            Assert::equal(mappedElements, 0);
+            Assert::falsey(alive);
+        }
+    }
+
+    static void takeWhile()
+    {
+        auto mixedIntegers = {2, 4, 5, 6};
+
+        auto leadingEvens = mixedIntegers | Seq::takeWhile([](int n) { return n % 2 == 0; }) | Seq::toVector();
+        Assert::equal(leadingEvens, {2, 4});
+
+        // Stops pulling at the first element that fails the predicate
+        auto belowFive = Seq::range(1'000'000'000) | Seq::takeWhile([](int n) { return n < 5; }) | Seq::sum();
+        Assert::equal(belowFive, 10);
+    }
+
+    static void thenBy()
+    {
+        struct Employee
+        {
+            std::string name;
+            std::string team;
+            int age;
+        };
+
+        const std::vector<Employee> employees = {
+            {"Noor", "infra", 41},
+            {"Ada", "web", 29},
+            {"Mina", "infra", 29},
+            {"Theo", "web", 35},
+            {"Lin", "infra", 41},
+            {"Sam", "web", 29},
+        };
+
+        const auto nameOf = [](const Employee& employee) { return employee.name; };
+        const auto teamOf = [](const Employee& employee) { return employee.team; };
+        const auto ageOf  = [](const Employee& employee) { return employee.age; };
+
+        const auto byTeamThenAge =
+            employees | Seq::sortBy(teamOf).thenByDescending(ageOf).thenBy(nameOf) | Seq::map(nameOf) | Seq::toVector();
+        Assert::equal(byTeamThenAge, {"Lin", "Noor", "Mina", "Theo", "Ada", "Sam"});
+
+        const auto byAgeThenName =
+            employees | Seq::sortByDescending(ageOf).thenBy(nameOf) | Seq::map(nameOf) | Seq::toVector();
+        Assert::equal(byAgeThenName, {"Lin", "Noor", "Theo", "Ada", "Mina", "Sam"});
+
+        // Stable orderings keep ties of every key in their original order
+        const auto byTeamStable = employees | Seq::stableSortBy(teamOf).thenBy(ageOf) | Seq::map(nameOf)
+                                  | Seq::toVector();
+        Assert::equal(byTeamStable, {"Mina", "Noor", "Lin", "Ada", "Sam", "Theo"});
+    }
+
+    static void toOstream()
+    {
+        std::ostringstream out;
+        Assert::equal<std::size_t>(std::vector<int>{1, 2, 3} | Seq::toOstream(out, ", "), 3ul);
+        Assert::equal(out.str(), std::string("1, 2, 3"));
+
+        out.str("");
+        std::vector<std::string> words = {"alpha", "beta"};
+        words | Seq::toOstream(out, " ");
+        std::vector<double> halves = {0.5, 1.25};
+        halves | Seq::toOstream(out, "|");
+
+        // Anything else goes through its own `operator<<`
+        std::vector<std::complex<int>> points = {{1, 2}, {3, 4}};
+        points | Seq::toOstream(out, "; ");
+        Assert::equal(out.str(), std::string("alpha beta0.5|1.25(1,2); (3,4)"));
+
+        // Numbers look just like their `operator<<` with the state of the stream
+        out.str("");
+        std::vector<double> numbers = {1234567.0, 0.1234567};
+        numbers | Seq::toOstream(out, ",");
+        Assert::equal(out.str(), std::string("1.23457e+06,0.123457"));
+
+        out.str("");
+        out << std::fixed << std::setprecision(2);
+        numbers | Seq::toOstream(out, ",");
+        std::vector<int> hexadecimal = {255, 16};
+        out << std::hex << ';';
+        hexadecimal | Seq::toOstream(out, ",");
+        Assert::equal(out.str(), std::string("1234567.00,0.12;ff,10"));
+
+        out.str("");
+        out.flags(std::ios_base::skipws | std::ios_base::dec);
+        out.precision(3);
+        numbers | Seq::toOstream(out, ",");
+        out << ';' << std::setw(3);
+        std::vector<int> padded = {7};
+        padded | Seq::toOstream(out, ",");
+        Assert::equal(out.str(), std::string("1.23e+06,0.123;  7"));
+
+        // Many more elements than fit into the buffer at once
+        out.str("");
+        std::string expected;
+
+        for (int idx = 0; idx < 100'000; ++idx)
+        {
+            expected += (idx > 0 ? "," : "") + std::to_string(idx * 3);
+        }
+
+        Seq::range(0, 100'000) | Seq::map([](int x) { return x * 3; }) | Seq::toOstream(out, ",");
+        Assert::equal(out.str(), expected);
+        Assert::equal<std::size_t>(std::vector<int>() | Seq::toOstream(out, ","), 0ul);
+    }
+
+    static void topK()
+    {
+        const std::vector<std::string> words = {"pear", "fig", "banana", "plum", "cherry", "kiwi", "apple"};
+        const auto wordLength                = [](const std::string& word) { return word.size(); };
+
+        // Largest keys first, equal keys in their original order
+        Assert::equal((words | Seq::topK(3, wordLength) | Seq::toVector()), {"banana", "cherry", "apple"});
+        Assert::equal((words | Seq::topK(5, wordLength) | Seq::toVector()),
+                      {"banana", "cherry", "apple", "pear", "plum"});
+        Assert::equal((words | Seq::topK(0, wordLength) | Seq::toVector()), {});
+        Assert::equal((words | Seq::topK(100, wordLength) | Seq::length()), 7ul);
+
+        // Agrees with sorting everything on a streamed source
+        const auto byRemainder = [](int n) { return (n * 7919) % 1000; };
+
+        const auto topTen = Seq::range(100'000) | Seq::topK(10, byRemainder) | Seq::toVector();
+        const auto sorted = Seq::range(100'000) | Seq::sortByDescending(byRemainder) | Seq::take(10) | Seq::toVector();
+
+        Assert::equal(topTen.size(), 10ul);
+        Assert::truthy((topTen | Seq::map(byRemainder) | Seq::toVector())
+                       == (sorted | Seq::map(byRemainder) | Seq::toVector()));
+        Assert::truthy(topTen | Seq::forall([](int n) { return (n * 7919) % 1000 == 999; }));
+    }
+
+    static void toVectorAsync()
+    {
+        const auto boxes = [](int count) -> AsyncEnumerable<std::unique_ptr<int>>
+        {
+            for (int idx = 0; idx < count; ++idx)
+            {
+                co_yield std::make_unique<int>(idx);
+            }
+        };
+
+        Seq::EventLoop loop;
+        const std::vector<std::unique_ptr<int>> moved = loop.run(boxes(3) | Seq::toVectorAsync());
+
+        Assert::equal<std::size_t>(moved.size(), 3ul);
+        Assert::equal(*moved[2], 2);
+        Assert::truthy(loop.run(boxes(0) | Seq::toVectorAsync()).empty());
+    }
+
+    static void unionWith()
+    {
+        const std::vector<int> first  = {4, 1, 4, 2};
+        const std::vector<int> second = {3, 2, 5, 3};
+
+        // Distinct elements of the input first, then the new ones
+        Assert::equal((first | Seq::unionWith(second) | Seq::toVector()), {4, 1, 2, 3, 5});
+        Assert::equal((std::vector<int>{} | Seq::unionWith(second) | Seq::toVector()), {3, 2, 5});
+
+        // Sorted sequences are merged into a sorted result
+        Assert::equal((first | Seq::sort() | Seq::unionWith(second | Seq::sort()) | Seq::toVector()), {1, 2, 3, 4, 5});
+        Assert::equal((Seq::range(0, 10, 3) | Seq::unionWith(Seq::range(0, 10, 2)) | Seq::toVector()),
+                      {0, 2, 3, 4, 6, 8, 9});
+
+        const auto unionOp = Seq::unionWith(second);
+        Assert::equal((first | unionOp | Seq::length()), 5ul);
+        Assert::equal((second | unionOp | Seq::length()), 3ul);
+    }
+
+    static void windowed()
+    {
+        const auto asVector = [](std::span<const int> run) { return std::vector<int>(run.begin(), run.end()); };
+        const auto total    = [](std::span<const int> run) { return std::accumulate(run.begin(), run.end(), 0); };
+
+        const std::vector<int> numbers = {1, 2, 3, 4, 5};
+
+        Assert::equal((numbers | Seq::windowed(3) | Seq::map(asVector) | Seq::toVector()),
+                      {{1, 2, 3}, {2, 3, 4}, {3, 4, 5}});
+        Assert::equal((numbers | Seq::windowed(1) | Seq::map(total) | Seq::toVector()), {1, 2, 3, 4, 5});
+        Assert::equal((numbers | Seq::windowed(6) | Seq::toVector()).size(), 0ul);
+        Assert::equal<std::size_t>((numbers | Seq::windowed(2)).sizeHint().size(), 4ul);
+
+        // Windows of contiguous containers point into the container
+        const auto windows = numbers | Seq::windowed(4) | Seq::toVector();
+        Assert::truthy(windows[1].data() == numbers.data() + 1);
+
+        const std::string word = "seq";
+        Assert::equal((word | Seq::windowed(2) | Seq::toVector()), {"se", "eq"});
+
+        // Anything else goes through a ring buffer
+        Assert::equal((Seq::range(1, 8) | Seq::windowed(3) | Seq::map(asVector) | Seq::toVector()),
+                      {{1, 2, 3}, {2, 3, 4}, {3, 4, 5}, {4, 5, 6}, {5, 6, 7}});
+        Assert::equal((Seq::range(1, 8) | Seq::windowed(3) | Seq::map(total) | Seq::toVector()), {6, 9, 12, 15, 18});
+        Assert::equal((Seq::range(1, 3) | Seq::windowed(3) | Seq::toVector()).size(), 0ul);
+
+        const auto windowRange = [total](int length)
+        {
+            Seq::range(0, length) | Seq::windowed(4) | Seq::map(total) | Seq::sum();
+        };
+
+        AllocCounter::countFor(windowRange, 8);
+        Assert::equal(AllocCounter::countFor(windowRange, 16), AllocCounter::countFor(windowRange, 4000));
+
+        // Windows of booleans, which `std::vector<bool>` would pack into bits
+        const auto isEven = [](int x) { return x % 2 == 0; };
+        const auto trues  = [](std::span<const bool> run) { return std::ranges::count(run, true); };
+
+        Assert::truthy((Seq::range(0, 6) | Seq::map(isEven) | Seq::windowed(3) | Seq::map(trues) | Seq::toVector())
+                       == std::vector<std::ptrdiff_t>{2, 1, 2, 1});
+    }
+
+    static void writeBinary()
+    {
+        struct Reading
+        {
+            std::int32_t sensor;
+            float value;
+        };
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-write-binary.bin";
+        const std::vector<Reading> readings = {{1, 0.5f}, {2, 1.5f}, {1, 2.5f}};
+
+        Assert::equal<std::size_t>(readings | Seq::writeBinary(path), 3ul);
+        Assert::equal<std::size_t>(std::filesystem::file_size(path), 3 * sizeof(Reading));
+
+        const auto sensorOf = [](const Reading& reading) { return reading.sensor; };
+        Assert::equal((Seq::mmapRecords<Reading>(path) | Seq::map(sensorOf) | Seq::toVector()), {1, 2, 1});
+
+        // Records of a pipeline are staged and buffered, which takes the same memory for any number of them
+        const auto writeRange = [&path](int length)
+        {
+            Seq::range(0, length) | Seq::map([](int x) { return static_cast<double>(x); }) | Seq::writeBinary(path);
+        };
+
+        AllocCounter::countFor(writeRange, 1);
+        const std::size_t fewRecords  = AllocCounter::countFor(writeRange, 100);
+        const std::size_t manyRecords = AllocCounter::countFor(writeRange, 100'000);
+
+        Assert::equal(fewRecords, manyRecords);
+        Assert::equal(Seq::mmapRecords<double>(path) | Seq::sum(), 4'999'950'000.0);
+
+        // Records without a default constructor are written straight from a pipeline
+        struct Sample
+        {
+            std::int32_t id;
+
+            explicit Sample(std::int32_t id) : id(id) {}
+        };
+
+        const auto toSample = [](int x) { return Sample(x * 2); };
+        Assert::equal<std::size_t>(Seq::range(0, 1000) | Seq::map(toSample) | Seq::writeBinary(path), 1000ul);
+        Assert::equal<std::size_t>(std::filesystem::file_size(path), 1000 * sizeof(Sample));
+        Assert::equal((Seq::mmapRecords<Sample>(path) | Seq::map([](const Sample& s) { return s.id; }) | Seq::sum()),
+                      999'000);
+        std::filesystem::remove(path);
+
+        Assert::throws<std::system_error>(
+            [&]
+            {
+                readings | Seq::writeBinary(std::filesystem::temp_directory_path() / "seq-missing-dir" / "out.bin");
+            });
+    }
+
+    static void writeLines()
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "seq-test-write-lines.txt";
+
+        const auto readFile = [&path]() -> std::string
+        {
+            std::ifstream in(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        };
+
+        std::vector<std::string> words = {"alpha", "", "gamma"};
+        Assert::equal<std::size_t>(words | Seq::writeLines(path), 3ul);
+        Assert::equal(readFile(), std::string("alpha\n\ngamma\n"));
+
+        Seq::range(0, 4) | Seq::writeLines(path);
+        Assert::equal(readFile(), std::string("0\n1\n2\n3\n"));
+
+        // Lines longer than the buffer are written without passing through it
+        const std::string longLine(200'000, 'x');
+        std::vector<std::string> lines = {"first", longLine, "last"};
+        lines | Seq::writeLines(path);
+        Assert::equal(readFile(), "first\n" + longLine + "\nlast\n");
+
+        const auto lengthOf = [](std::string_view line) { return line.size(); };
+        Seq::range(0, 50'000) | Seq::map([](int x) { return std::to_string(x); }) | Seq::writeLines(path);
+        Assert::equal<std::size_t>(Seq::mmapLines(path) | Seq::length(), 50'000ul);
+        Assert::equal<std::size_t>(Seq::mmapLines(path) | Seq::map(lengthOf) | Seq::sum(), 238'890ul);
+        std::filesystem::remove(path);
     }
 
     constexpr std::array CASES = {
-        REGISTER_TEST(chunkBySize), REGISTER_TEST(contains), REGISTER_TEST(count),    REGISTER_TEST(exists),
-        REGISTER_TEST(filter),      REGISTER_TEST(find),     REGISTER_TEST(forall),   REGISTER_TEST(isEmpty),
-        REGISTER_TEST(length),      REGISTER_TEST(map),      REGISTER_TEST(pairwise), REGISTER_TEST(pairwiseWrap),
-        REGISTER_TEST(range),       REGISTER_TEST(reduce),   REGISTER_TEST(skip),     REGISTER_TEST(sort),
-        REGISTER_TEST(sum),         REGISTER_TEST(tail),     REGISTER_TEST(take),
+        REGISTER_TEST(aggregateParallel), REGISTER_TEST(asyncEnumerable), REGISTER_TEST(average),
+        REGISTER_TEST(batched),           REGISTER_TEST(borrow),          REGISTER_TEST(chunkBySize),
+        REGISTER_TEST(contains),          REGISTER_TEST(count),           REGISTER_TEST(countBy),
+        REGISTER_TEST(distinct),          REGISTER_TEST(distinctBy),      REGISTER_TEST(except),
+        REGISTER_TEST(exceptions),        REGISTER_TEST(exists),          REGISTER_TEST(externalSort),
+        REGISTER_TEST(filter),            REGISTER_TEST(filterAsync),     REGISTER_TEST(find),
+        REGISTER_TEST(forall),            REGISTER_TEST(framePool),       REGISTER_TEST(fused),
+        REGISTER_TEST(groupBy),           REGISTER_TEST(groupJoin),       REGISTER_TEST(intersect),
+        REGISTER_TEST(isEmpty),           REGISTER_TEST(iterAsync),       REGISTER_TEST(join),
+        REGISTER_TEST(length),            REGISTER_TEST(map),             REGISTER_TEST(mapAsync),
+        REGISTER_TEST(mapParallel),       REGISTER_TEST(max),             REGISTER_TEST(min),
+        REGISTER_TEST(mmapLines),         REGISTER_TEST(mmapRecords),     REGISTER_TEST(moveOnly),
+        REGISTER_TEST(pairwise),          REGISTER_TEST(pairwiseWrap),    REGISTER_TEST(parallel),
+        REGISTER_TEST(prefetch),          REGISTER_TEST(range),           REGISTER_TEST(readChunks),
+        REGISTER_TEST(readLines),         REGISTER_TEST(reduce),          REGISTER_TEST(reduceParallel),
+        REGISTER_TEST(sizeHint),          REGISTER_TEST(skip),            REGISTER_TEST(skipWhile),
+        REGISTER_TEST(sort),              REGISTER_TEST(sortBackends),    REGISTER_TEST(sortLazily),
+        REGISTER_TEST(stableSortBy),      REGISTER_TEST(sum),             REGISTER_TEST(tail),
+        REGISTER_TEST(take),              REGISTER_TEST(takeWhile),       REGISTER_TEST(thenBy),
+        REGISTER_TEST(toOstream),         REGISTER_TEST(topK),            REGISTER_TEST(toVectorAsync),
+        REGISTER_TEST(unionWith),         REGISTER_TEST(windowed),        REGISTER_TEST(writeBinary),
+        REGISTER_TEST(writeLines),
 
         // register new test cases here ...
     };
@@ -15,4 +15,19 @@ namespace Assert
     inline void truthy(bool have, sl callsite = sl::current()) { Assert::equal(have, true, callsite); }
 
     inline void falsey(bool have, sl callsite = sl::current()) { Assert::equal(have, false, callsite); }
+
+    template<typename Exception, typename Function>
+    inline void throws(Function&& function, sl callsite = sl::current())
+    {
+        try
+        {
+            function();
+        }
+        catch (const Exception&)
+        {
+            return;
+        }
+
+        throw Failure(callsite, "Expected an exception, but none was thrown");
+    }
 }